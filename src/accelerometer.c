@@ -0,0 +1,170 @@
+/**
+ * @file accelerometer.c
+ * @brief LIS3DH register setup, FIFO burst reads and wake-up latch handling
+ *
+ * In low-power mode the outputs are 8-bit, left-justified in the 16-bit
+ * registers, at 16 mg per digit for the +/-2 g range. With the FIFO
+ * enabled, an auto-incrementing read from OUT_X_L wraps back to OUT_X_L
+ * after OUT_Z_H, so the whole FIFO comes out in one I2C transfer.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "accelerometer.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define LIS3DH_WHO_AM_I         0x0FU
+#define LIS3DH_CTRL_REG1        0x20U
+#define LIS3DH_CTRL_REG2        0x21U
+#define LIS3DH_CTRL_REG3        0x22U
+#define LIS3DH_CTRL_REG4        0x23U
+#define LIS3DH_CTRL_REG5        0x24U
+#define LIS3DH_REFERENCE        0x26U
+#define LIS3DH_OUT_X_L          0x28U
+#define LIS3DH_FIFO_CTRL_REG    0x2EU
+#define LIS3DH_FIFO_SRC_REG     0x2FU
+#define LIS3DH_INT1_CFG         0x30U
+#define LIS3DH_INT1_SRC         0x31U
+#define LIS3DH_INT1_THS         0x32U
+#define LIS3DH_INT1_DURATION    0x33U
+
+#define LIS3DH_ID               0x33U
+#define LIS3DH_AUTO_INCREMENT   0x80U
+
+#define LIS3DH_ODR_10HZ_LP_XYZ  0x2FU   // ODR 10 Hz, LPen, X/Y/Z enabled
+#define LIS3DH_HPIS1            0x01U   // High-pass filtered data to IA1
+#define LIS3DH_I1_IA1           0x40U   // IA1 on INT1
+#define LIS3DH_BDU_2G           0x80U   // Block data update, +/-2 g
+#define LIS3DH_FIFO_EN_LIR_INT1 0x48U   // FIFO enable, latch INT1
+#define LIS3DH_FIFO_STREAM      0x80U
+#define LIS3DH_INT1_XYZ_HIGH    0x2AU   // OR of X/Y/Z high events
+
+#define LIS3DH_FIFO_OVRN        0x40U
+#define LIS3DH_FIFO_FSS_MASK    0x1FU
+
+#define LIS3DH_LP_MG_PER_DIGIT  16
+#define ACC_I2C_TIMEOUT_MS      10U
+
+/* Private variables ---------------------------------------------------------*/
+static I2C_HandleTypeDef *acc_i2c = NULL;
+
+/* Private functions ---------------------------------------------------------*/
+static HAL_StatusTypeDef reg_write(uint8_t reg, uint8_t value)
+{
+    return HAL_I2C_Mem_Write(acc_i2c, ACC_I2C_ADDRESS, reg, I2C_MEMADD_SIZE_8BIT,
+                             &value, 1, ACC_I2C_TIMEOUT_MS);
+}
+
+static HAL_StatusTypeDef reg_read(uint8_t reg, uint8_t *data, uint16_t len)
+{
+    if (len > 1) {
+        reg |= LIS3DH_AUTO_INCREMENT;
+    }
+
+    return HAL_I2C_Mem_Read(acc_i2c, ACC_I2C_ADDRESS, reg, I2C_MEMADD_SIZE_8BIT,
+                            data, len, ACC_I2C_TIMEOUT_MS);
+}
+
+static inline int16_t lp_to_mg(uint8_t high_byte)
+{
+    return (int16_t)((int8_t)high_byte * LIS3DH_LP_MG_PER_DIGIT);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Probe the LIS3DH and start FIFO sampling with wake-up on INT1
+ */
+HAL_StatusTypeDef ACC_Init(I2C_HandleTypeDef *hi2c)
+{
+    static const uint8_t config[][2] = {
+        { LIS3DH_CTRL_REG1,     LIS3DH_ODR_10HZ_LP_XYZ },
+        { LIS3DH_CTRL_REG2,     LIS3DH_HPIS1 },
+        { LIS3DH_CTRL_REG3,     LIS3DH_I1_IA1 },
+        { LIS3DH_CTRL_REG4,     LIS3DH_BDU_2G },
+        { LIS3DH_CTRL_REG5,     LIS3DH_FIFO_EN_LIR_INT1 },
+        { LIS3DH_INT1_THS,      ACC_WAKE_THRESHOLD_MG / LIS3DH_LP_MG_PER_DIGIT },
+        { LIS3DH_INT1_DURATION, 0 },
+        { LIS3DH_FIFO_CTRL_REG, LIS3DH_FIFO_STREAM },
+        { LIS3DH_INT1_CFG,      LIS3DH_INT1_XYZ_HIGH },
+    };
+    uint8_t id = 0;
+    uint8_t dummy;
+
+    if (hi2c == NULL) {
+        return HAL_ERROR;
+    }
+
+    acc_i2c = hi2c;
+
+    if (reg_read(LIS3DH_WHO_AM_I, &id, 1) != HAL_OK || id != LIS3DH_ID) {
+        return HAL_ERROR;
+    }
+
+    for (uint8_t i = 0; i < sizeof(config) / sizeof(config[0]); i++) {
+        if (reg_write(config[i][0], config[i][1]) != HAL_OK) {
+            return HAL_ERROR;
+        }
+    }
+
+    // Reading REFERENCE resets the high-pass filter to the current attitude
+    if (reg_read(LIS3DH_REFERENCE, &dummy, 1) != HAL_OK) {
+        return HAL_ERROR;
+    }
+
+    return ACC_ClearMotion();
+}
+
+/**
+ * @brief Drain up to max_samples from the FIFO, oldest first
+ * @note Blocking I2C; call from a low-priority task
+ */
+uint8_t ACC_ReadFifo(ACC_Sample_t *samples, uint8_t max_samples)
+{
+    uint8_t raw[ACC_FIFO_DEPTH * 6U];
+    uint8_t src;
+    uint8_t n;
+
+    if (acc_i2c == NULL || reg_read(LIS3DH_FIFO_SRC_REG, &src, 1) != HAL_OK) {
+        return 0;
+    }
+
+    n = (src & LIS3DH_FIFO_OVRN) ? ACC_FIFO_DEPTH : (src & LIS3DH_FIFO_FSS_MASK);
+    if (n > max_samples) {
+        n = max_samples;
+    }
+
+    if (n == 0 || reg_read(LIS3DH_OUT_X_L, raw, (uint16_t)(n * 6U)) != HAL_OK) {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < n; i++) {
+        samples[i].x_mg = lp_to_mg(raw[6U * i + 1U]);
+        samples[i].y_mg = lp_to_mg(raw[6U * i + 3U]);
+        samples[i].z_mg = lp_to_mg(raw[6U * i + 5U]);
+    }
+
+    return n;
+}
+
+/**
+ * @brief True while a wake-up event is latched on INT1
+ * @note GPIO read only, safe from any task
+ */
+bool ACC_IsMotionLatched(void)
+{
+    return HAL_GPIO_ReadPin(ACC_INT1_GPIO_Port, ACC_INT1_Pin) == GPIO_PIN_SET;
+}
+
+/**
+ * @brief Release the INT1 latch (reads INT1_SRC)
+ */
+HAL_StatusTypeDef ACC_ClearMotion(void)
+{
+    uint8_t src;
+
+    if (acc_i2c == NULL) {
+        return HAL_ERROR;
+    }
+
+    return reg_read(LIS3DH_INT1_SRC, &src, 1);
+}
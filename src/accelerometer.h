@@ -0,0 +1,56 @@
+/**
+ * @file accelerometer.h
+ * @brief LIS3DH accelerometer: low-power FIFO sampling and wake-up detection
+ *
+ * The sensor runs at ACC_ODR_HZ in low-power mode with its FIFO in stream
+ * mode, so the host reads it in bursts. The wake-up (inertial) function
+ * compares the high-pass filtered acceleration with ACC_WAKE_THRESHOLD_MG
+ * and latches INT1 until ACC_ClearMotion reads INT1_SRC.
+ *
+ * INT1 (PC0) shares EXTI line 0 with the ADS1299 DRDY (PB0), which owns the
+ * line. The latched INT1 level is therefore read as a plain GPIO input by
+ * ACC_IsMotionLatched, which costs no I2C traffic.
+ */
+
+#ifndef ACCELEROMETER_H
+#define ACCELEROMETER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32h7xx_hal.h"
+
+/* Build configuration -------------------------------------------------------*/
+#ifndef ACC_WAKE_THRESHOLD_MG
+#define ACC_WAKE_THRESHOLD_MG   64U   // High-pass filtered wake-up threshold, 16 mg steps
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define ACC_I2C_ADDRESS         (0x18U << 1)   // SA0 = GND
+#define ACC_INT1_GPIO_Port      GPIOC
+#define ACC_INT1_Pin            GPIO_PIN_0
+#define ACC_ODR_HZ              10U            // Low-power output data rate
+#define ACC_FIFO_DEPTH          32U            // Samples held by the LIS3DH FIFO
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    int16_t x_mg;
+    int16_t y_mg;
+    int16_t z_mg;
+} ACC_Sample_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef ACC_Init(I2C_HandleTypeDef *hi2c);
+uint8_t ACC_ReadFifo(ACC_Sample_t *samples, uint8_t max_samples);   // Samples read, 0 on error
+bool ACC_IsMotionLatched(void);
+HAL_StatusTypeDef ACC_ClearMotion(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ACCELEROMETER_H */
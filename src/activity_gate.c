@@ -0,0 +1,231 @@
+/**
+ * @file activity_gate.c
+ * @brief Full-rate/low-rate decision from EMG energy and arm motion
+ *
+ * Only the DSP task changes the mode. The monitor task just stamps
+ * last_motion; the DSP task sees that stamp (or the INT1 latch itself) at
+ * the next window boundary and leaves low-rate mode. Sleep uses WFI with
+ * the regulator on, not Stop: Stop would halt the SPI and DMA clocks that
+ * the ADS1299 bursts need between wakeups.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "activity_gate.h"
+#include "accelerometer.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define ACTIVITY_EMG_MS_THRESHOLD   (ACTIVITY_EMG_RMS_V * ACTIVITY_EMG_RMS_V)
+#define ACTIVITY_FIFO_PERIOD_MS     1000U   // ~ACC_ODR_HZ samples per stillness check
+
+/* Private variables ---------------------------------------------------------*/
+static volatile Activity_Mode_t activity_mode = ACTIVITY_FULL_RATE;
+static volatile bool activity_enabled = (ACTIVITY_GATING != 0);
+static volatile uint32_t last_motion = 0;   // Tick of the last motion (monitor or DSP)
+static uint32_t last_emg = 0;               // Tick of the last active EMG block
+static uint32_t low_rate_since = 0;
+static uint8_t window_count = 0;
+static uint32_t last_fifo_read = 0;
+
+static Activity_Stats_t activity_stats;
+
+/* Private functions ---------------------------------------------------------*/
+// wakeup_counter: statistic to charge, NULL when gating was switched off
+static void enter_full_rate(uint32_t now, uint32_t *wakeup_counter)
+{
+    if (activity_mode != ACTIVITY_LOW_RATE) {
+        return;
+    }
+
+    activity_mode = ACTIVITY_FULL_RATE;
+    activity_stats.low_rate_ms += now - low_rate_since;
+    if (wakeup_counter != NULL) {
+        (*wakeup_counter)++;
+    }
+}
+
+static void enter_low_rate_if_quiet(uint32_t now)
+{
+    if (activity_mode != ACTIVITY_FULL_RATE) {
+        return;
+    }
+
+    if (now - last_emg >= ACTIVITY_REST_TIMEOUT_MS &&
+        now - last_motion >= ACTIVITY_REST_TIMEOUT_MS) {
+        activity_mode = ACTIVITY_LOW_RATE;
+        low_rate_since = now;
+        window_count = 0;
+        activity_stats.low_rate_entries++;
+    }
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Start in full-rate mode with both detectors considered active
+ */
+void Activity_Init(void)
+{
+    const uint32_t now = HAL_GetTick();
+
+    memset(&activity_stats, 0, sizeof(activity_stats));
+    activity_mode = ACTIVITY_FULL_RATE;
+    last_motion = now;
+    last_emg = now;
+    window_count = 0;
+}
+
+/**
+ * @brief Enable or bypass gating at run time
+ * @note Bypass takes effect at the next EMG block
+ */
+void Activity_SetEnabled(bool enabled)
+{
+    activity_enabled = enabled;
+}
+
+/**
+ * @brief Energy gate on one filtered block
+ * @param volts Output of DSP_PreprocessBuffer, n_samples x EMG_NUM_CHANNELS
+ * @return true if any channel's RMS reached ACTIVITY_EMG_RMS_V
+ * @note DSP task only
+ */
+bool Activity_UpdateEmg(const float (*volts)[EMG_NUM_CHANNELS], uint16_t n_samples)
+{
+    const uint32_t now = HAL_GetTick();
+    float sum_sq[EMG_NUM_CHANNELS] = {0.0f};
+    bool active = false;
+
+    for (uint16_t i = 0; i < n_samples; i++) {
+        for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+            sum_sq[ch] += volts[i][ch] * volts[i][ch];
+        }
+    }
+
+    for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS && !active; ch++) {
+        active = sum_sq[ch] >= ACTIVITY_EMG_MS_THRESHOLD * (float)n_samples;
+    }
+
+    if (!activity_enabled) {
+        enter_full_rate(now, NULL);
+    } else if (active) {
+        last_emg = now;
+        enter_full_rate(now, &activity_stats.emg_wakeups);
+    } else {
+        enter_low_rate_if_quiet(now);
+    }
+
+    return active;
+}
+
+/**
+ * @brief Whether the window just completed should be evaluated
+ * @note DSP task only; always true in full-rate mode
+ */
+bool Activity_ShouldProcessWindow(void)
+{
+    const uint32_t now = HAL_GetTick();
+
+    if (activity_mode == ACTIVITY_FULL_RATE) {
+        return true;
+    }
+
+    if (ACC_IsMotionLatched()) {
+        last_motion = now;
+    }
+
+    // Motion seen here or by the monitor task since low-rate mode began
+    if ((int32_t)(last_motion - low_rate_since) > 0) {
+        enter_full_rate(now, &activity_stats.motion_wakeups);
+        return true;
+    }
+
+    if (++window_count >= ACTIVITY_LOW_RATE_DIVIDER) {
+        window_count = 0;
+        return true;
+    }
+
+    activity_stats.windows_skipped++;
+    return false;
+}
+
+/**
+ * @brief Poll the wake-up latch; once a second check the FIFO for slow movement
+ * @note Monitor task; the wake-up function misses motion below
+ *       ACC_WAKE_THRESHOLD_MG after high-pass filtering, the FIFO span does not
+ */
+void Activity_UpdateMotion(void)
+{
+    const uint32_t now = HAL_GetTick();
+    ACC_Sample_t samples[ACC_FIFO_DEPTH];
+    int16_t min[3] = {INT16_MAX, INT16_MAX, INT16_MAX};
+    int16_t max[3] = {INT16_MIN, INT16_MIN, INT16_MIN};
+    bool moving = false;
+    uint8_t n = 0;
+
+    if (ACC_IsMotionLatched()) {
+        moving = true;
+        ACC_ClearMotion();
+    }
+
+    if (now - last_fifo_read >= ACTIVITY_FIFO_PERIOD_MS) {
+        last_fifo_read = now;
+        n = ACC_ReadFifo(samples, ACC_FIFO_DEPTH);
+    }
+
+    for (uint8_t i = 0; i < n; i++) {
+        const int16_t axes[3] = {samples[i].x_mg, samples[i].y_mg, samples[i].z_mg};
+
+        for (uint8_t a = 0; a < 3; a++) {
+            if (axes[a] < min[a]) {
+                min[a] = axes[a];
+            }
+            if (axes[a] > max[a]) {
+                max[a] = axes[a];
+            }
+        }
+    }
+
+    for (uint8_t a = 0; a < 3 && n >= 2; a++) {
+        if (max[a] - min[a] > ACTIVITY_STILL_MG) {
+            moving = true;
+        }
+    }
+
+    if (moving) {
+        last_motion = now;
+    }
+}
+
+/**
+ * @brief Sleep the core until the next interrupt while in low-rate mode
+ * @note The DWT cycle counter stops during sleep, so latency statistics
+ *       are only meaningful in full-rate mode
+ */
+void Activity_IdleSleep(void)
+{
+    if (activity_mode == ACTIVITY_LOW_RATE) {
+        HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+    }
+}
+
+/**
+ * @brief Current pipeline mode
+ */
+Activity_Mode_t Activity_GetMode(void)
+{
+    return activity_mode;
+}
+
+/**
+ * @brief Snapshot of the gating counters
+ */
+void Activity_GetStats(Activity_Stats_t *stats)
+{
+    *stats = activity_stats;
+    stats->mode = activity_mode;
+
+    if (activity_mode == ACTIVITY_LOW_RATE) {
+        stats->low_rate_ms += HAL_GetTick() - low_rate_since;
+    }
+}
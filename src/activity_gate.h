@@ -0,0 +1,86 @@
+/**
+ * @file activity_gate.h
+ * @brief Rest/activity gating of the DSP and ML pipeline
+ *
+ * Two cheap detectors decide whether the full-rate pipeline is needed:
+ * the RMS of every filtered EMG block (DSP task) and arm motion from the
+ * LIS3DH wake-up latch and FIFO (monitor task). Once both have been quiet
+ * for ACTIVITY_REST_TIMEOUT_MS the gate enters low-rate mode: the DSP task
+ * still filters every block and checks its RMS, but extracts features (and
+ * so wakes the ML task) for only one window in ACTIVITY_LOW_RATE_DIVIDER,
+ * and the idle task sleeps the core between DMA bursts. Any EMG block above
+ * threshold, or motion, restores full rate before the next window is
+ * evaluated.
+ */
+
+#ifndef ACTIVITY_GATE_H
+#define ACTIVITY_GATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32h7xx_hal.h"
+#include "emg_config.h"
+
+/* Build configuration -------------------------------------------------------*/
+#ifndef ACTIVITY_GATING
+#define ACTIVITY_GATING             1       // 0 = always full rate
+#endif
+
+#ifndef ACTIVITY_REST_TIMEOUT_MS
+#define ACTIVITY_REST_TIMEOUT_MS    5000U   // Quiet time before low-rate mode
+#endif
+
+#ifndef ACTIVITY_EMG_RMS_V
+#define ACTIVITY_EMG_RMS_V          20e-6f  // Per-channel block RMS counted as muscle activity
+#endif
+
+#ifndef ACTIVITY_STILL_MG
+#define ACTIVITY_STILL_MG           48      // Peak-to-peak per axis over the FIFO counted as still
+#endif
+
+#ifndef ACTIVITY_LOW_RATE_DIVIDER
+#define ACTIVITY_LOW_RATE_DIVIDER   8U      // Windows per evaluated window in low-rate mode
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+    ACTIVITY_FULL_RATE = 0,
+    ACTIVITY_LOW_RATE
+} Activity_Mode_t;
+
+typedef struct {
+    Activity_Mode_t mode;
+    uint32_t low_rate_entries;
+    uint32_t emg_wakeups;         // Low-rate exits caused by EMG energy
+    uint32_t motion_wakeups;      // Low-rate exits caused by the accelerometer
+    uint32_t windows_skipped;
+    uint32_t low_rate_ms;         // Total time spent in low-rate mode
+} Activity_Stats_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void Activity_Init(void);
+void Activity_SetEnabled(bool enabled);
+
+// DSP task: once per filtered block, then once per completed window
+bool Activity_UpdateEmg(const float (*volts)[EMG_NUM_CHANNELS], uint16_t n_samples);   // true if the block is active
+bool Activity_ShouldProcessWindow(void);
+
+// Monitor task: wake-up latch and FIFO stillness check (blocking I2C)
+void Activity_UpdateMotion(void);
+
+// Idle task: sleep until the next interrupt when in low-rate mode
+void Activity_IdleSleep(void);
+
+Activity_Mode_t Activity_GetMode(void);
+void Activity_GetStats(Activity_Stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ACTIVITY_GATE_H */
@@ -0,0 +1,32 @@
+/**
+ * @file bench_host_main.c
+ * @brief Host entry point for the kernel benchmark (BENCH_HOST builds)
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <time.h>
+#include "stm32h7xx_hal.h"
+#include "emg_benchmark.h"
+
+/* Exported variables --------------------------------------------------------*/
+uint32_t SystemCoreClock = 280000000U;
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Millisecond tick for sources that timestamp their output
+ */
+uint32_t HAL_GetTick(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint32_t)(ts.tv_sec * 1000U + ts.tv_nsec / 1000000U);
+}
+
+int main(void)
+{
+    // Node engine only: no folded model to quantize for
+    return (Bench_RunAll(NULL) == HAL_OK) ? 0 : 1;
+}
@@ -0,0 +1,450 @@
+/**
+ * @file emg_benchmark.c
+ * @brief Kernel benchmark suite for the DSP pipeline and Random Forest
+ *
+ * Each kernel is timed in isolation: its inputs are rebuilt from the
+ * recorded window before every call (not timed), so in-place kernels see
+ * the same data on every run. Stack use is measured by painting an area
+ * below the caller's frame, running the kernel once and counting the bytes
+ * that were overwritten.
+ *
+ * The forest cases run the engine RF_INFERENCE_ENGINE selects, on inputs
+ * built as the DSP task builds them (DSP_QuantizeFeatures with the model's
+ * feature_qscale in DSP_QUANTIZED_FEATURES builds), and rf_predict_nodes
+ * runs the node interpreter on the same window, so every build reports
+ * its engine next to the interpreter.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "stm32h7xx_hal.h"
+#include "dsp_pipeline.h"
+#include "random_forest.h"
+#include "emg_benchmark.h"
+#include "bench_windows.h"   // Generated by export_bench_windows.py
+
+// Exports before --channels existed were all 4-channel
+#ifndef BENCH_N_CHANNELS
+#define BENCH_N_CHANNELS 4
+#endif
+
+#if BENCH_N_CHANNELS != EMG_NUM_CHANNELS
+#error "bench_windows.h channel count differs from EMG_NUM_CHANNELS; re-export with --channels"
+#endif
+
+#if defined(BENCH_HOST)
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+#else
+#include "profiler.h"
+#endif
+
+/* Private types -------------------------------------------------------------*/
+// Inputs of all kernels, rebuilt from one recorded window and channel
+typedef struct {
+    float window[DSP_WINDOW_SIZE][EMG_NUM_CHANNELS]; // Mutable copy for DSP_ExtractFeatures
+    float channel[DSP_WINDOW_SIZE];         // Current channel of the window
+    float fft_input[DSP_FFT_SIZE];          // Windowed real samples
+    float fft_output[DSP_FFT_SIZE];         // Packed real spectrum
+    float magnitude[DSP_FFT_SIZE / 2];
+    float freq_resolution;
+    Feature_Vector_t features;
+    fixed_point_t features_q[RF_MAX_FEATURES];      // Input of RF_PREDICT_FIXED
+    fixed_point_t features_norm[RF_MAX_FEATURES];   // Q8.8, input of RF_PredictFixed
+    volatile float sink;                    // Keeps results of pure kernels alive
+} Bench_State_t;
+
+typedef struct {
+    const char *name;
+    void (*run)(Bench_State_t *s);
+    bool per_channel;                       // Run once per channel instead of per window
+} Bench_Case_t;
+
+typedef struct {
+    uint32_t calls;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t sum_cycles;
+    uint32_t stack_bytes;
+} Bench_Accumulator_t;
+
+/* Private variables ---------------------------------------------------------*/
+static DSP_Context_t bench_ctx;
+static Bench_State_t bench_state;
+#if DSP_QUANTIZED_FEATURES
+static const float *bench_qscale;           // Folded normalization of the engine's model
+#endif
+
+/* Private functions ---------------------------------------------------------*/
+static inline uint32_t bench_now(void)
+{
+#if defined(BENCH_HOST)
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#endif
+#else
+    return Profiler_Now();
+#endif
+}
+
+// Paint and scan use identical frames, so their arrays cover the same
+// addresses: the stack the kernel used in between is whatever no longer
+// holds the fill pattern, counted from the deep end
+static __attribute__((noinline)) void stack_paint(void)
+{
+    volatile uint8_t area[BENCH_STACK_PROBE_BYTES];
+
+    for (uint32_t i = 0; i < BENCH_STACK_PROBE_BYTES; i++) {
+        area[i] = BENCH_STACK_FILL;
+    }
+
+    (void)area;
+}
+
+// Reading the uninitialized area is deliberate: it holds what was left
+// on the stack since stack_paint
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+static __attribute__((noinline)) uint32_t stack_scan(void)
+{
+    volatile uint8_t area[BENCH_STACK_PROBE_BYTES];
+    uint32_t untouched = 0;
+
+    // Stack grows down: area[0] is the deepest byte
+    while (untouched < BENCH_STACK_PROBE_BYTES && area[untouched] == BENCH_STACK_FILL) {
+        untouched++;
+    }
+
+    return BENCH_STACK_PROBE_BYTES - untouched;
+}
+#pragma GCC diagnostic pop
+
+// The CMSIS FFT overwrites its input, so it is rebuilt before every run
+static void fill_fft_input(Bench_State_t *s)
+{
+    DSP_KERNEL_WINDOW(s->channel, dsp_hamming_window, s->fft_input, DSP_FFT_SIZE);
+}
+
+// Engine input in the domain of the model's thresholds, as the DSP task
+// (quantized) or the ML task (normalized) produces it
+static void bench_engine_input(const Feature_Vector_t *features, fixed_point_t *engine_q)
+{
+#if DSP_QUANTIZED_FEATURES
+    Feature_VectorQ_t quantized;
+
+    DSP_QuantizeFeatures(features, bench_qscale, &quantized);
+    memcpy(engine_q, quantized.values, features->n_features * sizeof(fixed_point_t));
+#else
+    RF_NormalizeFeatures(features->values, engine_q, features->n_features);
+#endif
+}
+
+// Rebuild all kernel inputs from window w, channel ch, with the
+// intermediate results the pipeline would hand to downstream kernels
+static void bench_prepare(Bench_State_t *s, uint16_t w, uint8_t ch)
+{
+    for (uint16_t i = 0; i < DSP_WINDOW_SIZE; i++) {
+        s->channel[i] = bench_windows[w][i][ch];
+    }
+
+    fill_fft_input(s);
+    DSP_KERNEL_FFT(&bench_ctx, s->fft_input, s->fft_output, DSP_FFT_SIZE);
+    DSP_KERNEL_MAGNITUDE(s->fft_output, s->magnitude, DSP_FFT_SIZE);
+    fill_fft_input(s);
+
+    DSP_Reset(&bench_ctx);
+    memcpy(s->window, bench_windows[w], sizeof(s->window));
+    DSP_ExtractFeatures(&bench_ctx, s->window, &s->features);
+    RF_NormalizeFeatures(s->features.values, s->features_norm, s->features.n_features);
+    bench_engine_input(&s->features, s->features_q);
+
+    // Filter state and window back to their initial contents
+    DSP_Reset(&bench_ctx);
+    memcpy(s->window, bench_windows[w], sizeof(s->window));
+}
+
+static void run_fft(Bench_State_t *s)
+{
+    DSP_KERNEL_FFT(&bench_ctx, s->fft_input, s->fft_output, DSP_FFT_SIZE);
+}
+
+static void run_magnitude(Bench_State_t *s)
+{
+    DSP_KERNEL_MAGNITUDE(s->fft_output, s->magnitude, DSP_FFT_SIZE);
+}
+
+static void run_rms(Bench_State_t *s)
+{
+    s->sink = DSP_CalculateRMS(s->channel, DSP_WINDOW_SIZE);
+}
+
+static void run_mav(Bench_State_t *s)
+{
+    s->sink = DSP_CalculateMAV(s->channel, DSP_WINDOW_SIZE);
+}
+
+static void run_variance(Bench_State_t *s)
+{
+    s->sink = DSP_CalculateVariance(s->channel, DSP_WINDOW_SIZE);
+}
+
+static void run_zero_crossings(Bench_State_t *s)
+{
+    s->sink = DSP_CountZeroCrossings(s->channel, DSP_WINDOW_SIZE, DSP_ZC_THRESHOLD);
+}
+
+static void run_slope_sign_changes(Bench_State_t *s)
+{
+    s->sink = DSP_CountSlopeSignChanges(s->channel, DSP_WINDOW_SIZE);
+}
+
+static void run_waveform_length(Bench_State_t *s)
+{
+    s->sink = DSP_CalculateWaveformLength(s->channel, DSP_WINDOW_SIZE);
+}
+
+static void run_band_power(Bench_State_t *s)
+{
+    s->sink = DSP_CalculateBandPower(s->magnitude, DSP_FFT_SIZE / 2, s->freq_resolution,
+                                     BAND2_LOW, BAND2_HIGH);
+}
+
+static void run_median_frequency(Bench_State_t *s)
+{
+    s->sink = DSP_CalculateMedianFrequency(s->magnitude, DSP_FFT_SIZE / 2, s->freq_resolution);
+}
+
+static void run_frequency_features(Bench_State_t *s)
+{
+    FrequencyDomainFeatures_t freq;
+
+    DSP_ExtractFrequencyDomainFeatures(&bench_ctx, s->magnitude, &freq);
+    s->sink = freq.median_freq;
+}
+
+static void run_extract_features(Bench_State_t *s)
+{
+    DSP_ExtractFeatures(&bench_ctx, s->window, &s->features);
+}
+
+// Float vector in, class out: includes the normalization or quantization
+static void run_rf_predict(Bench_State_t *s)
+{
+    uint8_t confidence;
+
+#if DSP_QUANTIZED_FEATURES
+    // RF_PREDICT would normalize to Q8.8, which a folded model cannot read
+    fixed_point_t engine_q[RF_MAX_FEATURES];
+
+    bench_engine_input(&s->features, engine_q);
+    s->sink = RF_PREDICT_FIXED(engine_q, &confidence);
+#else
+    s->sink = RF_PREDICT(s->features.values, &confidence);
+#endif
+}
+
+static void run_rf_predict_fixed(Bench_State_t *s)
+{
+    uint8_t confidence;
+
+    s->sink = RF_PREDICT_FIXED(s->features_q, &confidence);
+}
+
+// Node interpreter on the same window, the reference for the engine above
+static void run_rf_predict_nodes(Bench_State_t *s)
+{
+    uint8_t confidence;
+
+    s->sink = RF_PredictFixed(s->features_norm, &confidence);
+}
+
+// RF_MAX_BATCH copies of the window's vector; divide the cycles by the batch
+static void run_rf_predict_batch(Bench_State_t *s)
+{
+    const fixed_point_t *batch[RF_MAX_BATCH];
+    RF_Vote_t votes[RF_MAX_BATCH];
+    RF_Result_t results[RF_MAX_BATCH];
+
+    for (uint8_t v = 0; v < RF_MAX_BATCH; v++) {
+        batch[v] = s->features_q;
+    }
+
+    RF_PREDICT_BATCH(batch, RF_MAX_BATCH, NULL, votes, results);
+    s->sink = results[RF_MAX_BATCH - 1].class_id;
+}
+
+static const Bench_Case_t bench_cases[] = {
+    { "fft",                 run_fft,                true  },
+    { "magnitude",           run_magnitude,          true  },
+    { "rms",                 run_rms,                true  },
+    { "mav",                 run_mav,                true  },
+    { "variance",            run_variance,           true  },
+    { "zero_crossings",      run_zero_crossings,     true  },
+    { "slope_sign_changes",  run_slope_sign_changes, true  },
+    { "waveform_length",     run_waveform_length,    true  },
+    { "band_power",          run_band_power,         true  },
+    { "median_frequency",    run_median_frequency,   true  },
+    { "frequency_features",  run_frequency_features, true  },
+    { "extract_features",    run_extract_features,   false },
+    { "rf_predict",          run_rf_predict,         false },
+    { "rf_predict_fixed",    run_rf_predict_fixed,   false },
+    { "rf_predict_nodes",    run_rf_predict_nodes,   false },
+    { "rf_predict_batch",    run_rf_predict_batch,   false },
+};
+
+#define BENCH_NUM_CASES  (sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+static void bench_measure(const Bench_Case_t *c, Bench_Accumulator_t *acc, uint16_t w, uint8_t ch)
+{
+    uint32_t start;
+    uint32_t cycles;
+    uint32_t stack;
+
+    // Untimed run for the stack depth; also warms the caches
+    bench_prepare(&bench_state, w, ch);
+    stack_paint();
+    c->run(&bench_state);
+    stack = stack_scan();
+
+    if (stack > acc->stack_bytes) {
+        acc->stack_bytes = stack;
+    }
+
+    bench_prepare(&bench_state, w, ch);
+    start = bench_now();
+    c->run(&bench_state);
+    cycles = bench_now() - start;
+
+    acc->calls++;
+    acc->sum_cycles += cycles;
+
+    if (cycles < acc->min_cycles) {
+        acc->min_cycles = cycles;
+    }
+
+    if (cycles > acc->max_cycles) {
+        acc->max_cycles = cycles;
+    }
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Run every kernel over all recorded windows
+ * @param feature_qscale Folded normalization of the loaded engine's model;
+ *                       required with DSP_QUANTIZED_FEATURES, else ignored
+ * @param results        Output array, one entry per kernel
+ * @param max_results    Capacity of results
+ * @return Number of results written
+ * @note The selected engine's model must be loaded; RF_LoadModel (node
+ *       interpreter and normalization) is called here
+ */
+uint8_t Bench_Run(const float *feature_qscale, Bench_Result_t *results, uint8_t max_results)
+{
+    Bench_Accumulator_t acc[BENCH_NUM_CASES];
+    uint8_t n_results;
+
+    memset(acc, 0, sizeof(acc));
+
+    for (uint8_t k = 0; k < BENCH_NUM_CASES; k++) {
+        acc[k].min_cycles = UINT32_MAX;
+    }
+
+    if (DSP_Init(&bench_ctx) != HAL_OK || DSP_InitSpectralBands(&bench_ctx) != HAL_OK ||
+        RF_LoadModel() != HAL_OK) {
+        return 0;
+    }
+
+#if DSP_QUANTIZED_FEATURES
+    if (feature_qscale == NULL) {
+        return 0;
+    }
+    bench_qscale = feature_qscale;
+#else
+    (void)feature_qscale;
+#endif
+
+    // Windows are recorded raw: DSP_ExtractFeatures filters and rescans
+    bench_ctx.prefiltered = false;
+    bench_ctx.td_incremental = false;
+    bench_state.freq_resolution = DSP_GetFrequencyResolution(DSP_SAMPLE_RATE, DSP_FFT_SIZE);
+
+    for (uint16_t w = 0; w < BENCH_N_WINDOWS; w++) {
+        for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+            for (uint8_t k = 0; k < BENCH_NUM_CASES; k++) {
+                if (!bench_cases[k].per_channel && ch != 0) {
+                    continue;
+                }
+
+                bench_measure(&bench_cases[k], &acc[k], w, ch);
+            }
+        }
+    }
+
+    n_results = (BENCH_NUM_CASES < max_results) ? BENCH_NUM_CASES : max_results;
+
+    for (uint8_t k = 0; k < n_results; k++) {
+        results[k].name = bench_cases[k].name;
+        results[k].calls = acc[k].calls;
+        results[k].min_cycles = (acc[k].calls != 0) ? acc[k].min_cycles : 0;
+        results[k].avg_cycles = (acc[k].calls != 0) ? (uint32_t)(acc[k].sum_cycles / acc[k].calls) : 0;
+        results[k].max_cycles = acc[k].max_cycles;
+        results[k].stack_bytes = acc[k].stack_bytes;
+    }
+
+    return n_results;
+}
+
+/**
+ * @brief Run the suite and print one line per kernel
+ * @note Output format: BENCH <name> <calls> <min> <avg> <max> <stack_bytes>
+ */
+HAL_StatusTypeDef Bench_RunAll(const float *feature_qscale)
+{
+    Bench_Result_t results[BENCH_MAX_CASES];
+    uint8_t n = Bench_Run(feature_qscale, results, BENCH_MAX_CASES);
+
+    if (n == 0) {
+        printf("BENCH ERROR: DSP/RF initialization failed\r\n");
+        return HAL_ERROR;
+    }
+
+    printf("BENCH windows=%u unit=%s\r\n", (unsigned)BENCH_N_WINDOWS, Bench_GetUnit());
+
+    for (uint8_t k = 0; k < n; k++) {
+        printf("BENCH %-20s %6lu %8lu %8lu %8lu %6lu\r\n",
+               results[k].name,
+               (unsigned long)results[k].calls,
+               (unsigned long)results[k].min_cycles,
+               (unsigned long)results[k].avg_cycles,
+               (unsigned long)results[k].max_cycles,
+               (unsigned long)results[k].stack_bytes);
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Unit of the cycle columns for this build
+ */
+const char* Bench_GetUnit(void)
+{
+#if defined(BENCH_HOST)
+#if defined(__x86_64__) || defined(__i386__)
+    return "tsc";
+#else
+    return "ns";
+#endif
+#else
+    return "cyc";
+#endif
+}
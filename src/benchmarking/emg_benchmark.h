@@ -0,0 +1,54 @@
+/**
+ * @file emg_benchmark.h
+ * @brief Kernel benchmark suite for the DSP pipeline and Random Forest
+ *
+ * Runs every DSP kernel, the selected forest engine and the node
+ * interpreter over recorded EMG windows (bench_windows.h, generated by export_bench_windows.py) and
+ * reports cycles per call and peak stack per kernel. The same sources
+ * build for the target (DWT cycle counter) and for the host with
+ * BENCH_HOST defined (TSC on x86, nanoseconds elsewhere).
+ */
+
+#ifndef EMG_BENCHMARK_H
+#define EMG_BENCHMARK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm32h7xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define BENCH_MAX_CASES         16
+#define BENCH_STACK_PROBE_BYTES 4096    // Stack area painted before each call
+#define BENCH_STACK_FILL        0xA5U
+
+/* Exported types ------------------------------------------------------------*/
+// Statistics of one kernel over all recorded windows
+typedef struct {
+    const char *name;
+    uint32_t calls;
+    uint32_t min_cycles;
+    uint32_t avg_cycles;
+    uint32_t max_cycles;
+    uint32_t stack_bytes;     // Peak stack below the caller's frame
+} Bench_Result_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+// Run all kernels; returns the number of results written (<= max_results).
+// feature_qscale: the engine model's folded normalization (DSP_QUANTIZED_FEATURES)
+uint8_t Bench_Run(const float *feature_qscale, Bench_Result_t *results, uint8_t max_results);
+
+// Run all kernels and print one "BENCH" line per kernel
+HAL_StatusTypeDef Bench_RunAll(const float *feature_qscale);
+
+// Unit of the cycle columns ("cyc", "tsc" or "ns")
+const char* Bench_GetUnit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EMG_BENCHMARK_H */
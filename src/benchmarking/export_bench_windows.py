@@ -0,0 +1,103 @@
+"""
+Export recorded EMG windows to bench_windows.h for the kernel benchmark.
+
+Reads the .npz recordings described in datasets/README.md ('emg_data'
+arrays of shape (n, channels), volts) and writes a fixed set of analysis windows as a
+const C array, so target and host runs of emg_benchmark.c see identical
+input.
+
+Example:
+    python src/benchmarking/export_bench_windows.py \
+        --dataset datasets/TSL_3class_dataset --windows 32 \
+        --output src/benchmarking/bench_windows.h
+"""
+
+import argparse
+import glob
+import os
+import numpy as np
+from typing import List
+
+
+# Must match DSP_WINDOW_SIZE / DSP_DEFAULT_HOP_SIZE in dsp_pipeline.h
+WINDOW_SIZE = 256
+HOP_SIZE = 128
+N_CHANNELS = 4          # Default; must match EMG_NUM_CHANNELS in emg_config.h
+
+
+def collect_windows(dataset_path: str, n_windows: int, scale: float = 1.0,
+                    n_channels: int = N_CHANNELS) -> np.ndarray:
+    """
+    Cut windows from the recordings, spread evenly over files and classes.
+
+    Args:
+        dataset_path: Dataset root (class sub-directories with .npz files)
+        n_windows: Number of windows to export
+        scale: Multiplier applied to emg_data (e.g. volts per ADC code)
+        n_channels: Channels per sample, EMG_NUM_CHANNELS of the target build
+
+    Returns:
+        Array of shape (n_windows, WINDOW_SIZE, n_channels), float32
+    """
+    files = sorted(glob.glob(os.path.join(dataset_path, "**", "*.npz"), recursive=True))
+    if not files:
+        raise FileNotFoundError(f"No .npz recordings found under {dataset_path}")
+
+    candidates: List[np.ndarray] = []
+    for fname in files:
+        emg = np.asarray(np.load(fname)['emg_data'], dtype=np.float64) * scale
+        if emg.ndim != 2 or emg.shape[1] != n_channels:
+            raise ValueError(f"{fname}: expected emg_data of shape (n, {n_channels})")
+        for start in range(0, emg.shape[0] - WINDOW_SIZE + 1, HOP_SIZE):
+            candidates.append(emg[start:start + WINDOW_SIZE])
+
+    if len(candidates) < n_windows:
+        raise ValueError(f"Only {len(candidates)} windows available, {n_windows} requested")
+
+    # Deterministic, evenly spaced selection keeps the set stable across runs
+    picks = np.linspace(0, len(candidates) - 1, n_windows).astype(int)
+    return np.stack([candidates[i] for i in picks]).astype(np.float32)
+
+
+def write_header(filepath: str, windows: np.ndarray, source: str):
+    """
+    Write windows as `static const float bench_windows[N][WINDOW_SIZE][channels]`.
+    """
+    n_windows, _, n_channels = windows.shape
+
+    with open(filepath, 'w') as f:
+        f.write("#ifndef BENCH_WINDOWS_H\n")
+        f.write("#define BENCH_WINDOWS_H\n\n")
+        f.write("// Generated by export_bench_windows.py - do not edit\n")
+        f.write(f"// Source: {source}\n\n")
+        f.write(f"#define BENCH_N_WINDOWS {n_windows}\n")
+        f.write(f"#define BENCH_N_CHANNELS {n_channels}\n\n")
+
+        f.write(f"static const float bench_windows[BENCH_N_WINDOWS][{WINDOW_SIZE}][BENCH_N_CHANNELS] = {{\n")
+        for w in range(n_windows):
+            f.write("    {\n")
+            for i in range(WINDOW_SIZE):
+                row = ", ".join(repr(float(v)) + "f" for v in windows[w, i])
+                f.write(f"        {{{row}}},\n")
+            f.write("    },\n")
+        f.write("};\n\n")
+
+        f.write("#endif // BENCH_WINDOWS_H\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Export EMG windows for the kernel benchmark")
+    parser.add_argument("--dataset", required=True, help="Dataset root with .npz recordings")
+    parser.add_argument("--windows", type=int, default=32, help="Number of windows to export")
+    parser.add_argument("--scale", type=float, default=1.0, help="Multiplier applied to emg_data")
+    parser.add_argument("--channels", type=int, default=N_CHANNELS, help="EMG_NUM_CHANNELS of the target build")
+    parser.add_argument("--output", default=os.path.join(os.path.dirname(__file__), "bench_windows.h"))
+    args = parser.parse_args()
+
+    windows = collect_windows(args.dataset, args.windows, args.scale, args.channels)
+    write_header(args.output, windows, os.path.normpath(args.dataset))
+    print(f"Wrote {windows.shape[0]} windows to {args.output}")
+
+
+if __name__ == "__main__":
+    main()
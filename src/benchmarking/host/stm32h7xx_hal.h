@@ -0,0 +1,47 @@
+/**
+ * @file stm32h7xx_hal.h
+ * @brief Minimal host stand-in for the STM32H7 HAL used by the benchmark
+ *
+ * Only what the DSP and Random Forest sources need to compile on x86.
+ * Put this directory on the include path of host builds only.
+ */
+
+#ifndef STM32H7XX_HAL_H
+#define STM32H7XX_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Build configuration -------------------------------------------------------*/
+// No TCM or MPU on the host; memory_map.h keeps default sections
+#define MEM_PLACEMENT 0
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+    HAL_OK      = 0x00U,
+    HAL_ERROR   = 0x01U,
+    HAL_BUSY    = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef struct {
+    void *Instance;
+} SPI_HandleTypeDef;
+
+/* Exported variables --------------------------------------------------------*/
+extern uint32_t SystemCoreClock;
+
+/* Exported functions prototypes ---------------------------------------------*/
+uint32_t HAL_GetTick(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STM32H7XX_HAL_H */
@@ -0,0 +1,363 @@
+/**
+ * @file debug_cmd.c
+ * @brief Line reception from a circular UART DMA ring and command dispatch
+ *
+ * The DMA writes the ring continuously; the RX event interrupt only adds
+ * the new byte count to rx_head and wakes the reader if a '\r' or '\n'
+ * came in. The reader task owns rx_tail and assembles lines, so a command
+ * costs one wakeup regardless of its length. If the reader falls more than
+ * a ring behind, the lost bytes are counted and the partial line dropped.
+ *
+ * A line error aborts the DMA, which then restarts at rx_buf[0]. The ISR
+ * rounds rx_head up to the next multiple of CMD_RX_BUFFER_SIZE, so the
+ * free-running indices keep mapping onto ring positions, and records the
+ * skipped span as a gap. The reader jumps over it and drops the line the
+ * error cut.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "debug_cmd.h"
+#include "memory_map.h"
+
+/* Private defines -----------------------------------------------------------*/
+#if (CMD_RX_BUFFER_SIZE % 32) != 0
+#error "CMD_RX_BUFFER_SIZE must be a multiple of the 32-byte cache line"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static UART_HandleTypeDef *cmd_uart = NULL;
+static TaskHandle_t cmd_reader = NULL;
+
+static uint8_t rx_buf[CMD_RX_BUFFER_SIZE] DMA_BUFFER;
+static uint16_t rx_dma_pos = 0;             // Last DMA position seen (ISR only)
+static volatile uint32_t rx_head = 0;       // Bytes received (monotonic)
+static uint32_t rx_tail = 0;                // Bytes consumed by the reader
+
+// Span skipped by the last restart; set by the ISR, cleared by the reader
+// in a critical section
+static bool rx_gap_pending = false;
+static uint32_t rx_gap_start = 0;           // rx_head at the error
+static uint32_t rx_gap_end = 0;             // rx_head after the restart
+static uint32_t rx_gap_lost = 0;            // Bytes a second error dropped before the reader got there
+
+// Line being assembled by the reader
+static char cmd_line[CMD_MAX_LINE];
+static uint16_t cmd_line_len = 0;
+static bool cmd_discard = false;            // Skip to the next terminator
+
+static const Cmd_Entry_t *cmd_tables[CMD_MAX_TABLES];
+static uint8_t cmd_table_counts[CMD_MAX_TABLES];
+static uint8_t cmd_num_tables = 0;
+static Cmd_Handler_t cmd_fallback = NULL;
+
+static Cmd_Stats_t cmd_stats;
+
+/* Private functions ---------------------------------------------------------*/
+static inline bool is_terminator(uint8_t c)
+{
+    return c == '\r' || c == '\n';
+}
+
+static HAL_StatusTypeDef rx_start(void)
+{
+    rx_dma_pos = 0;
+    return HAL_UARTEx_ReceiveToIdle_DMA(cmd_uart, rx_buf, CMD_RX_BUFFER_SIZE);
+}
+
+// Apply an overrun or a reached restart gap; returns where reading must pause
+static uint32_t rx_sync(void)
+{
+    uint32_t end;
+
+    taskENTER_CRITICAL();
+    end = rx_head;
+
+    if (end - rx_tail > CMD_RX_BUFFER_SIZE) {
+        cmd_stats.overruns += end - rx_tail - CMD_RX_BUFFER_SIZE;
+        rx_tail = end - CMD_RX_BUFFER_SIZE;
+        cmd_line_len = 0;
+        cmd_discard = true;
+    }
+
+    if (rx_gap_pending) {
+        if ((int32_t)(rx_tail - rx_gap_start) >= 0) {
+            cmd_stats.error_bytes += cmd_line_len + rx_gap_lost;
+            if ((int32_t)(rx_gap_end - rx_tail) > 0) {
+                rx_tail = rx_gap_end;
+            }
+            rx_gap_lost = 0;
+            rx_gap_pending = false;
+            cmd_line_len = 0;
+            cmd_discard = true;
+        } else {
+            end = rx_gap_start;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return end;
+}
+
+// Consume received bytes up to the next complete line
+static bool rx_extract_line(char *line, uint16_t max_len)
+{
+    uint32_t end = rx_sync();
+
+    while (rx_tail != end) {
+        const uint8_t c = rx_buf[rx_tail % CMD_RX_BUFFER_SIZE];
+
+        rx_tail++;
+
+        if (is_terminator(c)) {
+            const bool complete = !cmd_discard && cmd_line_len > 0;
+            uint16_t n = cmd_line_len;
+
+            cmd_line_len = 0;
+            cmd_discard = false;
+
+            if (complete) {
+                if (n > max_len - 1) {
+                    n = max_len - 1;
+                }
+                memcpy(line, cmd_line, n);
+                line[n] = '\0';
+                cmd_stats.lines_received++;
+                return true;
+            }
+        } else if (cmd_line_len < CMD_MAX_LINE - 1) {
+            cmd_line[cmd_line_len++] = (char)c;
+        } else {
+            cmd_discard = true;  // Overlong line, reject it whole
+        }
+
+        if (rx_tail == end) {
+            end = rx_sync();     // Stopped at a gap, or more bytes came in
+        }
+    }
+
+    return false;
+}
+
+static bool dispatch_table(const Cmd_Entry_t *table, uint8_t count,
+                           const char *word, size_t word_len, const char *args)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        if (strlen(table[i].name) == word_len &&
+            strncmp(table[i].name, word, word_len) == 0) {
+            table[i].handler(args);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void print_help(void)
+{
+    printf("\r\n=== Commands ===\r\n");
+
+    for (uint8_t t = 0; t < cmd_num_tables; t++) {
+        for (uint8_t i = 0; i < cmd_table_counts[t]; i++) {
+            const Cmd_Entry_t *entry = &cmd_tables[t][i];
+            printf("%-16s %s\r\n", entry->name, entry->help ? entry->help : "");
+        }
+    }
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Start circular ReceiveToIdle DMA reception on the debug UART
+ */
+HAL_StatusTypeDef Cmd_Init(UART_HandleTypeDef *huart)
+{
+    if (huart == NULL || huart->hdmarx == NULL) {
+        return HAL_ERROR;
+    }
+
+    memset(&cmd_stats, 0, sizeof(cmd_stats));
+    rx_head = 0;
+    rx_tail = 0;
+    rx_gap_pending = false;
+    rx_gap_lost = 0;
+    cmd_line_len = 0;
+    cmd_discard = false;
+    cmd_uart = huart;
+
+    return rx_start();
+}
+
+/**
+ * @brief Account for bytes the DMA wrote up to position
+ * @param position Write index in the ring as reported by the HAL
+ *                 (CMD_RX_BUFFER_SIZE at transfer complete)
+ * @note Runs in the UART/DMA interrupt
+ */
+void Cmd_RxEvent(uint16_t position)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint16_t n;
+    bool line_end = false;
+
+    if (position > CMD_RX_BUFFER_SIZE || position == rx_dma_pos) {
+        return;
+    }
+
+    n = (position > rx_dma_pos) ? (position - rx_dma_pos)
+                                : (CMD_RX_BUFFER_SIZE - rx_dma_pos + position);
+
+#if MEM_DMA_CACHE_MAINTENANCE
+    // Drop stale lines before looking at what the DMA wrote
+    SCB_InvalidateDCache_by_Addr((uint32_t *)rx_buf, CMD_RX_BUFFER_SIZE);
+#endif
+
+    for (uint16_t i = 0; i < n && !line_end; i++) {
+        line_end = is_terminator(rx_buf[(rx_dma_pos + i) % CMD_RX_BUFFER_SIZE]);
+    }
+
+    rx_dma_pos = position % CMD_RX_BUFFER_SIZE;
+    cmd_stats.bytes_received += n;
+    __atomic_store_n(&rx_head, rx_head + n, __ATOMIC_RELEASE);
+
+    if (line_end && cmd_reader != NULL) {
+        vTaskNotifyGiveFromISR(cmd_reader, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+}
+
+/**
+ * @brief Restart reception after the HAL aborted it on a line error
+ * @note Runs in the UART interrupt. The new DMA pass writes rx_buf[0]
+ *       first, so rx_head moves to the next multiple of the ring size.
+ */
+void Cmd_RxError(void)
+{
+    uint32_t head;
+
+    if (cmd_uart == NULL || cmd_uart->RxState != HAL_UART_STATE_READY) {
+        return;
+    }
+
+    // The reader only touches the gap with this interrupt masked
+    head = rx_head;
+
+    if (rx_gap_pending) {
+        // Reader has not reached the last gap: restart over what came since
+        rx_gap_lost += head - rx_gap_end;
+    } else {
+        rx_gap_start = head;
+        rx_gap_end = (head + CMD_RX_BUFFER_SIZE - 1U) / CMD_RX_BUFFER_SIZE * CMD_RX_BUFFER_SIZE;
+        rx_gap_pending = true;
+    }
+    rx_head = rx_gap_end;
+    cmd_stats.line_errors++;
+
+    rx_start();
+}
+
+/**
+ * @brief Wait for the next complete command line
+ * @param line    Receives the line without its terminator
+ * @param max_len Size of line; longer lines are truncated
+ * @param timeout Ticks to wait when no line is buffered yet
+ * @return true if a line was copied
+ * @note Only one task may read lines
+ */
+bool Cmd_WaitLine(char *line, uint16_t max_len, TickType_t timeout)
+{
+    if (max_len == 0) {
+        return false;
+    }
+
+    cmd_reader = xTaskGetCurrentTaskHandle();
+
+    if (rx_extract_line(line, max_len)) {
+        return true;
+    }
+
+    ulTaskNotifyTake(pdTRUE, timeout);
+
+    return rx_extract_line(line, max_len);
+}
+
+/**
+ * @brief Add a command table; the table must stay valid
+ */
+HAL_StatusTypeDef Cmd_Register(const Cmd_Entry_t *table, uint8_t count)
+{
+    if (table == NULL || count == 0 || cmd_num_tables >= CMD_MAX_TABLES) {
+        return HAL_ERROR;
+    }
+
+    cmd_tables[cmd_num_tables] = table;
+    cmd_table_counts[cmd_num_tables] = count;
+    cmd_num_tables++;
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Handler for lines no table matches
+ */
+void Cmd_SetFallback(Cmd_Handler_t fallback)
+{
+    cmd_fallback = fallback;
+}
+
+/**
+ * @brief Run the handler for one command line
+ * @return false if nothing handled the line
+ */
+bool Cmd_Dispatch(const char *line)
+{
+    const char *word;
+    const char *args;
+    size_t word_len;
+
+    while (*line == ' ' || *line == '\t') {
+        line++;
+    }
+
+    if (*line == '\0') {
+        return false;
+    }
+
+    word = line;
+    word_len = strcspn(word, " \t");
+    args = word + word_len;
+
+    while (*args == ' ' || *args == '\t') {
+        args++;
+    }
+
+    if (word_len == 4 && strncmp(word, "HELP", 4) == 0) {
+        print_help();
+        return true;
+    }
+
+    for (uint8_t t = 0; t < cmd_num_tables; t++) {
+        if (dispatch_table(cmd_tables[t], cmd_table_counts[t], word, word_len, args)) {
+            return true;
+        }
+    }
+
+    if (cmd_fallback != NULL) {
+        cmd_fallback(line);
+        return true;
+    }
+
+    cmd_stats.unknown++;
+    printf("ERR unknown command: %.*s\r\n", (int)word_len, word);
+
+    return false;
+}
+
+/**
+ * @brief Snapshot of the reception counters
+ */
+void Cmd_GetStats(Cmd_Stats_t *stats)
+{
+    *stats = cmd_stats;
+}
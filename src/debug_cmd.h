@@ -0,0 +1,74 @@
+/**
+ * @file debug_cmd.h
+ * @brief Debug UART command reception and table-driven dispatch
+ */
+
+#ifndef DEBUG_CMD_H
+#define DEBUG_CMD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32h7xx_hal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define CMD_RX_BUFFER_SIZE    256     // DMA ring, bytes, multiple of 32
+#define CMD_MAX_LINE          128     // Longest command line incl. arguments
+#define CMD_MAX_TABLES        4       // Tables registered with Cmd_Register
+
+/* Exported types ------------------------------------------------------------*/
+// Handler for one command; args points past the command word and any
+// spaces, and is "" when there are none
+typedef void (*Cmd_Handler_t)(const char *args);
+
+typedef struct {
+    const char *name;         // Command word, matched exactly, e.g. "SYS:INFO?"
+    Cmd_Handler_t handler;
+    const char *help;         // One line for HELP, may be NULL
+} Cmd_Entry_t;
+
+// Diagnostics
+typedef struct {
+    uint32_t bytes_received;
+    uint32_t lines_received;
+    uint32_t overruns;        // Bytes lost because the task fell behind
+    uint32_t line_errors;     // Receptions restarted after ORE/FE/NE
+    uint32_t error_bytes;     // Bytes of lines those errors cut, dropped
+    uint32_t unknown;         // Lines no table or fallback accepted
+} Cmd_Stats_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+/*
+ * The UART receives into a circular DMA ring with idle-line detection.
+ * Cmd_RxEvent runs from HAL_UARTEx_RxEventCallback (half, full and idle
+ * events), publishes the new write position and notifies the waiting task
+ * once a line terminator has arrived. The task copies lines out of the
+ * ring in Cmd_WaitLine, so nothing is polled per character.
+ */
+HAL_StatusTypeDef Cmd_Init(UART_HandleTypeDef *huart);         // Requires hdmarx linked
+void Cmd_RxEvent(uint16_t position);                           // From HAL_UARTEx_RxEventCallback
+void Cmd_RxError(void);                                        // From HAL_UART_ErrorCallback
+bool Cmd_WaitLine(char *line, uint16_t max_len, TickType_t timeout);
+
+/*
+ * Dispatch searches the registered tables in registration order. Lines
+ * that match no entry go to the fallback (e.g. Monitor_ProcessCommand),
+ * which lets a module add commands without a table. "HELP" lists every
+ * registered entry.
+ */
+HAL_StatusTypeDef Cmd_Register(const Cmd_Entry_t *table, uint8_t count);
+void Cmd_SetFallback(Cmd_Handler_t fallback);                  // Receives the whole line
+bool Cmd_Dispatch(const char *line);
+void Cmd_GetStats(Cmd_Stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEBUG_CMD_H */
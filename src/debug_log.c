@@ -0,0 +1,353 @@
+/**
+ * @file debug_log.c
+ * @brief Lock-free multi-producer log ring drained by UART TX DMA
+ *
+ * The ring holds 4-byte aligned records: a header word followed by the
+ * payload. A writer reserves space by advancing log_head with a
+ * compare-and-swap, copies its payload and publishes the record by
+ * storing the header with LOG_HDR_READY last. Records never wrap; a pad
+ * record fills the end of the ring instead. The single active drainer
+ * copies ready records in order into the DMA buffer, zeroes the consumed
+ * bytes so stale data never looks ready, and advances log_tail. A writer
+ * preempted mid-record only holds back the records behind it.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "debug_log.h"
+#include "memory_map.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define LOG_RING_MASK         (LOG_RING_SIZE - 1U)
+#define LOG_HDR_READY         0x80000000U
+#define LOG_HDR_PAD           0x40000000U
+#define LOG_HDR_TOTAL_MASK    0x0000FFFFU   // Record size incl. header, bytes
+#define LOG_HDR_PAYLOAD_SHIFT 16U           // Payload length, bits 16-29
+
+#if (LOG_RING_SIZE & LOG_RING_MASK) != 0
+#error "LOG_RING_SIZE must be a power of two"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static UART_HandleTypeDef *log_uart = NULL;
+
+static uint8_t log_ring[LOG_RING_SIZE] __attribute__((aligned(4)));
+static volatile uint32_t log_head = 0;     // Reserved bytes (monotonic)
+static volatile uint32_t log_tail = 0;     // Consumed bytes (monotonic)
+
+// DMA source in the non-cacheable region (whole cache lines otherwise)
+static uint8_t log_tx_buf[LOG_TX_CHUNK] DMA_BUFFER;
+static volatile uint32_t log_tx_busy = 0;
+
+static Log_Stats_t log_stats;
+
+#if !LOG_DEFERRED_FORMAT
+#define LOG_FORMAT_STRING(id, fmt)  fmt,
+static const char *const log_formats[LOG_NUM_FORMATS] = {
+    LOG_FORMAT_TABLE(LOG_FORMAT_STRING)
+};
+#undef LOG_FORMAT_STRING
+#endif
+
+/* Private functions ---------------------------------------------------------*/
+static inline uint32_t *header_at(uint32_t pos)
+{
+    return (uint32_t *)&log_ring[pos & LOG_RING_MASK];
+}
+
+// Reserve `total` contiguous bytes; *skip bytes before them become padding
+static bool ring_reserve(uint32_t total, uint32_t *start, uint32_t *skip)
+{
+    uint32_t head = __atomic_load_n(&log_head, __ATOMIC_RELAXED);
+    uint32_t offset;
+    uint32_t need;
+
+    do {
+        offset = head & LOG_RING_MASK;
+        *skip = (offset + total > LOG_RING_SIZE) ? (LOG_RING_SIZE - offset) : 0U;
+        need = *skip + total;
+
+        if (head + need - __atomic_load_n(&log_tail, __ATOMIC_ACQUIRE) > LOG_RING_SIZE) {
+            return false;
+        }
+    } while (!__atomic_compare_exchange_n(&log_head, &head, head + need, true,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    *start = head;
+    return true;
+}
+
+static bool ring_put(const uint8_t *data, uint32_t len)
+{
+    const uint32_t total = 4U + ((len + 3U) & ~3U);
+    uint32_t start;
+    uint32_t skip;
+
+    if (!ring_reserve(total, &start, &skip)) {
+        __atomic_fetch_add(&log_stats.records_dropped, 1U, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    if (skip != 0) {
+        __atomic_store_n(header_at(start), LOG_HDR_READY | LOG_HDR_PAD | skip, __ATOMIC_RELEASE);
+        start += skip;
+    }
+
+    memcpy(&log_ring[(start & LOG_RING_MASK) + 4U], data, len);
+
+    // Publish: the drainer reads the payload only after seeing READY
+    __atomic_store_n(header_at(start),
+                     LOG_HDR_READY | (len << LOG_HDR_PAYLOAD_SHIFT) | total,
+                     __ATOMIC_RELEASE);
+
+    __atomic_fetch_add(&log_stats.bytes_written, len, __ATOMIC_RELAXED);
+    return true;
+}
+
+// Move ready records from the ring into `out`; returns bytes copied
+static uint32_t ring_take(uint8_t *out, uint32_t capacity)
+{
+    uint32_t tail = log_tail;
+    uint32_t n = 0;
+
+    while (1) {
+        const uint32_t hdr = __atomic_load_n(header_at(tail), __ATOMIC_ACQUIRE);
+        const uint32_t total = hdr & LOG_HDR_TOTAL_MASK;
+        const uint32_t len = (hdr >> LOG_HDR_PAYLOAD_SHIFT) & 0x3FFFU;
+
+        if ((hdr & LOG_HDR_READY) == 0) {
+            break;
+        }
+
+        if ((hdr & LOG_HDR_PAD) == 0) {
+            if (n + len > capacity) {
+                break;
+            }
+            memcpy(&out[n], &log_ring[(tail & LOG_RING_MASK) + 4U], len);
+            n += len;
+        }
+
+        memset(&log_ring[tail & LOG_RING_MASK], 0, total);
+        tail += total;
+    }
+
+    __atomic_store_n(&log_tail, tail, __ATOMIC_RELEASE);
+
+    return n;
+}
+
+static inline bool ring_has_ready(void)
+{
+    return (__atomic_load_n(header_at(log_tail), __ATOMIC_ACQUIRE) & LOG_HDR_READY) != 0;
+}
+
+// Start a DMA transfer if the transmitter is idle and data is ready
+static void log_kick(void)
+{
+    uint32_t n;
+
+    if (log_uart == NULL) {
+        return;
+    }
+
+    do {
+        if (__atomic_exchange_n(&log_tx_busy, 1U, __ATOMIC_ACQUIRE) != 0) {
+            return;  // Current drainer or the TX-complete interrupt picks it up
+        }
+
+        n = ring_take(log_tx_buf, LOG_TX_CHUNK);
+
+        if (n != 0) {
+#if MEM_DMA_CACHE_MAINTENANCE
+            SCB_CleanDCache_by_Addr((uint32_t *)log_tx_buf, LOG_TX_CHUNK);
+#endif
+
+            if (HAL_UART_Transmit_DMA(log_uart, log_tx_buf, (uint16_t)n) == HAL_OK) {
+                __atomic_fetch_add(&log_stats.bytes_sent, n, __ATOMIC_RELAXED);
+                return;
+            }
+
+            // Already consumed from the ring; the chunk is lost
+            __atomic_fetch_add(&log_stats.bytes_dropped, n, __ATOMIC_RELAXED);
+        }
+
+        __atomic_store_n(&log_tx_busy, 0U, __ATOMIC_RELEASE);
+
+        // A record published after ring_take saw busy set and left it to us
+    } while (n == 0 && ring_has_ready());
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Attach the log to a UART with a TX DMA channel linked
+ */
+HAL_StatusTypeDef Log_Init(UART_HandleTypeDef *huart)
+{
+    if (huart == NULL || huart->hdmatx == NULL) {
+        return HAL_ERROR;
+    }
+
+    memset(log_ring, 0, sizeof(log_ring));
+    memset(&log_stats, 0, sizeof(log_stats));
+    log_head = 0;
+    log_tail = 0;
+    log_tx_busy = 0;
+    log_uart = huart;
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Queue raw bytes for transmission without waiting
+ * @return Bytes accepted; less than len if the ring filled up
+ */
+uint32_t Log_Write(const char *data, uint32_t len)
+{
+    uint32_t written = 0;
+
+    while (written < len) {
+        uint32_t chunk = len - written;
+
+        if (chunk > LOG_MAX_RECORD) {
+            chunk = LOG_MAX_RECORD;
+        }
+
+        if (!ring_put((const uint8_t *)&data[written], chunk)) {
+            break;
+        }
+
+        written += chunk;
+    }
+
+    log_kick();
+
+    return written;
+}
+
+/**
+ * @brief Queue a binary frame as a single record
+ * @return false if len exceeds LOG_MAX_RECORD or the ring is full
+ * @note Records are sent whole and in order, so other writers can never
+ *       split the frame the way they can split a long Log_Write
+ */
+bool Log_WriteFrame(const uint8_t *frame, uint32_t len)
+{
+    bool queued;
+
+    if (len == 0 || len > LOG_MAX_RECORD) {
+        return false;
+    }
+
+    queued = ring_put(frame, len);
+    log_kick();
+
+    return queued;
+}
+
+/**
+ * @brief printf-style log line, formatted on the caller's stack
+ * @note Output longer than LOG_MAX_LINE - 1 characters is truncated
+ */
+int Log_VPrintf(const char *format, va_list args)
+{
+    char line[LOG_MAX_LINE];
+    int len = vsnprintf(line, sizeof(line), format, args);
+
+    if (len < 0) {
+        return len;
+    }
+
+    if (len >= (int)sizeof(line)) {
+        len = (int)sizeof(line) - 1;
+    }
+
+    return (int)Log_Write(line, (uint32_t)len);
+}
+
+int Log_Printf(const char *format, ...)
+{
+    va_list args;
+    int len;
+
+    va_start(args, format);
+    len = Log_VPrintf(format, args);
+    va_end(args);
+
+    return len;
+}
+
+/**
+ * @brief Log a format ID with integer arguments
+ * @note With LOG_DEFERRED_FORMAT the record is a binary frame
+ *       {LOG_FRAME_MARKER, id, n_args, args as little-endian uint32};
+ *       otherwise it is formatted here like Log_Printf
+ */
+void Log_Deferred(Log_FormatId_t id, uint8_t n_args, const uint32_t *args)
+{
+    if (id >= LOG_NUM_FORMATS || n_args > LOG_MAX_ARGS) {
+        return;
+    }
+
+#if LOG_DEFERRED_FORMAT
+    uint8_t frame[3 + 4 * LOG_MAX_ARGS];
+
+    frame[0] = LOG_FRAME_MARKER;
+    frame[1] = (uint8_t)id;
+    frame[2] = n_args;
+    memcpy(&frame[3], args, 4U * n_args);  // Cortex-M is little-endian
+
+    ring_put(frame, 3U + 4U * n_args);
+    log_kick();
+#else
+    unsigned long a[LOG_MAX_ARGS] = {0};
+
+    for (uint8_t i = 0; i < n_args; i++) {
+        a[i] = args[i];
+    }
+
+    // Unused trailing arguments are ignored by the format
+    Log_Printf(log_formats[id], a[0], a[1], a[2], a[3], a[4], a[5]);
+#endif
+}
+
+/**
+ * @brief Continue draining after a DMA transfer finished
+ * @note Call from HAL_UART_TxCpltCallback, and from HAL_UART_ErrorCallback
+ *       only when the error aborted the TX DMA
+ */
+void Log_TxComplete(void)
+{
+    __atomic_store_n(&log_tx_busy, 0U, __ATOMIC_RELEASE);
+    log_kick();
+}
+
+/**
+ * @brief Send everything still queued by polling the UART
+ * @note For fatal paths with interrupts disabled; aborts any DMA transfer
+ */
+void Log_FlushBlocking(void)
+{
+    uint8_t chunk[LOG_TX_CHUNK];
+    uint32_t n;
+
+    if (log_uart == NULL) {
+        return;
+    }
+
+    HAL_UART_AbortTransmit(log_uart);
+    log_tx_busy = 1U;  // Keep writers from starting DMA again
+
+    while ((n = ring_take(chunk, sizeof(chunk))) != 0) {
+        HAL_UART_Transmit(log_uart, chunk, (uint16_t)n, 100);
+    }
+}
+
+/**
+ * @brief Snapshot of the log counters
+ */
+void Log_GetStats(Log_Stats_t *stats)
+{
+    *stats = log_stats;
+}
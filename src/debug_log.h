@@ -0,0 +1,86 @@
+/**
+ * @file debug_log.h
+ * @brief Non-blocking debug log drained by UART TX DMA
+ */
+
+#ifndef DEBUG_LOG_H
+#define DEBUG_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include "stm32h7xx_hal.h"
+
+/* Build configuration -------------------------------------------------------*/
+// LOG_DEFERRED records: 0 = formatted to text by the caller,
+// 1 = sent as binary frames (format ID + args), decoded on the host by
+//     src/utils/decode_log.py
+#ifndef LOG_DEFERRED_FORMAT
+#define LOG_DEFERRED_FORMAT   0
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define LOG_RING_SIZE         8192    // Bytes, power of two; holds a block of EMG stream frames
+#define LOG_TX_CHUNK          256     // Bytes per DMA transfer, multiple of 32
+#define LOG_MAX_RECORD        LOG_TX_CHUNK
+#define LOG_MAX_LINE          160     // Log_Printf line buffer (caller's stack)
+#define LOG_MAX_ARGS          6       // Arguments of a deferred record
+#define LOG_FRAME_MARKER      0x1EU   // Starts a binary frame; never in text
+
+// Deferred format strings. Arguments travel as uint32_t, so use %lu, %ld
+// or %lx. The order defines the IDs and must match the firmware build the
+// host decoder reads this file from.
+#define LOG_FORMAT_TABLE(X) \
+    X(LOG_FMT_GESTURE, "Gesture: %lu, Confidence: %lu%%, Trees: %lu, Time: %luus\r\n")
+
+/* Exported types ------------------------------------------------------------*/
+#define LOG_FORMAT_ENUM(id, fmt)  id,
+typedef enum {
+    LOG_FORMAT_TABLE(LOG_FORMAT_ENUM)
+    LOG_NUM_FORMATS
+} Log_FormatId_t;
+#undef LOG_FORMAT_ENUM
+
+// Diagnostics
+typedef struct {
+    uint32_t bytes_written;   // Accepted into the ring
+    uint32_t bytes_sent;      // Handed to the DMA
+    uint32_t records_dropped; // Ring full; the writer does not wait
+    uint32_t bytes_dropped;   // Taken from the ring but refused by the DMA
+} Log_Stats_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+/*
+ * Writers may be any task or interrupt: space is reserved with a
+ * compare-and-swap, so no writer ever blocks or takes a lock. When the
+ * ring is full the record is dropped and counted. The ring is drained into
+ * a DMA transfer by whichever context finds the transmitter idle, and
+ * again from the TX-complete interrupt.
+ */
+HAL_StatusTypeDef Log_Init(UART_HandleTypeDef *huart);
+uint32_t Log_Write(const char *data, uint32_t len);        // Returns bytes accepted
+bool Log_WriteFrame(const uint8_t *frame, uint32_t len);   // One record, all or nothing
+int Log_Printf(const char *format, ...);
+int Log_VPrintf(const char *format, va_list args);
+void Log_Deferred(Log_FormatId_t id, uint8_t n_args, const uint32_t *args);
+void Log_TxComplete(void);                                 // From HAL_UART_TxCpltCallback
+void Log_FlushBlocking(void);                              // Fatal paths only, polls the UART
+void Log_GetStats(Log_Stats_t *stats);
+
+/* Exported macro ------------------------------------------------------------*/
+// Deferred log call with integer arguments, e.g.
+//   LOG_DEFERRED(LOG_FMT_GESTURE, gesture, confidence, trees, time_us);
+#define LOG_DEFERRED(id, ...) \
+    Log_Deferred((id), (uint8_t)(sizeof((uint32_t[]){ __VA_ARGS__ }) / sizeof(uint32_t)), \
+                 (const uint32_t[]){ __VA_ARGS__ })
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEBUG_LOG_H */
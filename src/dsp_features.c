@@ -0,0 +1,73 @@
+/**
+ * @file dsp_features.c
+ * @brief Feature subset selection and feature vector post-processing
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "dsp_pipeline.h"
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Select the features the deployed model reads
+ * @param mask Model feature mask (RF_GET_MODEL_INFO), NULL for all features
+ * @note Forces a td_acc resync on the next DSP_PushSample, so channels that
+ *       were skipped before start from exact sums
+ */
+void DSP_SetFeatureMask(DSP_Context_t *ctx, const Feature_Mask_t *mask)
+{
+    Feature_Mask_t all;
+
+    if (mask == NULL) {
+        Feature_Mask_SetAll(&all, EMG_MAX_FEATURES);
+        mask = &all;
+    }
+
+    for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+        ctx->td_skip[ch] = 0;
+
+        for (uint8_t k = 0; k < DSP_TD_PER_CHANNEL; k++) {
+            if (!Feature_Mask_Test(mask, DSP_FEATURE_TD(ch, k))) {
+                ctx->td_skip[ch] |= (uint8_t)(1U << k);
+            }
+        }
+    }
+
+    ctx->spectrum_skip = true;
+    for (uint8_t i = DSP_TD_FEATURES; i < EMG_MAX_FEATURES; i++) {
+        if (Feature_Mask_Test(mask, i)) {
+            ctx->spectrum_skip = false;
+            break;
+        }
+    }
+
+    ctx->td_resync_count = DSP_TD_RESYNC_INTERVAL - 1U;
+}
+
+/**
+ * @brief Quantize features to int16 with per-feature folded scales
+ * @param scale Model feature_qscale; the exporter folded normalization into
+ *              the thresholds, so no offset or Q8.8 step is needed here
+ */
+void DSP_QuantizeFeatures(const Feature_Vector_t *features, const float *scale,
+                          Feature_VectorQ_t *quantized)
+{
+    for (uint8_t i = 0; i < features->n_features; i++) {
+        float q = features->values[i] * scale[i];
+
+        // Saturate; ordering against in-range thresholds is preserved
+        if (q >= 32767.0f) {
+            quantized->values[i] = INT16_MAX;
+        } else if (q <= -32768.0f) {
+            quantized->values[i] = INT16_MIN;
+        } else {
+            // floor, matching the exporter's threshold rounding
+            int32_t v = (int32_t)q;
+            quantized->values[i] = (int16_t)((q < (float)v) ? v - 1 : v);
+        }
+    }
+
+    quantized->n_features = features->n_features;
+    quantized->timestamp = features->timestamp;
+}
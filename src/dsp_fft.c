@@ -0,0 +1,130 @@
+/**
+ * @file dsp_fft.c
+ * @brief Reference real-input FFT over the full analysis window
+ *
+ * The N real samples are read as N/2 complex values z[n] = x[2n] + j x[2n+1],
+ * transformed with an N/2-point radix-2 FFT, and split into the N/2 + 1
+ * non-redundant bins of the real spectrum:
+ *
+ *   X[k]     = E + W_N^k O
+ *   X[N/2-k] = conj(E - W_N^k O)
+ *   E = (Z[k] + conj(Z[N/2-k])) / 2,  O = (Z[k] - conj(Z[N/2-k])) / 2j
+ *
+ * Output uses the CMSIS arm_rfft_fast_f32 packing ([0] = DC, [1] = Nyquist,
+ * then re/im of bins 1 .. N/2-1), so both backends feed the same magnitude
+ * and feature code. Twiddles, bit reversal and the Hamming window are
+ * const tables (dsp_fft_tables.c); nothing is computed at init.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include "stm32h7xx_hal.h"
+#include "dsp_pipeline.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define FFT_HALF                (DSP_FFT_SIZE / 2)   // Complex points
+
+#if (DSP_FFT_SIZE & (DSP_FFT_SIZE - 1)) || DSP_FFT_SIZE < 8
+#error "DSP_FFT_SIZE must be a power of two >= 8"
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Real-input forward FFT
+ * @param input  DSP_FFT_SIZE real samples (not modified)
+ * @param output DSP_FFT_SIZE floats: [0] = DC, [1] = Nyquist, then re/im pairs
+ * @param size   Must be DSP_FFT_SIZE; the tables fix the length
+ */
+void DSP_ComputeRealFFT(const float *input, float *output, uint16_t size)
+{
+    (void)size;
+
+    // Bit-reversed load fused with the first radix-2 stage (twiddle 1)
+    for (uint16_t i = 0; i < FFT_HALF; i += 2) {
+        const float *a = &input[2U * dsp_fft_bitrev[i]];
+        const float *b = &input[2U * dsp_fft_bitrev[i + 1U]];
+
+        output[2U * i]      = a[0] + b[0];
+        output[2U * i + 1U] = a[1] + b[1];
+        output[2U * i + 2U] = a[0] - b[0];
+        output[2U * i + 3U] = a[1] - b[1];
+    }
+
+    // Remaining stages; W_{N/2}^m = W_N^{2m}, so stage `len` steps the
+    // table by DSP_FFT_SIZE / len
+    for (uint16_t len = 4; len <= FFT_HALF; len <<= 1) {
+        const uint16_t half = len >> 1;
+        const uint16_t step = DSP_FFT_SIZE / len;
+
+        for (uint16_t base = 0; base < FFT_HALF; base += len) {
+            for (uint16_t k = 0; k < half; k++) {
+                const float wr = dsp_twiddle[2U * k * step];
+                const float wi = dsp_twiddle[2U * k * step + 1U];
+                float *a = &output[2U * (base + k)];
+                float *b = &output[2U * (base + k + half)];
+                const float tr = wr * b[0] - wi * b[1];
+                const float ti = wr * b[1] + wi * b[0];
+
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+
+    // Split into the real spectrum, bins k and N/2-k together, in place
+    {
+        const float z0r = output[0];
+        const float z0i = output[1];
+
+        output[0] = z0r + z0i;   // DC
+        output[1] = z0r - z0i;   // Nyquist
+    }
+
+    for (uint16_t k = 1; k <= FFT_HALF / 2; k++) {
+        float *a = &output[2U * k];
+        float *b = &output[2U * (FFT_HALF - k)];
+        const float wr = dsp_twiddle[2U * k];
+        const float wi = dsp_twiddle[2U * k + 1U];
+        const float e_re = 0.5f * (a[0] + b[0]);
+        const float e_im = 0.5f * (a[1] - b[1]);
+        const float o_re = 0.5f * (a[1] + b[1]);
+        const float o_im = 0.5f * (b[0] - a[0]);
+        const float t_re = wr * o_re - wi * o_im;
+        const float t_im = wr * o_im + wi * o_re;
+
+        a[0] = e_re + t_re;
+        a[1] = e_im + t_im;
+        b[0] = e_re - t_re;
+        b[1] = t_im - e_im;
+    }
+}
+
+/**
+ * @brief Magnitude of a packed real spectrum
+ * @param size FFT length; `size/2` magnitudes are written (Nyquist dropped,
+ *             as in DSP_CMSIS_ComputeMagnitudeSpectrum)
+ */
+void DSP_ComputeRealMagnitude(const float *packed_spectrum, float *magnitude, uint16_t size)
+{
+    magnitude[0] = fabsf(packed_spectrum[0]);
+
+    for (uint16_t k = 1; k < size / 2; k++) {
+        const float re = packed_spectrum[2U * k];
+        const float im = packed_spectrum[2U * k + 1U];
+
+        magnitude[k] = sqrtf(re * re + im * im);
+    }
+}
+
+/**
+ * @brief Element-wise window multiply (reference DSP_KERNEL_WINDOW)
+ */
+void DSP_ApplyWindow(const float *data, const float *window, float *output, uint16_t size)
+{
+    for (uint16_t i = 0; i < size; i++) {
+        output[i] = data[i] * window[i];
+    }
+}
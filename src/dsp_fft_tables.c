@@ -0,0 +1,163 @@
+/**
+ * @file dsp_fft_tables.c
+ * @brief Twiddle, bit-reversal and Hamming tables for the real FFT
+ *
+ * Generated by src/utils/gen_dsp_tables.py - do not edit.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "dsp_pipeline.h"
+
+#if DSP_FFT_SIZE != 256
+#error "DSP_FFT_SIZE changed; regenerate with src/utils/gen_dsp_tables.py"
+#endif
+
+/* Exported variables --------------------------------------------------------*/
+// W_N^k = cos(2 pi k / N) - j sin(2 pi k / N), k = 0 .. N/2-1, {re, im} pairs
+DTCM_RODATA const float dsp_twiddle[DSP_FFT_SIZE] = {
+     1.000000000e+00f, -0.000000000e+00f,  9.996988187e-01f, -2.454122852e-02f,
+     9.987954562e-01f, -4.906767433e-02f,  9.972904567e-01f, -7.356456360e-02f,
+     9.951847267e-01f, -9.801714033e-02f,  9.924795346e-01f, -1.224106752e-01f,
+     9.891765100e-01f, -1.467304745e-01f,  9.852776424e-01f, -1.709618888e-01f,
+     9.807852804e-01f, -1.950903220e-01f,  9.757021300e-01f, -2.191012402e-01f,
+     9.700312532e-01f, -2.429801799e-01f,  9.637760658e-01f, -2.667127575e-01f,
+     9.569403357e-01f, -2.902846773e-01f,  9.495281806e-01f, -3.136817404e-01f,
+     9.415440652e-01f, -3.368898534e-01f,  9.329927988e-01f, -3.598950365e-01f,
+     9.238795325e-01f, -3.826834324e-01f,  9.142097557e-01f, -4.052413140e-01f,
+     9.039892931e-01f, -4.275550934e-01f,  8.932243012e-01f, -4.496113297e-01f,
+     8.819212643e-01f, -4.713967368e-01f,  8.700869911e-01f, -4.928981922e-01f,
+     8.577286100e-01f, -5.141027442e-01f,  8.448535652e-01f, -5.349976199e-01f,
+     8.314696123e-01f, -5.555702330e-01f,  8.175848132e-01f, -5.758081914e-01f,
+     8.032075315e-01f, -5.956993045e-01f,  7.883464276e-01f, -6.152315906e-01f,
+     7.730104534e-01f, -6.343932842e-01f,  7.572088465e-01f, -6.531728430e-01f,
+     7.409511254e-01f, -6.715589548e-01f,  7.242470830e-01f, -6.895405447e-01f,
+     7.071067812e-01f, -7.071067812e-01f,  6.895405447e-01f, -7.242470830e-01f,
+     6.715589548e-01f, -7.409511254e-01f,  6.531728430e-01f, -7.572088465e-01f,
+     6.343932842e-01f, -7.730104534e-01f,  6.152315906e-01f, -7.883464276e-01f,
+     5.956993045e-01f, -8.032075315e-01f,  5.758081914e-01f, -8.175848132e-01f,
+     5.555702330e-01f, -8.314696123e-01f,  5.349976199e-01f, -8.448535652e-01f,
+     5.141027442e-01f, -8.577286100e-01f,  4.928981922e-01f, -8.700869911e-01f,
+     4.713967368e-01f, -8.819212643e-01f,  4.496113297e-01f, -8.932243012e-01f,
+     4.275550934e-01f, -9.039892931e-01f,  4.052413140e-01f, -9.142097557e-01f,
+     3.826834324e-01f, -9.238795325e-01f,  3.598950365e-01f, -9.329927988e-01f,
+     3.368898534e-01f, -9.415440652e-01f,  3.136817404e-01f, -9.495281806e-01f,
+     2.902846773e-01f, -9.569403357e-01f,  2.667127575e-01f, -9.637760658e-01f,
+     2.429801799e-01f, -9.700312532e-01f,  2.191012402e-01f, -9.757021300e-01f,
+     1.950903220e-01f, -9.807852804e-01f,  1.709618888e-01f, -9.852776424e-01f,
+     1.467304745e-01f, -9.891765100e-01f,  1.224106752e-01f, -9.924795346e-01f,
+     9.801714033e-02f, -9.951847267e-01f,  7.356456360e-02f, -9.972904567e-01f,
+     4.906767433e-02f, -9.987954562e-01f,  2.454122852e-02f, -9.996988187e-01f,
+     6.123233996e-17f, -1.000000000e+00f, -2.454122852e-02f, -9.996988187e-01f,
+    -4.906767433e-02f, -9.987954562e-01f, -7.356456360e-02f, -9.972904567e-01f,
+    -9.801714033e-02f, -9.951847267e-01f, -1.224106752e-01f, -9.924795346e-01f,
+    -1.467304745e-01f, -9.891765100e-01f, -1.709618888e-01f, -9.852776424e-01f,
+    -1.950903220e-01f, -9.807852804e-01f, -2.191012402e-01f, -9.757021300e-01f,
+    -2.429801799e-01f, -9.700312532e-01f, -2.667127575e-01f, -9.637760658e-01f,
+    -2.902846773e-01f, -9.569403357e-01f, -3.136817404e-01f, -9.495281806e-01f,
+    -3.368898534e-01f, -9.415440652e-01f, -3.598950365e-01f, -9.329927988e-01f,
+    -3.826834324e-01f, -9.238795325e-01f, -4.052413140e-01f, -9.142097557e-01f,
+    -4.275550934e-01f, -9.039892931e-01f, -4.496113297e-01f, -8.932243012e-01f,
+    -4.713967368e-01f, -8.819212643e-01f, -4.928981922e-01f, -8.700869911e-01f,
+    -5.141027442e-01f, -8.577286100e-01f, -5.349976199e-01f, -8.448535652e-01f,
+    -5.555702330e-01f, -8.314696123e-01f, -5.758081914e-01f, -8.175848132e-01f,
+    -5.956993045e-01f, -8.032075315e-01f, -6.152315906e-01f, -7.883464276e-01f,
+    -6.343932842e-01f, -7.730104534e-01f, -6.531728430e-01f, -7.572088465e-01f,
+    -6.715589548e-01f, -7.409511254e-01f, -6.895405447e-01f, -7.242470830e-01f,
+    -7.071067812e-01f, -7.071067812e-01f, -7.242470830e-01f, -6.895405447e-01f,
+    -7.409511254e-01f, -6.715589548e-01f, -7.572088465e-01f, -6.531728430e-01f,
+    -7.730104534e-01f, -6.343932842e-01f, -7.883464276e-01f, -6.152315906e-01f,
+    -8.032075315e-01f, -5.956993045e-01f, -8.175848132e-01f, -5.758081914e-01f,
+    -8.314696123e-01f, -5.555702330e-01f, -8.448535652e-01f, -5.349976199e-01f,
+    -8.577286100e-01f, -5.141027442e-01f, -8.700869911e-01f, -4.928981922e-01f,
+    -8.819212643e-01f, -4.713967368e-01f, -8.932243012e-01f, -4.496113297e-01f,
+    -9.039892931e-01f, -4.275550934e-01f, -9.142097557e-01f, -4.052413140e-01f,
+    -9.238795325e-01f, -3.826834324e-01f, -9.329927988e-01f, -3.598950365e-01f,
+    -9.415440652e-01f, -3.368898534e-01f, -9.495281806e-01f, -3.136817404e-01f,
+    -9.569403357e-01f, -2.902846773e-01f, -9.637760658e-01f, -2.667127575e-01f,
+    -9.700312532e-01f, -2.429801799e-01f, -9.757021300e-01f, -2.191012402e-01f,
+    -9.807852804e-01f, -1.950903220e-01f, -9.852776424e-01f, -1.709618888e-01f,
+    -9.891765100e-01f, -1.467304745e-01f, -9.924795346e-01f, -1.224106752e-01f,
+    -9.951847267e-01f, -9.801714033e-02f, -9.972904567e-01f, -7.356456360e-02f,
+    -9.987954562e-01f, -4.906767433e-02f, -9.996988187e-01f, -2.454122852e-02f,
+};
+
+// Bit-reversed order of the N/2-point complex FFT
+DTCM_RODATA const uint8_t dsp_fft_bitrev[DSP_FFT_SIZE / 2] = {
+      0,  64,  32,  96,  16,  80,  48, 112,   8,  72,  40, 104,  24,  88,  56, 120,
+      4,  68,  36, 100,  20,  84,  52, 116,  12,  76,  44, 108,  28,  92,  60, 124,
+      2,  66,  34,  98,  18,  82,  50, 114,  10,  74,  42, 106,  26,  90,  58, 122,
+      6,  70,  38, 102,  22,  86,  54, 118,  14,  78,  46, 110,  30,  94,  62, 126,
+      1,  65,  33,  97,  17,  81,  49, 113,   9,  73,  41, 105,  25,  89,  57, 121,
+      5,  69,  37, 101,  21,  85,  53, 117,  13,  77,  45, 109,  29,  93,  61, 125,
+      3,  67,  35,  99,  19,  83,  51, 115,  11,  75,  43, 107,  27,  91,  59, 123,
+      7,  71,  39, 103,  23,  87,  55, 119,  15,  79,  47, 111,  31,  95,  63, 127,
+};
+
+// Symmetric Hamming window, 0.54 - 0.46 cos(2 pi n / (N - 1))
+DTCM_RODATA const float dsp_hamming_window[DSP_FFT_SIZE] = {
+     8.000000000e-02f,  8.013963209e-02f,  8.055844359e-02f,  8.125618024e-02f,
+     8.223241845e-02f,  8.348656555e-02f,  8.501786015e-02f,  8.682537260e-02f,
+     8.890800558e-02f,  9.126449473e-02f,  9.389340942e-02f,  9.679315367e-02f,
+     9.996196703e-02f,  1.033979257e-01f,  1.070989438e-01f,  1.110627745e-01f,
+     1.152870112e-01f,  1.197690895e-01f,  1.245062883e-01f,  1.294957317e-01f,
+     1.347343906e-01f,  1.402190847e-01f,  1.459464842e-01f,  1.519131120e-01f,
+     1.581153458e-01f,  1.645494203e-01f,  1.712114294e-01f,  1.780973285e-01f,
+     1.852029373e-01f,  1.925239420e-01f,  2.000558981e-01f,  2.077942328e-01f,
+     2.157342484e-01f,  2.238711245e-01f,  2.321999211e-01f,  2.407155819e-01f,
+     2.494129371e-01f,  2.582867066e-01f,  2.673315031e-01f,  2.765418356e-01f,
+     2.859121124e-01f,  2.954366451e-01f,  3.051096511e-01f,  3.149252582e-01f,
+     3.248775073e-01f,  3.349603563e-01f,  3.451676842e-01f,  3.554932939e-01f,
+     3.659309170e-01f,  3.764742167e-01f,  3.871167922e-01f,  3.978521826e-01f,
+     4.086738703e-01f,  4.195752856e-01f,  4.305498103e-01f,  4.415907817e-01f,
+     4.526914970e-01f,  4.638452170e-01f,  4.750451702e-01f,  4.862845572e-01f,
+     4.975565546e-01f,  5.088543194e-01f,  5.201709925e-01f,  5.314997037e-01f,
+     5.428335755e-01f,  5.541657269e-01f,  5.654892785e-01f,  5.767973555e-01f,
+     5.880830931e-01f,  5.993396396e-01f,  6.105601612e-01f,  6.217378461e-01f,
+     6.328659082e-01f,  6.439375918e-01f,  6.549461753e-01f,  6.658849754e-01f,
+     6.767473513e-01f,  6.875267084e-01f,  6.982165026e-01f,  7.088102442e-01f,
+     7.193015017e-01f,  7.296839060e-01f,  7.399511540e-01f,  7.500970124e-01f,
+     7.601153218e-01f,  7.700000000e-01f,  7.797450461e-01f,  7.893445440e-01f,
+     7.987926657e-01f,  8.080836755e-01f,  8.172119327e-01f,  8.261718957e-01f,
+     8.349581248e-01f,  8.435652860e-01f,  8.519881540e-01f,  8.602216151e-01f,
+     8.682606710e-01f,  8.761004412e-01f,  8.837361660e-01f,  8.911632101e-01f,
+     8.983770643e-01f,  9.053733492e-01f,  9.121478174e-01f,  9.186963562e-01f,
+     9.250149898e-01f,  9.310998824e-01f,  9.369473398e-01f,  9.425538121e-01f,
+     9.479158955e-01f,  9.530303348e-01f,  9.578940250e-01f,  9.625040134e-01f,
+     9.668575013e-01f,  9.709518457e-01f,  9.747845610e-01f,  9.783533202e-01f,
+     9.816559569e-01f,  9.846904660e-01f,  9.874550052e-01f,  9.899478963e-01f,
+     9.921676259e-01f,  9.941128462e-01f,  9.957823764e-01f,  9.971752030e-01f,
+     9.982904803e-01f,  9.991275312e-01f,  9.996858477e-01f,  9.999650907e-01f,
+     9.999650907e-01f,  9.996858477e-01f,  9.991275312e-01f,  9.982904803e-01f,
+     9.971752030e-01f,  9.957823764e-01f,  9.941128462e-01f,  9.921676259e-01f,
+     9.899478963e-01f,  9.874550052e-01f,  9.846904660e-01f,  9.816559569e-01f,
+     9.783533202e-01f,  9.747845610e-01f,  9.709518457e-01f,  9.668575013e-01f,
+     9.625040134e-01f,  9.578940250e-01f,  9.530303348e-01f,  9.479158955e-01f,
+     9.425538121e-01f,  9.369473398e-01f,  9.310998824e-01f,  9.250149898e-01f,
+     9.186963562e-01f,  9.121478174e-01f,  9.053733492e-01f,  8.983770643e-01f,
+     8.911632101e-01f,  8.837361660e-01f,  8.761004412e-01f,  8.682606710e-01f,
+     8.602216151e-01f,  8.519881540e-01f,  8.435652860e-01f,  8.349581248e-01f,
+     8.261718957e-01f,  8.172119327e-01f,  8.080836755e-01f,  7.987926657e-01f,
+     7.893445440e-01f,  7.797450461e-01f,  7.700000000e-01f,  7.601153218e-01f,
+     7.500970124e-01f,  7.399511540e-01f,  7.296839060e-01f,  7.193015017e-01f,
+     7.088102442e-01f,  6.982165026e-01f,  6.875267084e-01f,  6.767473513e-01f,
+     6.658849754e-01f,  6.549461753e-01f,  6.439375918e-01f,  6.328659082e-01f,
+     6.217378461e-01f,  6.105601612e-01f,  5.993396396e-01f,  5.880830931e-01f,
+     5.767973555e-01f,  5.654892785e-01f,  5.541657269e-01f,  5.428335755e-01f,
+     5.314997037e-01f,  5.201709925e-01f,  5.088543194e-01f,  4.975565546e-01f,
+     4.862845572e-01f,  4.750451702e-01f,  4.638452170e-01f,  4.526914970e-01f,
+     4.415907817e-01f,  4.305498103e-01f,  4.195752856e-01f,  4.086738703e-01f,
+     3.978521826e-01f,  3.871167922e-01f,  3.764742167e-01f,  3.659309170e-01f,
+     3.554932939e-01f,  3.451676842e-01f,  3.349603563e-01f,  3.248775073e-01f,
+     3.149252582e-01f,  3.051096511e-01f,  2.954366451e-01f,  2.859121124e-01f,
+     2.765418356e-01f,  2.673315031e-01f,  2.582867066e-01f,  2.494129371e-01f,
+     2.407155819e-01f,  2.321999211e-01f,  2.238711245e-01f,  2.157342484e-01f,
+     2.077942328e-01f,  2.000558981e-01f,  1.925239420e-01f,  1.852029373e-01f,
+     1.780973285e-01f,  1.712114294e-01f,  1.645494203e-01f,  1.581153458e-01f,
+     1.519131120e-01f,  1.459464842e-01f,  1.402190847e-01f,  1.347343906e-01f,
+     1.294957317e-01f,  1.245062883e-01f,  1.197690895e-01f,  1.152870112e-01f,
+     1.110627745e-01f,  1.070989438e-01f,  1.033979257e-01f,  9.996196703e-02f,
+     9.679315367e-02f,  9.389340942e-02f,  9.126449473e-02f,  8.890800558e-02f,
+     8.682537260e-02f,  8.501786015e-02f,  8.348656555e-02f,  8.223241845e-02f,
+     8.125618024e-02f,  8.055844359e-02f,  8.013963209e-02f,  8.000000000e-02f,
+};
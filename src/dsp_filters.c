@@ -0,0 +1,185 @@
+/**
+ * @file dsp_filters.c
+ * @brief Fused multi-channel preprocessing filters and streaming stage
+ *
+ * High-pass and notch sections are evaluated for all channels per sample,
+ * so the interleaved input is read once and each channel's filter state
+ * stays in registers for the whole block. The biquads use Direct Form II
+ * transposed with the same state layout as arm_biquad_cascade_df2T_f32, so
+ * the reference and CMSIS-DSP backends can share hp_filter_state and
+ * notch_filter_state. The single-channel in-place filters are the
+ * reference DSP_KERNEL_HIGHPASS / DSP_KERNEL_NOTCH.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "dsp_pipeline.h"
+
+/* Exported variables --------------------------------------------------------*/
+// 20 Hz Butterworth high-pass; 50 Hz notch with the same -3 dB bandwidth
+// (about 1.6 Hz) at every rate
+#if EMG_SAMPLE_RATE_HZ == 4000U
+const float dsp_hp_coeffs[5] = {
+    0.978030479f, -1.956060958f, 0.978030479f, 1.955578240f, -0.956543677f
+};
+
+const float dsp_notch_coeffs[10] = {
+    0.998714095f, -1.991270786f, 0.998714095f, 1.991270786f, -0.997428191f,
+    0.998714095f, -1.991270786f, 0.998714095f, 1.991270786f, -0.997428191f
+};
+#elif EMG_SAMPLE_RATE_HZ == 2000U
+const float dsp_hp_coeffs[5] = {
+    0.956543226f, -1.913086451f, 0.956543226f, 1.911197067f, -0.914975835f
+};
+
+const float dsp_notch_coeffs[10] = {
+    0.997431490f, -1.970302906f, 0.997431490f, 1.970302906f, -0.994862979f,
+    0.997431490f, -1.970302906f, 0.997431490f, 1.970302906f, -0.994862979f
+};
+#else
+const float dsp_hp_coeffs[5] = {
+    0.914969144f, -1.829938288f, 0.914969144f, 1.822694925f, -0.837181651f
+};
+
+const float dsp_notch_coeffs[10] = {
+    0.994876106f, -1.892366808f, 0.994876106f, 1.892366808f, -0.989752213f,
+    0.994876106f, -1.892366808f, 0.994876106f, 1.892366808f, -0.989752213f
+};
+#endif
+
+/* Private functions ---------------------------------------------------------*/
+static inline float biquad_df2t(const float *c, float *s, float x)
+{
+    float y = c[0] * x + s[0];
+
+    s[0] = c[1] * x + c[3] * y + s[1];
+    s[1] = c[2] * x + c[4] * y;
+
+    return y;
+}
+
+static inline float filter_sample(float hp[2], float notch[4], float x)
+{
+    float y = biquad_df2t(dsp_hp_coeffs, hp, x);
+    y = biquad_df2t(&dsp_notch_coeffs[0], &notch[0], y);
+    return biquad_df2t(&dsp_notch_coeffs[5], &notch[2], y);
+}
+
+static inline void load_state(const DSP_Context_t *ctx, float hp[EMG_NUM_CHANNELS][2],
+                              float notch[EMG_NUM_CHANNELS][4])
+{
+    for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+        hp[ch][0] = ctx->hp_filter_state[ch][0];
+        hp[ch][1] = ctx->hp_filter_state[ch][1];
+        for (uint8_t k = 0; k < 4; k++) {
+            notch[ch][k] = ctx->notch_filter_state[ch][k];
+        }
+    }
+}
+
+static inline void store_state(DSP_Context_t *ctx, const float hp[EMG_NUM_CHANNELS][2],
+                               const float notch[EMG_NUM_CHANNELS][4])
+{
+    for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+        ctx->hp_filter_state[ch][0] = hp[ch][0];
+        ctx->hp_filter_state[ch][1] = hp[ch][1];
+        for (uint8_t k = 0; k < 4; k++) {
+            ctx->notch_filter_state[ch][k] = notch[ch][k];
+        }
+    }
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief High-pass filter one channel in place, state in hp_filter_state[channel]
+ */
+void DSP_ApplyHighPassFilter(DSP_Context_t *ctx, float *data, uint8_t channel, uint16_t length)
+{
+    float *state = ctx->hp_filter_state[channel];
+
+    for (uint16_t i = 0; i < length; i++) {
+        data[i] = biquad_df2t(dsp_hp_coeffs, state, data[i]);
+    }
+}
+
+/**
+ * @brief Both 50 Hz notch sections over one channel in place
+ */
+void DSP_ApplyNotchFilter(DSP_Context_t *ctx, float *data, uint8_t channel, uint16_t length)
+{
+    float *state = ctx->notch_filter_state[channel];
+
+    for (uint16_t i = 0; i < length; i++) {
+        const float y = biquad_df2t(&dsp_notch_coeffs[0], &state[0], data[i]);
+        data[i] = biquad_df2t(&dsp_notch_coeffs[5], &state[2], y);
+    }
+}
+
+/**
+ * @brief High-pass + notch all channels in one pass, channel-major output
+ * @param input  Interleaved [length][EMG_NUM_CHANNELS] voltages
+ * @param output Channel ch written to output[ch * stride + i]
+ * @param stride Distance between channel rows in output (>= length)
+ */
+void DSP_FilterToChannelMajor(DSP_Context_t *ctx, const float input[][EMG_NUM_CHANNELS],
+                              float *output, uint16_t length, uint16_t stride)
+{
+    float hp[EMG_NUM_CHANNELS][2];
+    float notch[EMG_NUM_CHANNELS][4];
+
+    // Work on local copies so the compiler can keep state in registers
+    load_state(ctx, hp, notch);
+
+    for (uint16_t i = 0; i < length; i++) {
+        for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+            output[ch * stride + i] = filter_sample(hp[ch], notch[ch], input[i][ch]);
+        }
+    }
+
+    store_state(ctx, hp, notch);
+}
+
+/**
+ * @brief Precompute per-channel volts-per-LSB from the ADS1299 configuration
+ * @note LSB = VREF / (gain * 2^23); disabled channels get a gain of 0
+ */
+void DSP_SetChannelGains(DSP_Context_t *ctx, const EMG_Config_t *config)
+{
+    const float pga = (config->gain != 0) ? (float)config->gain : 1.0f;
+    const float lsb = ADS1299_VREF / (pga * ADS1299_FULL_SCALE_CODES);
+
+    for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+        ctx->channel_gain[ch] = (config->channels_enabled & (1U << ch)) ? lsb : 0.0f;
+    }
+}
+
+/**
+ * @brief Convert and filter one EMG buffer as it arrives
+ * @param output Interleaved [buffer->n_samples][EMG_NUM_CHANNELS] filtered volts
+ * @note Filter state carries over between buffers, so every sample is
+ *       filtered exactly once regardless of window overlap
+ */
+void DSP_PreprocessBuffer(DSP_Context_t *ctx, const EMG_Buffer_t *buffer,
+                          float output[][EMG_NUM_CHANNELS])
+{
+    float hp[EMG_NUM_CHANNELS][2];
+    float notch[EMG_NUM_CHANNELS][4];
+    float gain[EMG_NUM_CHANNELS];
+
+    load_state(ctx, hp, notch);
+
+    for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+        gain[ch] = ctx->channel_gain[ch];
+    }
+
+    for (uint16_t i = 0; i < buffer->n_samples; i++) {
+        const int32_t *raw = buffer->samples[i].data;
+
+        for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+            output[i][ch] = filter_sample(hp[ch], notch[ch], (float)raw[ch] * gain[ch]);
+        }
+    }
+
+    store_state(ctx, hp, notch);
+}
@@ -0,0 +1,259 @@
+/**
+ * @file dsp_filters_fmac.c
+ * @brief Streaming preprocessing with the 50 Hz notch on the FMAC
+ *
+ * Built when DSP_USE_FMAC is 1. The CPU converts each block to volts and
+ * high-passes it in float, as dsp_filters.c does, then writes it as q15
+ * (DSP_FMAC_FULL_SCALE_V) into channel rows. The FMAC runs each notch
+ * section over a whole row by DMA, Direct Form I with the coefficients
+ * halved and R = 1; the DSP task sleeps on a semaphore meanwhile, leaving
+ * the CPU to inference. The last two inputs and outputs of every run are
+ * preloaded before the next block, so filter state carries over exactly as
+ * in the float path.
+ *
+ * Rounding in the q15 data path adds a few uV rms at the default full
+ * scale, the same order as surface electrode noise; more at 4 kHz, where
+ * the notch poles sit closer to the unit circle. The win is CPU time for
+ * the ML task rather than block latency: compare PROF_PREPROCESS and the
+ * ML timings (SYS:PROF?) with and without DSP_USE_FMAC.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdio.h>
+#include "stm32h7xx_hal.h"
+#include "dsp_pipeline.h"
+
+#if DSP_USE_FMAC
+
+// Inside the guard: host builds of src/dsp_*.c have no FreeRTOS headers
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* Private defines -----------------------------------------------------------*/
+// FMAC local memory (256 x 16 bit): coefficients, X1 input, Y output
+#define FMAC_COEFF_BASE         0U
+#define FMAC_COEFF_SIZE         5U      // b0 b1 b2, a1 a2
+#define FMAC_INPUT_BASE         8U
+#define FMAC_INPUT_SIZE         16U     // P = 3 taps plus FIFO headroom
+#define FMAC_OUTPUT_BASE        24U
+#define FMAC_OUTPUT_SIZE        16U     // Q = 2 taps plus FIFO headroom
+#define FMAC_TIMEOUT_MS         5U      // A row of EMG_BUFFER_SAMPLES takes about 10 us
+
+#define Q15_ONE                 32768.0f
+
+/* Private variables ---------------------------------------------------------*/
+static FMAC_HandleTypeDef *fmac_handle;
+static SemaphoreHandle_t fmac_done;
+static StaticSemaphore_t fmac_done_buffer;
+static volatile bool fmac_error;
+
+// Notch sections in q15, halved for the 2^R output gain
+static int16_t notch_b[2][3];
+static int16_t notch_a[2][2];   // -a1, -a2 (FMAC adds the feedback terms)
+
+// DMA source and target rows; a section reads one and writes the other
+DMA_BUFFER static int16_t fmac_rows[EMG_NUM_CHANNELS][EMG_BUFFER_SAMPLES];
+DMA_BUFFER static int16_t fmac_scratch[EMG_BUFFER_SAMPLES];
+
+/* Private functions ---------------------------------------------------------*/
+static int16_t to_q15(float x)
+{
+    if (x >= 1.0f) {
+        return INT16_MAX;
+    }
+    if (x <= -1.0f) {
+        return INT16_MIN;
+    }
+
+    return (int16_t)(x * Q15_ONE + ((x >= 0.0f) ? 0.5f : -0.5f));
+}
+
+static inline float highpass_df2t(float s[2], float x)
+{
+    const float *c = dsp_hp_coeffs;
+    float y = c[0] * x + s[0];
+
+    s[0] = c[1] * x + c[3] * y + s[1];
+    s[1] = c[2] * x + c[4] * y;
+
+    return y;
+}
+
+// One notch section over n samples; state is updated from the row tails
+static HAL_StatusTypeDef fmac_run_section(uint8_t section, int16_t state[4],
+                                          int16_t *input, int16_t *output, uint16_t n)
+{
+    FMAC_FilterConfigTypeDef config = {0};
+    uint16_t input_size = n;
+    uint16_t output_size = n;
+
+    config.InputBaseAddress = FMAC_INPUT_BASE;
+    config.InputBufferSize = FMAC_INPUT_SIZE;
+    config.InputThreshold = FMAC_THRESHOLD_1;
+    config.CoeffBaseAddress = FMAC_COEFF_BASE;
+    config.CoeffBufferSize = FMAC_COEFF_SIZE;
+    config.OutputBaseAddress = FMAC_OUTPUT_BASE;
+    config.OutputBufferSize = FMAC_OUTPUT_SIZE;
+    config.OutputThreshold = FMAC_THRESHOLD_1;
+    config.pCoeffB = notch_b[section];
+    config.CoeffBSize = 3U;
+    config.pCoeffA = notch_a[section];
+    config.CoeffASize = 2U;
+    config.InputAccess = FMAC_BUFFER_ACCESS_DMA;
+    config.OutputAccess = FMAC_BUFFER_ACCESS_DMA;
+    config.Clip = FMAC_CLIP_ENABLED;
+    config.Filter = FMAC_FUNC_IIR_DIRECT_FORM_1;
+    config.P = 3U;
+    config.Q = 2U;
+    config.R = 1U;
+
+    if (HAL_FMAC_FilterConfig(fmac_handle, &config) != HAL_OK ||
+        HAL_FMAC_FilterPreload(fmac_handle, &state[0], 2U, &state[2], 2U) != HAL_OK) {
+        return HAL_ERROR;
+    }
+
+    // A late give from a failed run must not end this one early
+    (void)xSemaphoreTake(fmac_done, 0);
+    fmac_error = false;
+    if (HAL_FMAC_FilterStart(fmac_handle, output, &output_size) != HAL_OK) {
+        return HAL_ERROR;
+    }
+
+    if (HAL_FMAC_AppendFilterData(fmac_handle, input, &input_size) != HAL_OK ||
+        xSemaphoreTake(fmac_done, pdMS_TO_TICKS(FMAC_TIMEOUT_MS)) != pdTRUE || fmac_error) {
+        (void)HAL_FMAC_FilterStop(fmac_handle);
+        return HAL_ERROR;
+    }
+
+    if (HAL_FMAC_FilterStop(fmac_handle) != HAL_OK) {
+        return HAL_ERROR;
+    }
+
+    state[0] = input[n - 2U];
+    state[1] = input[n - 1U];
+    state[2] = output[n - 2U];
+    state[3] = output[n - 1U];
+
+    return HAL_OK;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Attach the FMAC (DMA handles linked) and clear the notch history
+ * @param hfmac Initialized FMAC with hdmaIn / hdmaOut
+ * @note  The float filter table must fit q15 once halved
+ */
+HAL_StatusTypeDef DSP_FMAC_Init(DSP_Context_t *ctx, FMAC_HandleTypeDef *hfmac)
+{
+    if (hfmac == NULL || hfmac->hdmaIn == NULL || hfmac->hdmaOut == NULL) {
+        return HAL_ERROR;
+    }
+
+    for (uint8_t s = 0; s < 2U; s++) {
+        const float *c = &dsp_notch_coeffs[s * 5U];
+
+        for (uint8_t k = 0; k < 3U; k++) {
+            notch_b[s][k] = to_q15(0.5f * c[k]);
+        }
+        notch_a[s][0] = to_q15(0.5f * c[3]);
+        notch_a[s][1] = to_q15(0.5f * c[4]);
+    }
+
+    if (fmac_done == NULL) {
+        fmac_done = xSemaphoreCreateBinaryStatic(&fmac_done_buffer);
+    }
+    if (fmac_done == NULL) {
+        return HAL_ERROR;
+    }
+
+    fmac_handle = hfmac;
+    memset(ctx->fmac_notch_state, 0, sizeof(ctx->fmac_notch_state));
+    ctx->fmac_failed = false;
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Convert and filter one EMG buffer, notch on the FMAC
+ * @param output Interleaved [buffer->n_samples][EMG_NUM_CHANNELS] filtered volts
+ * @note Blocks the caller for the FMAC runs (2 per channel)
+ */
+void DSP_FMAC_PreprocessBuffer(DSP_Context_t *ctx, const EMG_Buffer_t *buffer,
+                               float output[][EMG_NUM_CHANNELS])
+{
+    const float to_fs = 1.0f / DSP_FMAC_FULL_SCALE_V;
+    const float to_volts = DSP_FMAC_FULL_SCALE_V / Q15_ONE;
+    const uint16_t n = buffer->n_samples;
+    float hp[EMG_NUM_CHANNELS][2];
+    float gain[EMG_NUM_CHANNELS];
+
+    if (ctx->fmac_failed || n < 2U) {
+        DSP_PreprocessBuffer(ctx, buffer, output);
+        return;
+    }
+
+    for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+        hp[ch][0] = ctx->hp_filter_state[ch][0];
+        hp[ch][1] = ctx->hp_filter_state[ch][1];
+        gain[ch] = ctx->channel_gain[ch];
+    }
+
+    // Volts and high-pass in one pass, rows of q15 for the FMAC
+    for (uint16_t i = 0; i < n; i++) {
+        const int32_t *raw = buffer->samples[i].data;
+
+        for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+            fmac_rows[ch][i] = to_q15(highpass_df2t(hp[ch], (float)raw[ch] * gain[ch]) * to_fs);
+        }
+    }
+
+    // Both sections per row: row -> scratch -> row
+    for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+        if (fmac_run_section(0, ctx->fmac_notch_state[ch][0], fmac_rows[ch], fmac_scratch, n) != HAL_OK ||
+            fmac_run_section(1, ctx->fmac_notch_state[ch][1], fmac_scratch, fmac_rows[ch], n) != HAL_OK) {
+            // High-pass state is untouched, so the CPU path redoes the whole block
+            ctx->fmac_failed = true;
+            printf("WARNING: FMAC filter failed, notch back on the CPU\r\n");
+            DSP_PreprocessBuffer(ctx, buffer, output);
+            return;
+        }
+    }
+
+    for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+        ctx->hp_filter_state[ch][0] = hp[ch][0];
+        ctx->hp_filter_state[ch][1] = hp[ch][1];
+    }
+
+    for (uint16_t i = 0; i < n; i++) {
+        for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+            output[i][ch] = (float)fmac_rows[ch][i] * to_volts;
+        }
+    }
+}
+
+/**
+ * @brief Output DMA of a section finished (interrupt context)
+ */
+void DSP_FMAC_TransferComplete(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    xSemaphoreGiveFromISR(fmac_done, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief FMAC or DMA error during a section (interrupt context)
+ */
+void DSP_FMAC_TransferError(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    fmac_error = true;
+    xSemaphoreGiveFromISR(fmac_done, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+#endif /* DSP_USE_FMAC */
@@ -0,0 +1,324 @@
+/**
+ * @file dsp_pipeline.c
+ * @brief DSP context set-up and per-window feature extraction
+ *
+ * DSP_ExtractFeatures turns one [DSP_WINDOW_SIZE][EMG_NUM_CHANNELS] window
+ * into the feature vector: six time-domain features per channel, then the
+ * spectral block. Two context flags select how much work a window costs:
+ *
+ *   prefiltered    the window already holds filtered volts (streaming
+ *                  DSP_PreprocessBuffer); otherwise each channel is copied
+ *                  and run through the DSP_KERNEL_HIGHPASS / NOTCH kernels,
+ *                  continuing from the context filter state
+ *   td_incremental time-domain features come from the running sums that
+ *                  DSP_PushSample keeps (O(1) per channel); only used
+ *                  together with prefiltered, since the sums track the
+ *                  window contents and not a filtered copy
+ *
+ * The spectral block is the mean and median frequency and the band powers
+ * of every channel's Hamming-windowed spectrum, averaged over the channels,
+ * and fills the vector from DSP_TD_FEATURES up to EMG_MAX_FEATURES.
+ *
+ * The feature mask (DSP_SetFeatureMask) removes work the model never reads:
+ * unused time-domain features are not scanned, a channel with none used is
+ * not copied or filtered unless the spectrum needs it, and with no spectral
+ * feature used the window, FFT and magnitude stages do not run. Skipped
+ * features are written as 0. Without prefiltered, a channel that is not
+ * filtered keeps its old filter state.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <math.h>
+#include "stm32h7xx_hal.h"
+#include "dsp_pipeline.h"
+
+#if defined(BENCH_HOST)
+// The host benchmark times the kernels itself and has no DWT
+#define PROFILE_BEGIN(probe)   do { } while (0)
+#define PROFILE_END(probe)     do { } while (0)
+#else
+#include "profiler.h"
+#endif
+
+/* Private defines -----------------------------------------------------------*/
+#if EMG_MAX_FEATURES < DSP_TD_FEATURES
+#error "EMG_MAX_FEATURES must hold the time-domain block (6 per channel)"
+#endif
+
+#if DSP_FFT_SIZE != DSP_WINDOW_SIZE
+#error "DSP_ExtractFeatures windows the channel copy straight into the FFT"
+#endif
+
+/* Private functions ---------------------------------------------------------*/
+// Same tests as the running sums in dsp_window.c, so both paths agree
+static inline bool is_zero_crossing(float a, float b, float threshold)
+{
+    return (a * b < 0.0f) && (fabsf(a - b) >= threshold);
+}
+
+static inline bool is_slope_sign_change(float a, float b, float c)
+{
+    return (b - a) * (b - c) > 0.0f;
+}
+
+// Rescan one channel of the window; features whose skip bit is set stay 0
+static void scan_time_domain(const float *x, float zc_threshold, uint8_t skip, TimeDomainFeatures_t *td)
+{
+    memset(td, 0, sizeof(*td));
+
+    if (!(skip & (1U << DSP_TD_RMS))) {
+        td->rms = DSP_CalculateRMS(x, DSP_WINDOW_SIZE);
+    }
+    if (!(skip & (1U << DSP_TD_MAV))) {
+        td->mav = DSP_CalculateMAV(x, DSP_WINDOW_SIZE);
+    }
+    if (!(skip & (1U << DSP_TD_VAR))) {
+        td->var = DSP_CalculateVariance(x, DSP_WINDOW_SIZE);
+    }
+    if (!(skip & (1U << DSP_TD_ZC))) {
+        td->zc = DSP_CountZeroCrossings(x, DSP_WINDOW_SIZE, zc_threshold);
+    }
+    if (!(skip & (1U << DSP_TD_SSC))) {
+        td->ssc = DSP_CountSlopeSignChanges(x, DSP_WINDOW_SIZE);
+    }
+    if (!(skip & (1U << DSP_TD_WL))) {
+        td->wl = DSP_CalculateWaveformLength(x, DSP_WINDOW_SIZE);
+    }
+}
+
+static inline void store_time_domain(float *out, const TimeDomainFeatures_t *td, uint8_t skip)
+{
+    out[DSP_TD_RMS] = td->rms;
+    out[DSP_TD_MAV] = td->mav;
+    out[DSP_TD_VAR] = td->var;
+    out[DSP_TD_ZC] = (float)td->zc;
+    out[DSP_TD_SSC] = (float)td->ssc;
+    out[DSP_TD_WL] = td->wl;
+
+    // Running sums produce the whole set; unused features still read as 0
+    for (uint8_t k = 0; k < DSP_TD_PER_CHANNEL; k++) {
+        if (skip & (1U << k)) {
+            out[k] = 0.0f;
+        }
+    }
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Clear the context and set the default parameters
+ * @note Every feature selected, windows filtered and rescanned per call;
+ *       the streaming task sets prefiltered / td_incremental itself. The
+ *       spectral band edges are cleared: call DSP_InitSpectralBands next
+ */
+HAL_StatusTypeDef DSP_Init(DSP_Context_t *ctx)
+{
+    if (ctx == NULL) {
+        return HAL_ERROR;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->window_size = DSP_WINDOW_SIZE;
+    ctx->fft_size = DSP_FFT_SIZE;
+    ctx->sample_rate = DSP_SAMPLE_RATE;
+    ctx->zc_threshold = DSP_ZC_THRESHOLD;
+
+#if DSP_USE_CMSIS_DSP
+    if (DSP_CMSIS_Init(ctx) != HAL_OK) {
+        return HAL_ERROR;
+    }
+#endif
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Clear filter history and running sums, keeping the configuration
+ */
+HAL_StatusTypeDef DSP_Reset(DSP_Context_t *ctx)
+{
+    if (ctx == NULL) {
+        return HAL_ERROR;
+    }
+
+    // The CMSIS biquad instances point at these arrays
+    memset(ctx->hp_filter_state, 0, sizeof(ctx->hp_filter_state));
+    memset(ctx->notch_filter_state, 0, sizeof(ctx->notch_filter_state));
+    memset(ctx->td_acc, 0, sizeof(ctx->td_acc));
+    ctx->td_resync_count = 0;
+#if DSP_USE_FMAC
+    memset(ctx->fmac_notch_state, 0, sizeof(ctx->fmac_notch_state));
+#endif
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Feature vector of one window
+ * @param window_data DSP_WINDOW_SIZE rows, oldest first (DSP_Window_Data);
+ *                    not modified
+ * @note Uses fft_output as the channel copy until the FFT overwrites it
+ */
+HAL_StatusTypeDef DSP_ExtractFeatures(DSP_Context_t *ctx,
+                                      float window_data[][EMG_NUM_CHANNELS],
+                                      Feature_Vector_t *features)
+{
+    const bool use_acc = ctx->td_incremental && ctx->prefiltered;
+    float *x = ctx->fft_output;
+    float spectral[DSP_SPECTRAL_FEATURES] = { 0.0f };
+
+    for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+        const uint8_t skip = ctx->td_skip[ch];
+        const bool rescan = !use_acc && (skip != DSP_TD_ALL);
+        TimeDomainFeatures_t td = { 0 };
+        FrequencyDomainFeatures_t freq;
+
+        // DSP_PushSample does not track fully skipped channels
+        if (use_acc && skip != DSP_TD_ALL) {
+            DSP_GetTimeDomainFeatures(ctx, ch, &td);
+        }
+
+        // Nothing below reads the samples: no copy, filter or scan
+        if (!rescan && ctx->spectrum_skip) {
+            store_time_domain(&features->values[DSP_FEATURE_TD(ch, 0)], &td, skip);
+            continue;
+        }
+
+        for (uint16_t i = 0; i < DSP_WINDOW_SIZE; i++) {
+            x[i] = window_data[i][ch];
+        }
+
+        if (!ctx->prefiltered) {
+            DSP_KERNEL_HIGHPASS(ctx, x, ch, DSP_WINDOW_SIZE);
+            DSP_KERNEL_NOTCH(ctx, x, ch, DSP_WINDOW_SIZE);
+        }
+
+        if (rescan) {
+            scan_time_domain(x, ctx->zc_threshold, skip, &td);
+        }
+        store_time_domain(&features->values[DSP_FEATURE_TD(ch, 0)], &td, skip);
+
+        if (ctx->spectrum_skip) {
+            continue;
+        }
+
+        // x is dead once windowed into fft_input
+        PROFILE_BEGIN(PROF_FFT);
+        DSP_KERNEL_WINDOW(x, dsp_hamming_window, ctx->fft_input, DSP_FFT_SIZE);
+        DSP_KERNEL_FFT(ctx, ctx->fft_input, ctx->fft_output, DSP_FFT_SIZE);
+        DSP_KERNEL_MAGNITUDE(ctx->fft_output, ctx->magnitude, DSP_FFT_SIZE);
+        PROFILE_END(PROF_FFT);
+        DSP_ExtractFrequencyDomainFeatures(ctx, ctx->magnitude, &freq);
+
+        spectral[DSP_SPEC_MEAN_FREQ] += freq.mean_freq;
+        spectral[DSP_SPEC_MEDIAN_FREQ] += freq.median_freq;
+        for (uint8_t b = 0; b < DSP_NUM_BANDS; b++) {
+            spectral[DSP_SPEC_BAND_POWER + b] += freq.band_power[b];
+        }
+    }
+
+    for (uint8_t k = 0; k < DSP_NUM_FEATURES - DSP_TD_FEATURES; k++) {
+        features->values[DSP_TD_FEATURES + k] = spectral[k] * (1.0f / EMG_NUM_CHANNELS);
+    }
+
+    features->n_features = DSP_NUM_FEATURES;
+    features->timestamp = HAL_GetTick();
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Time-domain features of one channel, by rescanning it
+ * @note Zero crossings use DSP_ZC_THRESHOLD
+ */
+void DSP_ExtractTimeDomainFeatures(const float *data, uint16_t length, TimeDomainFeatures_t *features)
+{
+    features->rms = DSP_CalculateRMS(data, length);
+    features->mav = DSP_CalculateMAV(data, length);
+    features->var = DSP_CalculateVariance(data, length);
+    features->zc = DSP_CountZeroCrossings(data, length, DSP_ZC_THRESHOLD);
+    features->ssc = DSP_CountSlopeSignChanges(data, length);
+    features->wl = DSP_CalculateWaveformLength(data, length);
+}
+
+float DSP_CalculateRMS(const float *data, uint16_t length)
+{
+    float sum_sq = 0.0f;
+
+    for (uint16_t i = 0; i < length; i++) {
+        sum_sq += data[i] * data[i];
+    }
+
+    return (length != 0) ? sqrtf(sum_sq / (float)length) : 0.0f;
+}
+
+float DSP_CalculateMAV(const float *data, uint16_t length)
+{
+    float sum_abs = 0.0f;
+
+    for (uint16_t i = 0; i < length; i++) {
+        sum_abs += fabsf(data[i]);
+    }
+
+    return (length != 0) ? sum_abs / (float)length : 0.0f;
+}
+
+/**
+ * @brief Population variance, as np.var and DSP_GetTimeDomainFeatures
+ */
+float DSP_CalculateVariance(const float *data, uint16_t length)
+{
+    float sum = 0.0f;
+    float sum_sq = 0.0f;
+    float mean;
+
+    if (length == 0) {
+        return 0.0f;
+    }
+
+    for (uint16_t i = 0; i < length; i++) {
+        sum += data[i];
+    }
+    mean = sum / (float)length;
+
+    for (uint16_t i = 0; i < length; i++) {
+        const float d = data[i] - mean;
+        sum_sq += d * d;
+    }
+
+    return sum_sq / (float)length;
+}
+
+uint16_t DSP_CountZeroCrossings(const float *data, uint16_t length, float threshold)
+{
+    uint16_t count = 0;
+
+    for (uint16_t i = 1; i < length; i++) {
+        count += is_zero_crossing(data[i - 1], data[i], threshold);
+    }
+
+    return count;
+}
+
+uint16_t DSP_CountSlopeSignChanges(const float *data, uint16_t length)
+{
+    uint16_t count = 0;
+
+    for (uint16_t i = 2; i < length; i++) {
+        count += is_slope_sign_change(data[i - 2], data[i - 1], data[i]);
+    }
+
+    return count;
+}
+
+float DSP_CalculateWaveformLength(const float *data, uint16_t length)
+{
+    float wl = 0.0f;
+
+    for (uint16_t i = 1; i < length; i++) {
+        wl += fabsf(data[i] - data[i - 1]);
+    }
+
+    return wl;
+}
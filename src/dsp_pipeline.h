@@ -13,35 +13,180 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include <stdint.h>
 #include <stdbool.h>
+#include "emg_acquisition.h"
+#include "memory_map.h"
+#include "feature_mask.h"
+
+/* Build configuration -------------------------------------------------------*/
+// Kernel backend for FFT, magnitude, windowing and IIR filters:
+// 0 = portable reference C, 1 = CMSIS-DSP (FPU/DSP extensions)
+#ifndef DSP_USE_CMSIS_DSP
+#define DSP_USE_CMSIS_DSP     0
+#endif
+
+#if DSP_USE_CMSIS_DSP
+#include "arm_math.h"
+#endif
+
+// Streaming preprocessing on the FMAC filter accelerator (dsp_filters_fmac.c):
+// the 50 Hz notch pair runs there by DMA while the DSP task sleeps; gain
+// and high-pass stay on the CPU in float, since electrode DC offsets would
+// saturate q15 before the high-pass removes them
+#ifndef DSP_USE_FMAC
+#define DSP_USE_FMAC          0
+#endif
+
+#if DSP_USE_FMAC && !defined(FMAC)
+#error "DSP_USE_FMAC needs a device with the FMAC peripheral"
+#endif
+
+// q15 full scale of the high-passed signal fed to the FMAC (input-referred
+// volts); larger excursions clip
+#ifndef DSP_FMAC_FULL_SCALE_V
+#define DSP_FMAC_FULL_SCALE_V 0.02f
+#endif
+
+// Feature output: 0 = float Feature_Vector_t, 1 = int16 Feature_VectorQ_t
+// quantized with the model's folded scales (flat/codegen engines only)
+#ifndef DSP_QUANTIZED_FEATURES
+#define DSP_QUANTIZED_FEATURES 0
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define DSP_WINDOW_SIZE       256
+#define DSP_FFT_SIZE          DSP_WINDOW_SIZE   // Real FFT over the whole window
+#define DSP_OVERLAP_SIZE      128
+#define DSP_SAMPLE_RATE       ((float)EMG_SAMPLE_RATE_HZ)
+#define DSP_DEFAULT_HOP_SIZE  (DSP_WINDOW_SIZE - DSP_OVERLAP_SIZE)
+#define DSP_TD_RESYNC_INTERVAL 4096   // Samples between exact recomputations of td_acc
+#define DSP_ZC_THRESHOLD      0.0f    // Default zc_threshold set by DSP_Init
+
+// Feature vector layout: a time-domain block per channel, then the
+// spectral features (mean/median frequency, band powers) from
+// DSP_TD_FEATURES up to the vector length
+#define DSP_TD_RMS            0
+#define DSP_TD_MAV            1
+#define DSP_TD_VAR            2
+#define DSP_TD_ZC             3
+#define DSP_TD_SSC            4
+#define DSP_TD_WL             5
+#define DSP_TD_PER_CHANNEL    6
+#define DSP_TD_ALL            ((1U << DSP_TD_PER_CHANNEL) - 1U)
+#define DSP_TD_FEATURES       (DSP_TD_PER_CHANNEL * EMG_NUM_CHANNELS)
+#define DSP_FEATURE_TD(ch, k) ((uint8_t)((ch) * DSP_TD_PER_CHANNEL + (k)))
+
+// Frequency bands for power calculation (Hz); contiguous, in order
+#define DSP_NUM_BANDS 4
+#define BAND1_LOW   0.0f
+#define BAND1_HIGH  50.0f
+#define BAND2_LOW   50.0f
+#define BAND2_HIGH  150.0f
+#define BAND3_LOW   150.0f
+#define BAND3_HIGH  250.0f
+#define BAND4_LOW   250.0f
+#define BAND4_HIGH  500.0f
+
+// Spectral block, averaged over the channels; entries past
+// EMG_MAX_FEATURES are not stored
+#define DSP_SPEC_MEAN_FREQ    0
+#define DSP_SPEC_MEDIAN_FREQ  1
+#define DSP_SPEC_BAND_POWER   2       // DSP_NUM_BANDS entries
+#define DSP_SPECTRAL_FEATURES (2 + DSP_NUM_BANDS)
+#define DSP_NUM_FEATURES      ((DSP_TD_FEATURES + DSP_SPECTRAL_FEATURES < (int)EMG_MAX_FEATURES) ? \
+                               (DSP_TD_FEATURES + DSP_SPECTRAL_FEATURES) : (int)EMG_MAX_FEATURES)
 
 /* Exported types ------------------------------------------------------------*/
 // Feature vector containing all extracted features
 typedef struct {
-    float values[30];         // Up to 30 features
+    float values[EMG_MAX_FEATURES]; // Up to EMG_MAX_FEATURES features
     uint8_t n_features;       // Actual number of features
     uint32_t timestamp;       // When features were extracted
 } Feature_Vector_t;
 
+// Running sums for one channel of the sliding window, so time-domain
+// features are updated in O(hop) instead of rescanning the window
+typedef struct {
+    float sum;                // Sum of x
+    float sum_sq;             // Sum of x^2
+    float sum_abs;            // Sum of |x|
+    float wl;                 // Sum of |x[n] - x[n-1]|
+    uint16_t zc;              // Zero crossings over adjacent pairs
+    uint16_t ssc;             // Slope sign changes over adjacent triplets
+} DSP_TDAccumulator_t;
+
 // DSP context for processing
 typedef struct {
-    // FFT buffers
-    float fft_input[128];     // Real + imaginary interleaved
-    float fft_output[128];    
-    float magnitude[64];      // Magnitude spectrum
-    
-    // Window coefficients
-    float hamming_window[64];
+    // Real FFT buffers; the window is the const dsp_hamming_window
+    float fft_input[DSP_FFT_SIZE];      // Windowed real samples
+    float fft_output[DSP_FFT_SIZE];     // Packed spectrum: DC, Nyquist, re/im of 1 .. N/2-1;
+                                        // then power prefix sums (dsp_spectral.c)
+    float magnitude[DSP_FFT_SIZE / 2];  // Magnitude spectrum
     
     // Filter states
-    float hp_filter_state[4][2];  // High-pass filter state for 4 channels
-    float notch_filter_state[4][4]; // 50Hz notch filter state
+    float hp_filter_state[EMG_NUM_CHANNELS][2];    // High-pass filter state per channel
+    float notch_filter_state[EMG_NUM_CHANNELS][4]; // 50Hz notch filter state (2 stages)
+    
+    // Streaming preprocessing (DSP_PreprocessBuffer)
+    float channel_gain[EMG_NUM_CHANNELS]; // Volts per ADC LSB, 0 for disabled channels
+    bool prefiltered;         // Windows hold filtered data; DSP_ExtractFeatures skips its filter kernels
+    
+    // Incremental time-domain features (maintained by DSP_PushSample)
+    DSP_TDAccumulator_t td_acc[EMG_NUM_CHANNELS];
+    uint16_t td_resync_count; // Samples since last exact recomputation
+    bool td_incremental;      // DSP_ExtractFeatures reads td_acc instead of rescanning (with prefiltered)
+    float zc_threshold;       // Zero-crossing amplitude threshold
+    
+    // Feature subset (DSP_SetFeatureMask); zero computes everything.
+    // DSP_ExtractFeatures writes 0 for skipped features; DSP_PushSample does
+    // not track channels with all of DSP_TD_ALL skipped
+    uint8_t td_skip[EMG_NUM_CHANNELS]; // Bit k: DSP_TD_k of the channel is unused
+    bool spectrum_skip;       // No spectral feature used: no window, FFT or magnitude
+    
+#if DSP_USE_CMSIS_DSP
+    // CMSIS-DSP instances (state arrays above are used in place)
+    arm_rfft_fast_instance_f32 rfft;
+    arm_biquad_cascade_df2T_instance_f32 hp_biquad[EMG_NUM_CHANNELS];    // 1 stage
+    arm_biquad_cascade_df2T_instance_f32 notch_biquad[EMG_NUM_CHANNELS]; // 2 stages
+#endif
+    
+#if DSP_USE_FMAC
+    // FMAC notch history per channel and section, q15 Direct Form I,
+    // oldest first: x[n-2], x[n-1], y[n-2], y[n-1]
+    int16_t fmac_notch_state[EMG_NUM_CHANNELS][2][4];
+    bool fmac_failed;         // FMAC timed out or faulted; notch back on the CPU
+#endif
     
     // Feature extraction parameters
     uint16_t window_size;
     uint16_t fft_size;
     float sample_rate;
+    
+    // Spectral bands as bin ranges [band_start, band_end), set by DSP_InitSpectralBands
+    float freq_resolution;    // Hz per bin
+    uint16_t band_start[DSP_NUM_BANDS];
+    uint16_t band_end[DSP_NUM_BANDS];
 } DSP_Context_t;
 
+// Quantized feature vector; values compare directly against thresholds
+// exported with fold_normalization=True (half the float payload)
+typedef struct {
+    int16_t values[EMG_MAX_FEATURES]; // sat16(x * feature_qscale[i])
+    uint8_t n_features;
+    uint32_t timestamp;
+} Feature_VectorQ_t;
+
+// Sliding analysis window over the interleaved multi-channel stream.
+// Every sample is stored twice (at i and i + DSP_WINDOW_SIZE) so the
+// current window is always one contiguous [DSP_WINDOW_SIZE][EMG_NUM_CHANNELS] block
+// starting at the oldest sample; advancing the window never moves data.
+typedef struct {
+    float data[2 * DSP_WINDOW_SIZE][EMG_NUM_CHANNELS]; // Mirrored sample storage
+    uint16_t write_idx;       // Next slot to write (0 .. DSP_WINDOW_SIZE-1)
+    uint16_t count;           // Valid samples, saturates at DSP_WINDOW_SIZE
+    uint16_t hop_size;        // New samples between consecutive windows
+    uint16_t hop_count;       // Samples pushed since the last window
+} DSP_SlidingWindow_t;
+
 // Time-domain features
 typedef struct {
     float rms;                // Root Mean Square
@@ -58,34 +203,42 @@ typedef struct {
     float median_freq;        // Median Frequency
     float peak_freq;          // Peak Frequency
     float total_power;        // Total spectral power
-    float band_power[4];      // Power in frequency bands
+    float band_power[DSP_NUM_BANDS]; // Power in frequency bands
 } FrequencyDomainFeatures_t;
 
-/* Exported constants --------------------------------------------------------*/
-#define DSP_WINDOW_SIZE       256
-#define DSP_FFT_SIZE          64
-#define DSP_OVERLAP_SIZE      128
-#define DSP_SAMPLE_RATE       1000.0f
+/* Exported variables --------------------------------------------------------*/
+// Filter coefficients for EMG_SAMPLE_RATE_HZ, per stage {b0, b1, b2, -a1, -a2}
+// (CMSIS Direct Form II transposed order)
+extern const float dsp_hp_coeffs[5];      // 2nd-order Butterworth HP, 20 Hz
+extern const float dsp_notch_coeffs[10];  // 2 x notch at 50 Hz, ~1.64 Hz -3 dB bandwidth at every rate
 
-// Frequency bands for power calculation (Hz)
-#define BAND1_LOW   0.0f
-#define BAND1_HIGH  50.0f
-#define BAND2_LOW   50.0f
-#define BAND2_HIGH  150.0f
-#define BAND3_LOW   150.0f
-#define BAND3_HIGH  250.0f
-#define BAND4_LOW   250.0f
-#define BAND4_HIGH  500.0f
+// Real FFT tables (dsp_fft_tables.c, generated by src/utils/gen_dsp_tables.py)
+extern const float dsp_twiddle[DSP_FFT_SIZE];         // W_N^k, k < N/2, {re, im}
+extern const uint8_t dsp_fft_bitrev[DSP_FFT_SIZE / 2];
+extern const float dsp_hamming_window[DSP_FFT_SIZE];  // Symmetric, as np.hamming
 
 /* Exported functions prototypes ---------------------------------------------*/
 // Initialization
 HAL_StatusTypeDef DSP_Init(DSP_Context_t *ctx);
 HAL_StatusTypeDef DSP_Reset(DSP_Context_t *ctx);
 
-// Main processing function
-HAL_StatusTypeDef DSP_ExtractFeatures(DSP_Context_t *ctx, 
-                                     float window_data[][4], 
-                                     Feature_Vector_t *features);
+// Main processing function (dsp_pipeline.c). ITCM_CODE on a prototype places
+// the definition in ITCM (memory_map.h); hot per-window and per-sample
+// kernels carry it.
+ITCM_CODE HAL_StatusTypeDef DSP_ExtractFeatures(DSP_Context_t *ctx, 
+                                               float window_data[][EMG_NUM_CHANNELS], 
+                                               Feature_Vector_t *features);
+
+// Sliding window (hop_size in 1 .. DSP_WINDOW_SIZE)
+HAL_StatusTypeDef DSP_Window_Init(DSP_SlidingWindow_t *win, uint16_t hop_size);
+void DSP_Window_Reset(DSP_SlidingWindow_t *win);
+ITCM_CODE bool DSP_Window_Push(DSP_SlidingWindow_t *win, const float sample[EMG_NUM_CHANNELS]);  // true when a new window is ready
+float (*DSP_Window_Data(DSP_SlidingWindow_t *win))[EMG_NUM_CHANNELS];  // Oldest-first contiguous view
+
+// Incremental time-domain features
+ITCM_CODE bool DSP_PushSample(DSP_Context_t *ctx, DSP_SlidingWindow_t *win, const float sample[EMG_NUM_CHANNELS]);
+void DSP_ResyncTimeDomainFeatures(DSP_Context_t *ctx, DSP_SlidingWindow_t *win);
+void DSP_GetTimeDomainFeatures(const DSP_Context_t *ctx, uint8_t channel, TimeDomainFeatures_t *features);
 
 // Preprocessing functions
 void DSP_RemoveDCOffset(float *data, uint16_t length);
@@ -93,13 +246,32 @@ void DSP_ApplyHighPassFilter(DSP_Context_t *ctx, float *data, uint8_t channel, u
 void DSP_ApplyNotchFilter(DSP_Context_t *ctx, float *data, uint8_t channel, uint16_t length);
 void DSP_ApplyBandpassFilter(float *data, uint16_t length, float low_freq, float high_freq, float sample_rate);
 
-// Window functions
+// Fused DC-removal/high-pass + 50 Hz notch over all channels in one pass
+// (dsp_filters.c). Reads interleaved [length][EMG_NUM_CHANNELS] input and writes
+// channel-major output: channel ch at output[ch * stride .. + length - 1].
+// DC is removed by the high-pass double zero at z = 1; state is carried in
+// hp_filter_state / notch_filter_state across calls.
+ITCM_CODE void DSP_FilterToChannelMajor(DSP_Context_t *ctx, const float input[][EMG_NUM_CHANNELS],
+                                        float *output, uint16_t length, uint16_t stride);
+
+// Streaming preprocessing, run once per incoming EMG buffer: converts raw
+// counts with the precomputed channel gains and filters in the same pass,
+// writing interleaved [n_samples][EMG_NUM_CHANNELS] volts ready for the sliding window
+void DSP_SetChannelGains(DSP_Context_t *ctx, const EMG_Config_t *config);
+ITCM_CODE void DSP_PreprocessBuffer(DSP_Context_t *ctx, const EMG_Buffer_t *buffer,
+                                    float output[][EMG_NUM_CHANNELS]);
+
+// Window functions (the pipeline uses dsp_hamming_window, not a generated copy)
 void DSP_GenerateHammingWindow(float *window, uint16_t size);
 void DSP_ApplyWindow(const float *data, const float *window, float *output, uint16_t size);
 
-// FFT functions
-void DSP_ComputeFFT(float *input, float *output, uint16_t size);
-void DSP_ComputeMagnitudeSpectrum(const float *complex_data, float *magnitude, uint16_t size);
+// FFT functions: complex interleaved input/output
+ITCM_CODE void DSP_ComputeFFT(float *input, float *output, uint16_t size);
+ITCM_CODE void DSP_ComputeMagnitudeSpectrum(const float *complex_data, float *magnitude, uint16_t size);
+
+// Real-input FFT with packed output (dsp_fft.c); size must be DSP_FFT_SIZE
+ITCM_CODE void DSP_ComputeRealFFT(const float *input, float *output, uint16_t size);
+ITCM_CODE void DSP_ComputeRealMagnitude(const float *packed_spectrum, float *magnitude, uint16_t size);
 
 // Time-domain feature extraction
 void DSP_ExtractTimeDomainFeatures(const float *data, uint16_t length, TimeDomainFeatures_t *features);
@@ -110,18 +282,76 @@ uint16_t DSP_CountZeroCrossings(const float *data, uint16_t length, float thresh
 uint16_t DSP_CountSlopeSignChanges(const float *data, uint16_t length);
 float DSP_CalculateWaveformLength(const float *data, uint16_t length);
 
-// Frequency-domain feature extraction
-void DSP_ExtractFrequencyDomainFeatures(const float *magnitude, uint16_t size, 
-                                       float sample_rate, FrequencyDomainFeatures_t *features);
+// Frequency-domain feature extraction. The fused kernel (dsp_spectral.c)
+// computes every FrequencyDomainFeatures_t field in one sweep from the bin
+// edges precomputed by DSP_InitSpectralBands, which every caller runs after
+// DSP_Init; the single-feature functions remain for tools and tests.
+HAL_StatusTypeDef DSP_InitSpectralBands(DSP_Context_t *ctx);
+ITCM_CODE void DSP_ExtractFrequencyDomainFeatures(DSP_Context_t *ctx, const float *magnitude,
+                                                 FrequencyDomainFeatures_t *features);
 float DSP_CalculateMeanFrequency(const float *magnitude, uint16_t size, float freq_resolution);
 float DSP_CalculateMedianFrequency(const float *magnitude, uint16_t size, float freq_resolution);
 float DSP_CalculateBandPower(const float *magnitude, uint16_t size, 
                             float freq_resolution, float low_freq, float high_freq);
 
+// FMAC backend (dsp_filters_fmac.c). DSP_FMAC_PreprocessBuffer matches
+// DSP_PreprocessBuffer but blocks the calling task while the FMAC filters;
+// after an FMAC failure it runs DSP_PreprocessBuffer from then on
+#if DSP_USE_FMAC
+HAL_StatusTypeDef DSP_FMAC_Init(DSP_Context_t *ctx, FMAC_HandleTypeDef *hfmac);  // After DSP_Init
+void DSP_FMAC_PreprocessBuffer(DSP_Context_t *ctx, const EMG_Buffer_t *buffer,
+                               float output[][EMG_NUM_CHANNELS]);
+void DSP_FMAC_TransferComplete(void);   // HAL_FMAC_OutputDataReadyCallback
+void DSP_FMAC_TransferError(void);      // HAL_FMAC_ErrorCallback
+#endif
+
+// CMSIS-DSP backend (dsp_pipeline_cmsis.c)
+#if DSP_USE_CMSIS_DSP
+HAL_StatusTypeDef DSP_CMSIS_Init(DSP_Context_t *ctx);
+void DSP_CMSIS_ApplyHighPassFilter(DSP_Context_t *ctx, float *data, uint8_t channel, uint16_t length);
+void DSP_CMSIS_ApplyNotchFilter(DSP_Context_t *ctx, float *data, uint8_t channel, uint16_t length);
+void DSP_CMSIS_ApplyWindow(const float *data, const float *window, float *output, uint16_t size);
+ITCM_CODE void DSP_CMSIS_ComputeFFT(DSP_Context_t *ctx, float *input, float *output, uint16_t size);
+ITCM_CODE void DSP_CMSIS_ComputeMagnitudeSpectrum(const float *packed_spectrum, float *magnitude, uint16_t size);
+#endif
+
+// Feature subset from the model (RF_GET_MODEL_INFO); NULL selects every
+// feature. Call after DSP_Init.
+void DSP_SetFeatureMask(DSP_Context_t *ctx, const Feature_Mask_t *mask);
+
 // Utility functions
 void DSP_NormalizeFeatures(Feature_Vector_t *features);
+ITCM_CODE void DSP_QuantizeFeatures(const Feature_Vector_t *features, const float *scale,
+                                    Feature_VectorQ_t *quantized);
 float DSP_GetFrequencyResolution(float sample_rate, uint16_t fft_size);
 
+/* Exported macro ------------------------------------------------------------*/
+// Kernel dispatch used by the pipeline; both backends stay linkable so the
+// benchmark can run them side by side. Both FFTs take `size` real samples
+// and return the CMSIS packed spectrum, from which the magnitude kernel
+// produces size/2 bins; the reference FFT leaves its input intact, the
+// CMSIS one overwrites it.
+#if DSP_USE_CMSIS_DSP
+#define DSP_KERNEL_HIGHPASS(ctx, data, ch, len)  DSP_CMSIS_ApplyHighPassFilter((ctx), (data), (ch), (len))
+#define DSP_KERNEL_NOTCH(ctx, data, ch, len)     DSP_CMSIS_ApplyNotchFilter((ctx), (data), (ch), (len))
+#define DSP_KERNEL_WINDOW(data, win, out, n)     DSP_CMSIS_ApplyWindow((data), (win), (out), (n))
+#define DSP_KERNEL_FFT(ctx, in, out, n)          DSP_CMSIS_ComputeFFT((ctx), (in), (out), (n))
+#define DSP_KERNEL_MAGNITUDE(spec, mag, n)       DSP_CMSIS_ComputeMagnitudeSpectrum((spec), (mag), (n))
+#else
+#define DSP_KERNEL_HIGHPASS(ctx, data, ch, len)  DSP_ApplyHighPassFilter((ctx), (data), (ch), (len))
+#define DSP_KERNEL_NOTCH(ctx, data, ch, len)     DSP_ApplyNotchFilter((ctx), (data), (ch), (len))
+#define DSP_KERNEL_WINDOW(data, win, out, n)     DSP_ApplyWindow((data), (win), (out), (n))
+#define DSP_KERNEL_FFT(ctx, in, out, n)          DSP_ComputeRealFFT((in), (out), (n))
+#define DSP_KERNEL_MAGNITUDE(spec, mag, n)       DSP_ComputeRealMagnitude((spec), (mag), (n))
+#endif
+
+// Per-block conversion and filtering
+#if DSP_USE_FMAC
+#define DSP_KERNEL_PREPROCESS(ctx, buffer, out)  DSP_FMAC_PreprocessBuffer((ctx), (buffer), (out))
+#else
+#define DSP_KERNEL_PREPROCESS(ctx, buffer, out)  DSP_PreprocessBuffer((ctx), (buffer), (out))
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,87 @@
+/**
+ * @file dsp_pipeline_cmsis.c
+ * @brief CMSIS-DSP kernel backend for the DSP pipeline
+ *
+ * Built when DSP_USE_CMSIS_DSP is 1. Filter states live in the existing
+ * DSP_Context_t arrays (hp_filter_state / notch_filter_state), which match
+ * the Direct Form II transposed layout of 2 floats per biquad stage.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include "stm32h7xx_hal.h"
+#include "dsp_pipeline.h"
+
+#if DSP_USE_CMSIS_DSP
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Initialize CMSIS-DSP instances in the context
+ * @note Called from DSP_Init; clears the filter states
+ */
+HAL_StatusTypeDef DSP_CMSIS_Init(DSP_Context_t *ctx)
+{
+    uint16_t fft_size = (ctx->fft_size != 0) ? ctx->fft_size : DSP_FFT_SIZE;
+
+    if (arm_rfft_fast_init_f32(&ctx->rfft, fft_size) != ARM_MATH_SUCCESS) {
+        return HAL_ERROR;
+    }
+
+    for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+        arm_biquad_cascade_df2T_init_f32(&ctx->hp_biquad[ch], 1,
+                                         dsp_hp_coeffs, ctx->hp_filter_state[ch]);
+        arm_biquad_cascade_df2T_init_f32(&ctx->notch_biquad[ch], 2,
+                                         dsp_notch_coeffs, ctx->notch_filter_state[ch]);
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief High-pass filter one channel in place
+ */
+void DSP_CMSIS_ApplyHighPassFilter(DSP_Context_t *ctx, float *data, uint8_t channel, uint16_t length)
+{
+    arm_biquad_cascade_df2T_f32(&ctx->hp_biquad[channel], data, data, length);
+}
+
+/**
+ * @brief 50 Hz notch filter one channel in place
+ */
+void DSP_CMSIS_ApplyNotchFilter(DSP_Context_t *ctx, float *data, uint8_t channel, uint16_t length)
+{
+    arm_biquad_cascade_df2T_f32(&ctx->notch_biquad[channel], data, data, length);
+}
+
+/**
+ * @brief Element-wise window multiply
+ */
+void DSP_CMSIS_ApplyWindow(const float *data, const float *window, float *output, uint16_t size)
+{
+    arm_mult_f32(data, window, output, size);
+}
+
+/**
+ * @brief Real-input forward FFT
+ * @param input  `size` real samples (overwritten by arm_rfft_fast_f32)
+ * @param output `size` floats: [0] = DC, [1] = Nyquist, then re/im pairs
+ */
+void DSP_CMSIS_ComputeFFT(DSP_Context_t *ctx, float *input, float *output, uint16_t size)
+{
+    (void)size;  // Fixed by the instance set up in DSP_CMSIS_Init
+    arm_rfft_fast_f32(&ctx->rfft, input, output, 0);
+}
+
+/**
+ * @brief Magnitude of a CMSIS packed real spectrum
+ * @param size FFT length; `size/2` magnitudes are written
+ */
+void DSP_CMSIS_ComputeMagnitudeSpectrum(const float *packed_spectrum, float *magnitude, uint16_t size)
+{
+    // Bin 0 is purely real; the Nyquist term packed into [1] is dropped
+    magnitude[0] = fabsf(packed_spectrum[0]);
+    arm_cmplx_mag_f32(&packed_spectrum[2], &magnitude[1], (size / 2) - 1);
+}
+
+#endif /* DSP_USE_CMSIS_DSP */
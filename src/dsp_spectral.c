@@ -0,0 +1,232 @@
+/**
+ * @file dsp_spectral.c
+ * @brief Single-pass frequency-domain features
+ *
+ * Total power, the four band powers, the power-weighted bin sum (mean
+ * frequency) and the peak all come from one sweep over the magnitude
+ * spectrum. The sweep also writes the running power sum into the dead
+ * fft_output buffer, so the median is a binary search over that prefix
+ * rather than a second pass. Band edges are bin indices computed once by
+ * DSP_InitSpectralBands; the bands are contiguous segments of the sweep, so
+ * no per-bin band test is made.
+ *
+ * The single-feature DSP_Calculate* functions at the end compute the same
+ * quantities one at a time, for the benchmark and tools.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "dsp_pipeline.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define SPECTRAL_BINS           (DSP_FFT_SIZE / 2)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    float cum;                // Power of bins swept so far
+    float weighted;           // Sum of k * P[k]
+    float peak;
+    uint16_t peak_bin;
+} Sweep_t;
+
+/* Private functions ---------------------------------------------------------*/
+// Bins [start, end): accumulate into s, prefix sums into cum[]; returns the
+// segment power
+static inline float sweep_segment(Sweep_t *s, const float *magnitude, float *cum,
+                                  uint16_t start, uint16_t end)
+{
+    float segment = 0.0f;
+
+    for (uint16_t k = start; k < end; k++) {
+        const float p = magnitude[k] * magnitude[k];
+
+        segment += p;
+        s->weighted += (float)k * p;
+        cum[k] = s->cum + segment;
+
+        if (p > s->peak) {
+            s->peak = p;
+            s->peak_bin = k;
+        }
+    }
+
+    s->cum += segment;
+    return segment;
+}
+
+static inline uint16_t freq_to_bin(float freq, float resolution)
+{
+    float bin = freq / resolution;
+    uint16_t k = (uint16_t)bin;
+
+    // Round up: a band includes the bins whose centre frequency is inside it
+    if ((float)k < bin) {
+        k++;
+    }
+
+    return (k > SPECTRAL_BINS) ? SPECTRAL_BINS : k;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Precompute frequency resolution and band edges as bin indices
+ * @note Call after DSP_Init (which clears them) and before the first
+ *       DSP_ExtractFeatures; band k covers [BANDk_LOW, BANDk_HIGH)
+ * @return HAL_ERROR if the bands overlap or are out of order
+ */
+HAL_StatusTypeDef DSP_InitSpectralBands(DSP_Context_t *ctx)
+{
+    static const float edges[DSP_NUM_BANDS][2] = {
+        { BAND1_LOW, BAND1_HIGH },
+        { BAND2_LOW, BAND2_HIGH },
+        { BAND3_LOW, BAND3_HIGH },
+        { BAND4_LOW, BAND4_HIGH },
+    };
+    const float fs = (ctx->sample_rate > 0.0f) ? ctx->sample_rate : DSP_SAMPLE_RATE;
+    uint16_t prev_end = 0;
+
+    ctx->freq_resolution = fs / (float)DSP_FFT_SIZE;
+
+    for (uint8_t b = 0; b < DSP_NUM_BANDS; b++) {
+        const uint16_t start = freq_to_bin(edges[b][0], ctx->freq_resolution);
+        const uint16_t end = freq_to_bin(edges[b][1], ctx->freq_resolution);
+
+        if (start < prev_end || end < start) {
+            return HAL_ERROR;
+        }
+
+        ctx->band_start[b] = start;
+        ctx->band_end[b] = end;
+        prev_end = end;
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief All FrequencyDomainFeatures_t fields in one sweep of the spectrum
+ * @param magnitude DSP_FFT_SIZE / 2 bins from DSP_KERNEL_MAGNITUDE
+ * @note Uses ctx->fft_output as prefix-sum scratch; run after the magnitude
+ *       kernel and before the next channel's FFT
+ */
+void DSP_ExtractFrequencyDomainFeatures(DSP_Context_t *ctx, const float *magnitude,
+                                        FrequencyDomainFeatures_t *features)
+{
+    float *cum = ctx->fft_output;
+    Sweep_t s = { 0.0f, 0.0f, 0.0f, 0 };
+    uint16_t k = 0;
+
+    for (uint8_t b = 0; b < DSP_NUM_BANDS; b++) {
+        sweep_segment(&s, magnitude, cum, k, ctx->band_start[b]);
+        features->band_power[b] = sweep_segment(&s, magnitude, cum, ctx->band_start[b],
+                                                ctx->band_end[b]);
+        k = ctx->band_end[b];
+    }
+    sweep_segment(&s, magnitude, cum, k, SPECTRAL_BINS);
+
+    features->total_power = s.cum;
+
+    if (s.cum <= 0.0f) {
+        features->mean_freq = 0.0f;
+        features->median_freq = 0.0f;
+        features->peak_freq = 0.0f;
+        return;
+    }
+
+    // First bin whose prefix reaches half the power
+    {
+        const float half = 0.5f * s.cum;
+        uint16_t lo = 0;
+        uint16_t hi = SPECTRAL_BINS - 1U;
+
+        while (lo < hi) {
+            const uint16_t mid = (uint16_t)((lo + hi) >> 1);
+
+            if (cum[mid] < half) {
+                lo = mid + 1U;
+            } else {
+                hi = mid;
+            }
+        }
+
+        features->median_freq = (float)lo * ctx->freq_resolution;
+    }
+
+    features->mean_freq = (s.weighted / s.cum) * ctx->freq_resolution;
+    features->peak_freq = (float)s.peak_bin * ctx->freq_resolution;
+}
+
+/**
+ * @brief Power-weighted mean frequency of one spectrum
+ * @note Reference for the fused kernel; same bin convention (k * resolution)
+ */
+float DSP_CalculateMeanFrequency(const float *magnitude, uint16_t size, float freq_resolution)
+{
+    float total = 0.0f;
+    float weighted = 0.0f;
+
+    for (uint16_t k = 0; k < size; k++) {
+        const float p = magnitude[k] * magnitude[k];
+
+        total += p;
+        weighted += (float)k * p;
+    }
+
+    return (total > 0.0f) ? (weighted / total) * freq_resolution : 0.0f;
+}
+
+/**
+ * @brief Frequency of the first bin at which the power reaches half the total
+ */
+float DSP_CalculateMedianFrequency(const float *magnitude, uint16_t size, float freq_resolution)
+{
+    float total = 0.0f;
+    float cum = 0.0f;
+
+    for (uint16_t k = 0; k < size; k++) {
+        total += magnitude[k] * magnitude[k];
+    }
+    if (total <= 0.0f) {
+        return 0.0f;
+    }
+
+    for (uint16_t k = 0; k < size; k++) {
+        cum += magnitude[k] * magnitude[k];
+        if (cum >= 0.5f * total) {
+            return (float)k * freq_resolution;
+        }
+    }
+
+    return (float)(size - 1U) * freq_resolution;
+}
+
+/**
+ * @brief Power of the bins whose centre frequency is in [low_freq, high_freq)
+ * @note Same edges as DSP_InitSpectralBands
+ */
+float DSP_CalculateBandPower(const float *magnitude, uint16_t size,
+                             float freq_resolution, float low_freq, float high_freq)
+{
+    uint16_t start = freq_to_bin(low_freq, freq_resolution);
+    uint16_t end = freq_to_bin(high_freq, freq_resolution);
+    float power = 0.0f;
+
+    if (end > size) {
+        end = size;
+    }
+
+    for (uint16_t k = start; k < end; k++) {
+        power += magnitude[k] * magnitude[k];
+    }
+
+    return power;
+}
+
+/**
+ * @brief Hz per bin of a real FFT of fft_size samples
+ */
+float DSP_GetFrequencyResolution(float sample_rate, uint16_t fft_size)
+{
+    return (fft_size != 0) ? sample_rate / (float)fft_size : 0.0f;
+}
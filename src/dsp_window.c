@@ -0,0 +1,226 @@
+/**
+ * @file dsp_window.c
+ * @brief Streaming sliding-window support for the DSP pipeline
+ *
+ * The window is a mirrored ring: each sample is written at slot i and at
+ * slot i + DSP_WINDOW_SIZE, so the DSP_WINDOW_SIZE samples starting at the
+ * oldest one are always contiguous. Advancing the window by any hop costs
+ * two row stores per sample instead of a memmove of the overlap.
+ *
+ * DSP_PushSample additionally keeps per-channel running sums of the
+ * time-domain features: the sample leaving the window is subtracted and the
+ * incoming one added, so RMS/MAV/VAR/ZC/SSC/WL cost O(hop) per window.
+ * Channels whose time-domain features the model never reads
+ * (ctx->td_skip) are not tracked.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <math.h>
+#include "stm32h7xx_hal.h"
+#include "dsp_pipeline.h"
+
+/* Private functions ---------------------------------------------------------*/
+static inline bool is_zero_crossing(float a, float b, float threshold)
+{
+    return (a * b < 0.0f) && (fabsf(a - b) >= threshold);
+}
+
+static inline bool is_slope_sign_change(float a, float b, float c)
+{
+    return (b - a) * (b - c) > 0.0f;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Initialize a sliding window
+ * @param hop_size New samples between consecutive analysis windows
+ */
+HAL_StatusTypeDef DSP_Window_Init(DSP_SlidingWindow_t *win, uint16_t hop_size)
+{
+    if (win == NULL || hop_size == 0 || hop_size > DSP_WINDOW_SIZE) {
+        return HAL_ERROR;
+    }
+
+    win->hop_size = hop_size;
+    DSP_Window_Reset(win);
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Discard all buffered samples, keeping the hop size
+ */
+void DSP_Window_Reset(DSP_SlidingWindow_t *win)
+{
+    win->write_idx = 0;
+    win->count = 0;
+    win->hop_count = 0;
+}
+
+/**
+ * @brief Append one multi-channel sample
+ * @return true when a full window with hop_size new samples is available
+ */
+bool DSP_Window_Push(DSP_SlidingWindow_t *win, const float sample[EMG_NUM_CHANNELS])
+{
+    memcpy(win->data[win->write_idx], sample, sizeof(win->data[0]));
+    memcpy(win->data[win->write_idx + DSP_WINDOW_SIZE], sample, sizeof(win->data[0]));
+
+    if (++win->write_idx >= DSP_WINDOW_SIZE) {
+        win->write_idx = 0;
+    }
+
+    if (win->count < DSP_WINDOW_SIZE) {
+        win->count++;
+    }
+
+    win->hop_count++;
+
+    if (win->count == DSP_WINDOW_SIZE && win->hop_count >= win->hop_size) {
+        win->hop_count = 0;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Contiguous view of the current window, oldest sample first
+ * @note Valid for DSP_WINDOW_SIZE rows once the window has filled; can be
+ *       passed straight to DSP_ExtractFeatures
+ */
+float (*DSP_Window_Data(DSP_SlidingWindow_t *win))[EMG_NUM_CHANNELS]
+{
+    // Once full, the oldest sample sits at the next write position
+    uint16_t head = (win->count == DSP_WINDOW_SIZE) ? win->write_idx : 0;
+
+    return &win->data[head];
+}
+
+/**
+ * @brief Push one sample into the window and update the running features
+ * @note Must be used instead of DSP_Window_Push when ctx->td_acc is in use:
+ *       the retiring samples are read before the push overwrites them
+ * @return true when a new window is ready
+ */
+bool DSP_PushSample(DSP_Context_t *ctx, DSP_SlidingWindow_t *win, const float sample[EMG_NUM_CHANNELS])
+{
+    const uint16_t w = win->write_idx;
+    const float threshold = ctx->zc_threshold;
+    bool ready;
+
+    for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+        DSP_TDAccumulator_t *acc = &ctx->td_acc[ch];
+        const float x = sample[ch];
+
+        // No time-domain feature of this channel is read by the model
+        if (ctx->td_skip[ch] == DSP_TD_ALL) {
+            continue;
+        }
+
+        // Retire the oldest sample; with mirrored storage the three oldest
+        // samples are always at [w], [w + 1], [w + 2]
+        if (win->count == DSP_WINDOW_SIZE) {
+            const float x0 = win->data[w][ch];
+            const float x1 = win->data[w + 1][ch];
+            const float x2 = win->data[w + 2][ch];
+
+            acc->sum -= x0;
+            acc->sum_sq -= x0 * x0;
+            acc->sum_abs -= fabsf(x0);
+            acc->wl -= fabsf(x1 - x0);
+            acc->zc -= is_zero_crossing(x0, x1, threshold);
+            acc->ssc -= is_slope_sign_change(x0, x1, x2);
+        }
+
+        acc->sum += x;
+        acc->sum_sq += x * x;
+        acc->sum_abs += fabsf(x);
+
+        // The two newest samples are at [w + N - 1] and [w + N - 2]
+        if (win->count >= 1) {
+            const float x_last = win->data[w + DSP_WINDOW_SIZE - 1][ch];
+
+            acc->wl += fabsf(x - x_last);
+            acc->zc += is_zero_crossing(x_last, x, threshold);
+
+            if (win->count >= 2) {
+                const float x_prev = win->data[w + DSP_WINDOW_SIZE - 2][ch];
+                acc->ssc += is_slope_sign_change(x_prev, x_last, x);
+            }
+        }
+    }
+
+    ready = DSP_Window_Push(win, sample);
+
+    // Bound floating-point drift of the add/subtract sums
+    if (++ctx->td_resync_count >= DSP_TD_RESYNC_INTERVAL) {
+        DSP_ResyncTimeDomainFeatures(ctx, win);
+    }
+
+    return ready;
+}
+
+/**
+ * @brief Recompute the running sums exactly from the samples in the window
+ * @note Also used to clear td_acc after DSP_Window_Reset
+ */
+void DSP_ResyncTimeDomainFeatures(DSP_Context_t *ctx, DSP_SlidingWindow_t *win)
+{
+    float (*data)[EMG_NUM_CHANNELS] = DSP_Window_Data(win);
+    const uint16_t n = win->count;
+
+    memset(ctx->td_acc, 0, sizeof(ctx->td_acc));
+    ctx->td_resync_count = 0;
+
+    for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+        DSP_TDAccumulator_t *acc = &ctx->td_acc[ch];
+
+        if (ctx->td_skip[ch] == DSP_TD_ALL) {
+            continue;
+        }
+
+        for (uint16_t i = 0; i < n; i++) {
+            const float x = data[i][ch];
+
+            acc->sum += x;
+            acc->sum_sq += x * x;
+            acc->sum_abs += fabsf(x);
+
+            if (i >= 1) {
+                acc->wl += fabsf(x - data[i - 1][ch]);
+                acc->zc += is_zero_crossing(data[i - 1][ch], x, ctx->zc_threshold);
+            }
+
+            if (i >= 2) {
+                acc->ssc += is_slope_sign_change(data[i - 2][ch], data[i - 1][ch], x);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Time-domain features of one channel of the current window in O(1)
+ */
+void DSP_GetTimeDomainFeatures(const DSP_Context_t *ctx, uint8_t channel, TimeDomainFeatures_t *features)
+{
+    const DSP_TDAccumulator_t *acc = &ctx->td_acc[channel];
+    const float inv_n = 1.0f / DSP_WINDOW_SIZE;
+    const float mean = acc->sum * inv_n;
+    const float mean_sq = acc->sum_sq * inv_n;
+    float var = mean_sq - mean * mean;
+
+    // Cancellation in the running sums can leave a tiny negative residue
+    if (var < 0.0f) {
+        var = 0.0f;
+    }
+
+    features->rms = sqrtf(mean_sq > 0.0f ? mean_sq : 0.0f);
+    features->mav = acc->sum_abs * inv_n;
+    features->var = var;
+    features->zc = acc->zc;
+    features->ssc = acc->ssc;
+    features->wl = acc->wl;
+}
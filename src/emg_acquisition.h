@@ -13,17 +13,26 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include <stdint.h>
 #include "stm32h7xx_hal.h"
+#include "emg_config.h"
 
 /* Exported types ------------------------------------------------------------*/
+#define EMG_BUFFER_SAMPLES          256   // Samples per DMA block
+
+// Samples per half of the raw DMA double buffer, i.e. per DSP wakeup
+#ifndef EMG_DMA_BLOCK_SAMPLES
+#define EMG_DMA_BLOCK_SAMPLES       EMG_BUFFER_SAMPLES
+#endif
+
 typedef struct {
-    int32_t data[4];          // 4 channels of 24-bit data
+    int32_t data[EMG_NUM_CHANNELS]; // 24-bit codes, sign-extended
     uint32_t timestamp;       // System tick when sample was acquired
 } EMG_Sample_t;
 
 typedef struct {
-    EMG_Sample_t samples[256]; // Buffer for DMA transfer
+    EMG_Sample_t samples[EMG_BUFFER_SAMPLES]; // Buffer for DMA transfer
     uint16_t n_samples;       // Number of valid samples
-    uint8_t buffer_id;        // 0 or 1 for double buffering
+    uint8_t buffer_id;        // Pool slot index (0 .. EMG_BUFFER_POOL_SIZE-1)
+    uint32_t drdy_cycles;     // DWT cycle count at DRDY of the last sample
 } EMG_Buffer_t;
 
 typedef struct {
@@ -57,22 +66,77 @@ typedef struct {
 
 // Configuration values
 #define ADS1299_SAMPLE_RATE_1000HZ  0x86  // fMOD/4096
+
+// CONFIG1 for EMG_SAMPLE_RATE_HZ: reserved bits 7 and 4 set, DR[2:0]
+#if EMG_SAMPLE_RATE_HZ == 4000U
+#define ADS1299_CONFIG1_DR          0x02
+#elif EMG_SAMPLE_RATE_HZ == 2000U
+#define ADS1299_CONFIG1_DR          0x03
+#else
+#define ADS1299_CONFIG1_DR          0x04  // 1 kSPS
+#endif
+#define ADS1299_CONFIG1_VALUE       (0x90 | ADS1299_CONFIG1_DR)
 #define ADS1299_PGA_GAIN_24         0x60  // Gain = 24
+#define ADS1299_VREF                4.5f  // Internal reference (V)
+#define ADS1299_FULL_SCALE_CODES    8388608.0f  // 2^23, 24-bit two's complement
+
+// RDATAC frame: 24 status bits, then 24 bits per channel, MSB first.
+// 27 bytes covers the 8-channel part; CH1..EMG_NUM_CHANNELS are unpacked.
+#ifndef ADS1299_FRAME_BYTES
+#define ADS1299_FRAME_BYTES         27
+#endif
+#define ADS1299_STATUS_BYTES        3
+
+#if ADS1299_FRAME_BYTES < (ADS1299_STATUS_BYTES + 3 * EMG_NUM_CHANNELS)
+#error "ADS1299_FRAME_BYTES must cover the status word and every acquired channel"
+#endif
+
+// Pins
+#define ADS1299_CS_GPIO_Port        GPIOA
+#define ADS1299_CS_Pin              GPIO_PIN_4
+#define ADS1299_DRDY_GPIO_Port      GPIOB
+#define ADS1299_DRDY_Pin            GPIO_PIN_0   // EXTI0, falling edge
+
+// Buffer ownership
+#define EMG_BUFFER_POOL_SIZE        4     // Buffers owned by the driver
 
 /* Exported functions prototypes ---------------------------------------------*/
 HAL_StatusTypeDef EMG_Init(SPI_HandleTypeDef *hspi);
 HAL_StatusTypeDef EMG_Configure(const EMG_Config_t *config);
+HAL_StatusTypeDef EMG_GetConfig(EMG_Config_t *config);
 HAL_StatusTypeDef EMG_StartContinuous(void);
 HAL_StatusTypeDef EMG_StopContinuous(void);
 HAL_StatusTypeDef EMG_ReadBuffer(EMG_Buffer_t *buffer);
+
+/*
+ * Zero-copy buffer ownership. Each falling DRDY edge starts one SPI DMA
+ * read of an ADS1299_FRAME_BYTES frame into a raw double buffer of two
+ * halves of EMG_DMA_BLOCK_SAMPLES frames. When a half fills, the
+ * half/full complete callback notifies the consumer task given to
+ * EMG_DMA_Start; nothing wakes per sample. EMG_AcquireBuffer unpacks the
+ * oldest completed half in bulk (sign-extended 24-bit codes) into a pool
+ * buffer and hands it to the caller, which must return it with
+ * EMG_ReleaseBuffer once the samples are consumed. Returns HAL_BUSY when no
+ * half is pending or every pool buffer is held; a half that is refilled
+ * before it was unpacked counts as EMG_DMA_BLOCK_SAMPLES dropped samples.
+ * The DRDY interrupt stamps DWT->CYCCNT for every frame it starts, so a
+ * buffer carries the DRDY time of its last sample in drdy_cycles.
+ * Only the raw frames are DMA targets; they are declared DMA_BUFFER
+ * (memory_map.h), so the driver does no cache maintenance when
+ * MEM_PLACEMENT is set. The interrupt side and the pool live in
+ * emg_acquisition_dma.c/.h.
+ */
+HAL_StatusTypeDef EMG_AcquireBuffer(EMG_Buffer_t **buffer);
+void EMG_ReleaseBuffer(EMG_Buffer_t *buffer);
+uint8_t EMG_GetFreeBufferCount(void);
 HAL_StatusTypeDef EMG_Calibrate(void);
 float EMG_ConvertToVoltage(int32_t raw_value);
 HAL_StatusTypeDef EMG_SetGain(uint8_t channel, uint8_t gain);
 HAL_StatusTypeDef EMG_EnableChannel(uint8_t channel, bool enable);
 
 /* DMA callback functions */
-void EMG_DMA_HalfCompleteCallback(void);
-void EMG_DMA_CompleteCallback(void);
+void EMG_DMA_HalfCompleteCallback(void);   // First half filled
+void EMG_DMA_CompleteCallback(void);       // Second half filled
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,361 @@
+/**
+ * @file emg_acquisition_dma.c
+ * @brief DRDY-triggered SPI DMA frame reads, half-buffer notification and
+ *        bulk unpacking into the zero-copy buffer pool
+ *
+ * Producer side (interrupts): the DRDY EXTI pulls CS low and starts a
+ * full-duplex DMA transfer of one frame into the current raw half; the SPI
+ * complete callback raises CS and advances. Every EMG_DMA_BLOCK_SAMPLES
+ * frames the half/full complete callback bumps the completed-half count and
+ * notifies the consumer task, so the CPU never runs per-sample task code.
+ *
+ * Consumer side (task): EMG_AcquireBuffer decodes half k, which lives in
+ * raw[k & 1]. The producer starts overwriting that slot once half k + 1
+ * completes, so k is valid only while fewer than k + 2 halves are done;
+ * the count is checked again after decoding, seqlock-style, and a half
+ * that was torn or skipped is charged to dropped_samples.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "emg_acquisition_dma.h"
+#include "memory_map.h"
+#include "profiler.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define EMG_DMA_HALVES          2U
+
+#if EMG_DMA_BLOCK_SAMPLES > EMG_BUFFER_SAMPLES || EMG_DMA_BLOCK_SAMPLES < 2
+#error "EMG_DMA_BLOCK_SAMPLES must be 2..EMG_BUFFER_SAMPLES"
+#endif
+
+#if MEM_DMA_CACHE_MAINTENANCE && ((EMG_DMA_BLOCK_SAMPLES * ADS1299_FRAME_BYTES) % 32)
+#error "Raw half-buffers must be whole cache lines when DMA buffers are cached"
+#endif
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    uint32_t first_cycles;    // DRDY of the first frame in the half
+    uint32_t last_cycles;     // DRDY of the last frame
+    uint32_t last_tick;       // HAL tick when the half completed
+} Half_Stamp_t;
+
+/* Private variables ---------------------------------------------------------*/
+// DMA targets: written only by the SPI RX stream, read after completion
+static uint8_t raw_frames[EMG_DMA_HALVES][EMG_DMA_BLOCK_SAMPLES][ADS1299_FRAME_BYTES] DMA_BUFFER;
+static uint8_t tx_zeros[ADS1299_FRAME_BYTES] DMA_BUFFER;   // Clocks out the frame, no command
+
+static SPI_HandleTypeDef *emg_spi = NULL;
+static TaskHandle_t consumer_task = NULL;
+static volatile bool running = false;
+
+// Producer state (DRDY and SPI interrupts)
+static volatile bool frame_busy = false;
+static uint8_t fill_half = 0;
+static uint16_t fill_index = 0;
+static uint32_t frame_cycles = 0;
+static Half_Stamp_t half_stamp[EMG_DMA_HALVES];
+static volatile uint32_t halves_done = 0;   // Monotonic, written only by the producer
+
+// Consumer state (task)
+static uint32_t halves_taken = 0;
+static uint32_t unread_samples = 0;         // Halves overwritten before EMG_AcquireBuffer
+
+static EMG_Buffer_t buffer_pool[EMG_BUFFER_POOL_SIZE];
+static volatile bool buffer_held[EMG_BUFFER_POOL_SIZE];
+
+static volatile EMG_DMA_Stats_t dma_stats;
+
+/* Private functions ---------------------------------------------------------*/
+static inline void cs_high(void)
+{
+    HAL_GPIO_WritePin(ADS1299_CS_GPIO_Port, ADS1299_CS_Pin, GPIO_PIN_SET);
+}
+
+static inline void cs_low(void)
+{
+    HAL_GPIO_WritePin(ADS1299_CS_GPIO_Port, ADS1299_CS_Pin, GPIO_PIN_RESET);
+}
+
+// 24-bit big-endian two's complement to int32
+static inline int32_t unpack_code(const uint8_t *p)
+{
+    return (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8)) >> 8;
+}
+
+static void half_complete_from_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    halves_done++;
+    dma_stats.blocks++;
+
+    if (consumer_task != NULL) {
+        vTaskNotifyGiveFromISR(consumer_task, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+static EMG_Buffer_t *take_free_buffer(void)
+{
+    for (uint8_t i = 0; i < EMG_BUFFER_POOL_SIZE; i++) {
+        if (!buffer_held[i]) {
+            buffer_held[i] = true;
+            return &buffer_pool[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void unpack_half(uint8_t half, EMG_Buffer_t *buffer)
+{
+    const Half_Stamp_t *stamp = &half_stamp[half];
+    const uint32_t n = EMG_DMA_BLOCK_SAMPLES;
+    const uint32_t period = (stamp->last_cycles - stamp->first_cycles) / (n - 1U);
+    const uint32_t cycles_per_ms = SystemCoreClock / 1000U;
+
+#if MEM_DMA_CACHE_MAINTENANCE
+    SCB_InvalidateDCache_by_Addr((uint32_t *)raw_frames[half], sizeof(raw_frames[half]));
+#endif
+
+    for (uint32_t i = 0; i < n; i++) {
+        const uint8_t *codes = &raw_frames[half][i][ADS1299_STATUS_BYTES];
+        EMG_Sample_t *sample = &buffer->samples[i];
+
+        for (uint8_t ch = 0; ch < EMG_NUM_CHANNELS; ch++) {
+            sample->data[ch] = unpack_code(&codes[3U * ch]);
+        }
+        sample->timestamp = stamp->last_tick - ((n - 1U - i) * period) / cycles_per_ms;
+    }
+
+    buffer->n_samples = (uint16_t)n;
+    buffer->drdy_cycles = stamp->last_cycles;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Attach the SPI handle used for frame reads
+ * @note The handle must have its RX and TX DMA streams linked
+ */
+HAL_StatusTypeDef EMG_DMA_Init(SPI_HandleTypeDef *hspi)
+{
+    if (hspi == NULL || hspi->hdmarx == NULL || hspi->hdmatx == NULL) {
+        return HAL_ERROR;
+    }
+
+    emg_spi = hspi;
+    running = false;
+
+    for (uint8_t i = 0; i < EMG_BUFFER_POOL_SIZE; i++) {
+        buffer_pool[i].buffer_id = i;
+        buffer_held[i] = false;
+    }
+
+    memset(tx_zeros, 0, sizeof(tx_zeros));
+#if MEM_DMA_CACHE_MAINTENANCE
+    SCB_CleanDCache_by_Addr((uint32_t *)tx_zeros, sizeof(tx_zeros));
+#endif
+
+    cs_high();
+    return HAL_OK;
+}
+
+/**
+ * @brief Arm DRDY-triggered reads; consumer is notified once per half
+ * @note Call before EMG_StartContinuous puts the ADS1299 in RDATAC
+ */
+HAL_StatusTypeDef EMG_DMA_Start(TaskHandle_t consumer)
+{
+    if (emg_spi == NULL) {
+        return HAL_ERROR;
+    }
+
+    running = false;
+    consumer_task = consumer;
+    frame_busy = false;
+    fill_half = 0;
+    fill_index = 0;
+    halves_done = 0;
+    halves_taken = 0;
+    unread_samples = 0;
+    memset((void *)&dma_stats, 0, sizeof(dma_stats));
+
+    __HAL_GPIO_EXTI_CLEAR_IT(ADS1299_DRDY_Pin);
+    running = true;
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Ignore further DRDY edges; a frame in flight still completes
+ */
+void EMG_DMA_Stop(void)
+{
+    running = false;
+}
+
+/**
+ * @brief Snapshot of the acquisition counters
+ */
+void EMG_DMA_GetStats(EMG_DMA_Stats_t *stats)
+{
+    *stats = dma_stats;
+    stats->dropped_samples += unread_samples;
+}
+
+/**
+ * @brief DRDY falling edge: start the DMA read of one frame
+ * @note EXTI0 interrupt; a frame still in flight drops this sample
+ */
+void EMG_DRDY_IRQHandler(void)
+{
+    const uint32_t now = Profiler_Now();
+
+    if (!running) {
+        return;
+    }
+
+    if (frame_busy) {
+        dma_stats.drdy_overruns++;
+        dma_stats.dropped_samples++;
+        return;
+    }
+
+    frame_busy = true;
+    frame_cycles = now;
+    cs_low();
+
+    if (HAL_SPI_TransmitReceive_DMA(emg_spi, tx_zeros, raw_frames[fill_half][fill_index],
+                                    ADS1299_FRAME_BYTES) != HAL_OK) {
+        cs_high();
+        frame_busy = false;
+        dma_stats.spi_errors++;
+        dma_stats.dropped_samples++;
+    }
+}
+
+/**
+ * @brief Frame received: release CS, advance, signal a full half
+ * @note From HAL_SPI_TxRxCpltCallback for the ADS1299 SPI
+ */
+void EMG_SPI_TxRxCpltCallback(void)
+{
+    Half_Stamp_t *stamp = &half_stamp[fill_half];
+
+    cs_high();
+
+    if (fill_index == 0) {
+        stamp->first_cycles = frame_cycles;
+    }
+    stamp->last_cycles = frame_cycles;
+    dma_stats.samples++;
+
+    if (++fill_index >= EMG_DMA_BLOCK_SAMPLES) {
+        stamp->last_tick = HAL_GetTick();
+        fill_index = 0;
+
+        if (fill_half == 0) {
+            fill_half = 1;
+            EMG_DMA_HalfCompleteCallback();
+        } else {
+            fill_half = 0;
+            EMG_DMA_CompleteCallback();
+        }
+    }
+
+    frame_busy = false;
+}
+
+/**
+ * @brief Transfer error: the frame is lost, the next DRDY retries
+ */
+void EMG_SPI_ErrorCallback(void)
+{
+    cs_high();
+    dma_stats.spi_errors++;
+    dma_stats.dropped_samples++;
+    frame_busy = false;
+}
+
+/**
+ * @brief First half of the raw double buffer filled
+ */
+void EMG_DMA_HalfCompleteCallback(void)
+{
+    half_complete_from_isr();
+}
+
+/**
+ * @brief Second half of the raw double buffer filled
+ */
+void EMG_DMA_CompleteCallback(void)
+{
+    half_complete_from_isr();
+}
+
+/**
+ * @brief Decode the oldest completed half into a pool buffer
+ * @return HAL_OK with *buffer set, HAL_BUSY if nothing pending or no free buffer
+ */
+HAL_StatusTypeDef EMG_AcquireBuffer(EMG_Buffer_t **buffer)
+{
+    EMG_Buffer_t *out = take_free_buffer();
+
+    if (out == NULL) {
+        return HAL_BUSY;
+    }
+
+    for (;;) {
+        const uint32_t done = halves_done;
+
+        // Halves older than the latest completed one have been overwritten
+        if (done - halves_taken > 1U) {
+            unread_samples += (done - halves_taken - 1U) * EMG_DMA_BLOCK_SAMPLES;
+            halves_taken = done - 1U;
+        }
+
+        if (done == halves_taken) {
+            EMG_ReleaseBuffer(out);
+            return HAL_BUSY;
+        }
+
+        unpack_half((uint8_t)(halves_taken & 1U), out);
+
+        // Refilling of this slot starts when the next half completes
+        if (halves_done - halves_taken <= 1U) {
+            break;
+        }
+    }
+
+    halves_taken++;
+    *buffer = out;
+    return HAL_OK;
+}
+
+/**
+ * @brief Return a buffer obtained from EMG_AcquireBuffer
+ */
+void EMG_ReleaseBuffer(EMG_Buffer_t *buffer)
+{
+    if (buffer != NULL && buffer->buffer_id < EMG_BUFFER_POOL_SIZE) {
+        buffer_held[buffer->buffer_id] = false;
+    }
+}
+
+/**
+ * @brief Pool buffers not held by a consumer
+ */
+uint8_t EMG_GetFreeBufferCount(void)
+{
+    uint8_t free_count = 0;
+
+    for (uint8_t i = 0; i < EMG_BUFFER_POOL_SIZE; i++) {
+        if (!buffer_held[i]) {
+            free_count++;
+        }
+    }
+
+    return free_count;
+}
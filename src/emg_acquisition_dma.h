@@ -0,0 +1,50 @@
+/**
+ * @file emg_acquisition_dma.h
+ * @brief DRDY-triggered ADS1299 frame reads by SPI DMA
+ *
+ * The DRDY EXTI starts one full-duplex transfer per sample into a raw
+ * double buffer; the consumer task is notified only when a half of
+ * EMG_DMA_BLOCK_SAMPLES frames completes and takes it with
+ * EMG_AcquireBuffer (emg_acquisition.h). The EXTI, SPI and DMA interrupts
+ * must sit at or below configMAX_SYSCALL_INTERRUPT_PRIORITY.
+ */
+
+#ifndef EMG_ACQUISITION_DMA_H
+#define EMG_ACQUISITION_DMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm32h7xx_hal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "emg_acquisition.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    uint32_t samples;         // Frames read since EMG_DMA_Start
+    uint32_t blocks;          // Completed half-buffers
+    uint32_t dropped_samples; // Frames lost to overruns, SPI errors or unread halves
+    uint32_t drdy_overruns;   // DRDY while the previous frame was still in flight
+    uint32_t spi_errors;
+} EMG_DMA_Stats_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef EMG_DMA_Init(SPI_HandleTypeDef *hspi);   // After EMG_Init; SPI with RX/TX DMA linked
+HAL_StatusTypeDef EMG_DMA_Start(TaskHandle_t consumer);    // Before EMG_StartContinuous
+void EMG_DMA_Stop(void);
+void EMG_DMA_GetStats(EMG_DMA_Stats_t *stats);
+
+// Interrupt context: DRDY EXTI, SPI transfer complete/error
+void EMG_DRDY_IRQHandler(void);
+void EMG_SPI_TxRxCpltCallback(void);
+void EMG_SPI_ErrorCallback(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EMG_ACQUISITION_DMA_H */
@@ -0,0 +1,44 @@
+/**
+ * @file emg_config.h
+ * @brief Compile-time channel count, sample rate and feature capacity
+ *
+ * Every per-channel and per-feature array in the EMG driver, the DSP
+ * pipeline and the forest is dimensioned from these values, so a build
+ * for the 8-channel ADS1299 or a higher data rate resizes the buffers with
+ * no runtime cost. Override on the compiler command line, e.g.
+ * -DEMG_NUM_CHANNELS=8 -DEMG_SAMPLE_RATE_HZ=2000. RAM budgets are checked
+ * at compile time where the buffers are declared (main.c, scratch_arena.h).
+ */
+
+#ifndef EMG_CONFIG_H
+#define EMG_CONFIG_H
+
+/* Build configuration -------------------------------------------------------*/
+#ifndef EMG_NUM_CHANNELS
+#define EMG_NUM_CHANNELS        4       // ADS1299 inputs acquired, 1..8
+#endif
+
+#ifndef EMG_SAMPLE_RATE_HZ
+#define EMG_SAMPLE_RATE_HZ      1000U   // 1000, 2000 or 4000 (filter tables in dsp_filters.c)
+#endif
+
+// Feature vector capacity; the loaded model decides how many are used.
+// Scales the 30-slot layout of the 4-channel models with the channel count.
+#ifndef EMG_MAX_FEATURES
+#define EMG_MAX_FEATURES        ((EMG_NUM_CHANNELS * 15U) / 2U)
+#endif
+
+/* Checks --------------------------------------------------------------------*/
+#if EMG_NUM_CHANNELS < 1 || EMG_NUM_CHANNELS > 8
+#error "EMG_NUM_CHANNELS must be 1..8 (ADS1299)"
+#endif
+
+#if EMG_SAMPLE_RATE_HZ != 1000U && EMG_SAMPLE_RATE_HZ != 2000U && EMG_SAMPLE_RATE_HZ != 4000U
+#error "EMG_SAMPLE_RATE_HZ must be 1000, 2000 or 4000"
+#endif
+
+#if EMG_MAX_FEATURES < 1 || EMG_MAX_FEATURES > 255
+#error "EMG_MAX_FEATURES must fit the uint8_t n_features fields"
+#endif
+
+#endif /* EMG_CONFIG_H */
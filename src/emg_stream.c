@@ -0,0 +1,291 @@
+/**
+ * @file emg_stream.c
+ * @brief Binary EMG/feature/result frames over the debug UART
+ *
+ * Frames are built on the caller's stack and handed to Log_WriteFrame, so
+ * the DSP and ML tasks only pay for packing and the CRC. The frame layout
+ * is documented in emg_stream.h and read on the host by
+ * src/preprocessing/data_loader.py (read_emg_stream).
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "emg_stream.h"
+#include "debug_log.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define STREAM_HEADER_BYTES   4U      // SOF, LEN, TYPE
+#define STREAM_CRC_BYTES      2U
+#define STREAM_CHANNELS       EMG_NUM_CHANNELS
+#define STREAM_MAX_FEATURES   EMG_MAX_FEATURES
+
+#define STREAM_RAW_PAYLOAD    (6U + STREAM_SAMPLES_PER_FRAME * STREAM_CHANNELS * 3U)
+
+#if (STREAM_HEADER_BYTES + STREAM_RAW_PAYLOAD + STREAM_CRC_BYTES) > LOG_MAX_RECORD
+#error "Raw stream frame does not fit in one log record"
+#endif
+
+#if (STREAM_HEADER_BYTES + 6U + STREAM_MAX_FEATURES * 4U + STREAM_CRC_BYTES) > LOG_MAX_RECORD
+#error "Feature stream frame does not fit in one log record"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static volatile uint8_t stream_mask = 0;
+static uint32_t stream_sample_rate = EMG_SAMPLE_RATE_HZ;
+static uint8_t stream_gain = 24;
+static float stream_volts_per_code = 0.0f;
+static volatile uint32_t stream_last_status = 0;
+
+static Stream_Stats_t stream_stats;
+
+/* Private functions ---------------------------------------------------------*/
+static uint16_t crc16_ccitt(const uint8_t *data, uint32_t len)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x8000U) ? (uint16_t)((crc << 1) ^ 0x1021U) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+static inline uint8_t *put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static inline uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+// Fill SOF/LEN/TYPE, append the CRC and queue the frame
+static void frame_send(uint8_t *frame, uint8_t type, uint16_t payload_len)
+{
+    const uint32_t crc_pos = STREAM_HEADER_BYTES + payload_len;
+    uint16_t crc;
+
+    frame[0] = STREAM_SOF;
+    put_u16(&frame[1], payload_len);
+    frame[3] = type;
+
+    crc = crc16_ccitt(&frame[1], 3U + payload_len);
+    put_u16(&frame[crc_pos], crc);
+
+    if (Log_WriteFrame(frame, crc_pos + STREAM_CRC_BYTES)) {
+        __atomic_fetch_add(&stream_stats.frames_sent, 1U, __ATOMIC_RELAXED);
+    } else {
+        __atomic_fetch_add(&stream_stats.frames_dropped, 1U, __ATOMIC_RELAXED);
+    }
+}
+
+static void send_status(void)
+{
+    uint8_t frame[STREAM_HEADER_BYTES + 12U + STREAM_CRC_BYTES];
+    uint8_t *p = &frame[STREAM_HEADER_BYTES];
+
+    p = put_u32(p, stream_sample_rate);
+    *p++ = STREAM_CHANNELS;
+    *p++ = stream_mask;
+    *p++ = stream_gain;
+    *p++ = 0;
+    memcpy(p, &stream_volts_per_code, sizeof(float));
+
+    stream_last_status = HAL_GetTick();
+    frame_send(frame, STREAM_TYPE_STATUS, 12U);
+}
+
+static inline void status_if_due(void)
+{
+    if (HAL_GetTick() - stream_last_status >= STREAM_STATUS_PERIOD_MS) {
+        send_status();
+    }
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Enable the selected streams and announce the acquisition setup
+ * @param mask   STREAM_MASK_* bits
+ * @param config Current ADC configuration, for the STATUS frame
+ */
+HAL_StatusTypeDef Stream_Start(uint8_t mask, const EMG_Config_t *config)
+{
+    if (config == NULL || (mask & ~STREAM_MASK_ALL) != 0 || config->gain == 0) {
+        return HAL_ERROR;
+    }
+
+    memset(&stream_stats, 0, sizeof(stream_stats));
+    stream_sample_rate = config->sample_rate;
+    stream_gain = config->gain;
+    stream_volts_per_code = ADS1299_VREF / ((float)config->gain * ADS1299_FULL_SCALE_CODES);
+    stream_mask = mask;
+
+    send_status();
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Disable all streams
+ */
+void Stream_Stop(void)
+{
+    stream_mask = 0;
+}
+
+/**
+ * @brief True if any of the given streams is enabled
+ */
+bool Stream_IsEnabled(uint8_t mask)
+{
+    return (stream_mask & mask) != 0;
+}
+
+/**
+ * @brief UART baud rate the selected streams need at sample_rate
+ * @note Includes 25% headroom for text output and frame jitter
+ */
+uint32_t Stream_RequiredBaud(uint8_t mask, uint32_t sample_rate)
+{
+    const uint32_t overhead = STREAM_HEADER_BYTES + STREAM_CRC_BYTES;
+    uint32_t bytes_per_s = 0;
+
+    if (mask & STREAM_MASK_RAW) {
+        bytes_per_s += (sample_rate * (overhead + STREAM_RAW_PAYLOAD)) / STREAM_SAMPLES_PER_FRAME;
+    }
+
+    // One feature vector and one result per window; budget for 16 windows/s
+    if (mask & STREAM_MASK_FEATURE) {
+        bytes_per_s += 16U * (overhead + 6U + STREAM_MAX_FEATURES * 4U);
+    }
+
+    if (mask & STREAM_MASK_RESULT) {
+        bytes_per_s += 16U * (overhead + 9U);
+    }
+
+    // 10 bits per byte on the wire
+    return (bytes_per_s * 10U * 5U) / 4U;
+}
+
+/**
+ * @brief Stream one acquisition block as raw 24-bit codes
+ * @param first_index Running index of the block's first sample
+ */
+void Stream_SendRaw(const EMG_Buffer_t *buffer, uint32_t first_index)
+{
+    uint8_t frame[STREAM_HEADER_BYTES + STREAM_RAW_PAYLOAD + STREAM_CRC_BYTES];
+
+    if ((stream_mask & STREAM_MASK_RAW) == 0) {
+        return;
+    }
+
+    status_if_due();
+
+    for (uint16_t start = 0; start < buffer->n_samples; start += STREAM_SAMPLES_PER_FRAME) {
+        uint16_t n = buffer->n_samples - start;
+        uint8_t *p = &frame[STREAM_HEADER_BYTES];
+
+        if (n > STREAM_SAMPLES_PER_FRAME) {
+            n = STREAM_SAMPLES_PER_FRAME;
+        }
+
+        p = put_u32(p, first_index + start);
+        *p++ = STREAM_CHANNELS;
+        *p++ = (uint8_t)n;
+
+        for (uint16_t i = 0; i < n; i++) {
+            const int32_t *data = buffer->samples[start + i].data;
+
+            for (uint8_t ch = 0; ch < STREAM_CHANNELS; ch++) {
+                const uint32_t code = (uint32_t)data[ch];
+
+                *p++ = (uint8_t)code;
+                *p++ = (uint8_t)(code >> 8);
+                *p++ = (uint8_t)(code >> 16);
+            }
+        }
+
+        frame_send(frame, STREAM_TYPE_RAW, (uint16_t)(p - &frame[STREAM_HEADER_BYTES]));
+    }
+}
+
+/**
+ * @brief Stream the feature vector handed to the forest
+ * @param q_values Quantized features, or NULL to send f_values as float32
+ */
+void Stream_SendFeatures(uint32_t sample_index, const int16_t *q_values,
+                         const float *f_values, uint8_t n_features)
+{
+    uint8_t frame[STREAM_HEADER_BYTES + 6U + STREAM_MAX_FEATURES * 4U + STREAM_CRC_BYTES];
+    uint8_t *p = &frame[STREAM_HEADER_BYTES];
+
+    if ((stream_mask & STREAM_MASK_FEATURE) == 0) {
+        return;
+    }
+
+    if (n_features > STREAM_MAX_FEATURES) {
+        n_features = STREAM_MAX_FEATURES;
+    }
+
+    status_if_due();
+
+    p = put_u32(p, sample_index);
+    *p++ = n_features;
+
+    if (q_values != NULL) {
+        *p++ = STREAM_FEATURE_Q16;
+        for (uint8_t i = 0; i < n_features; i++) {
+            p = put_u16(p, (uint16_t)q_values[i]);
+        }
+    } else {
+        *p++ = STREAM_FEATURE_F32;
+        memcpy(p, f_values, 4U * n_features);  // Cortex-M is little-endian
+        p += 4U * n_features;
+    }
+
+    frame_send(frame, STREAM_TYPE_FEATURE, (uint16_t)(p - &frame[STREAM_HEADER_BYTES]));
+}
+
+/**
+ * @brief Stream one forest prediction and the voted gesture
+ */
+void Stream_SendResult(uint32_t sample_index, const RF_Result_t *result,
+                       uint8_t voted_class, uint8_t voted_confidence)
+{
+    uint8_t frame[STREAM_HEADER_BYTES + 9U + STREAM_CRC_BYTES];
+    uint8_t *p = &frame[STREAM_HEADER_BYTES];
+
+    if ((stream_mask & STREAM_MASK_RESULT) == 0) {
+        return;
+    }
+
+    status_if_due();
+
+    p = put_u32(p, sample_index);
+    *p++ = result->class_id;
+    *p++ = result->confidence;
+    *p++ = result->trees_evaluated;
+    *p++ = voted_class;
+    *p++ = voted_confidence;
+
+    frame_send(frame, STREAM_TYPE_RESULT, 9U);
+}
+
+/**
+ * @brief Snapshot of the stream counters
+ */
+void Stream_GetStats(Stream_Stats_t *stats)
+{
+    *stats = stream_stats;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file emg_stream.h
+ * @brief Framed binary streaming of raw EMG, features and predictions
+ */
+
+#ifndef EMG_STREAM_H
+#define EMG_STREAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32h7xx_hal.h"
+#include "emg_acquisition.h"
+#include "dsp_pipeline.h"
+#include "random_forest.h"
+
+/* Exported constants --------------------------------------------------------*/
+/*
+ * Frame: SOF (0xAA) | LEN (u16, payload bytes) | TYPE (u8) | PAYLOAD | CRC (u16)
+ * All fields little-endian. CRC is CRC-16/CCITT-FALSE over LEN, TYPE and
+ * PAYLOAD. Readers resynchronize on SOF and drop frames with a bad CRC.
+ *
+ * STATUS  u32 sample_rate, u8 n_channels, u8 stream_mask, u8 pga_gain,
+ *         u8 reserved, f32 volts_per_code
+ * RAW     u32 first sample index, u8 n_channels, u8 n_samples,
+ *         n_samples x n_channels x int24 (ADC codes)
+ * FEATURE u32 sample index of the window's last sample, u8 n_features,
+ *         u8 format, n_features x (f32 | Q int16 as sent to the forest)
+ * RESULT  u32 sample index, u8 class, u8 confidence, u8 trees_evaluated,
+ *         u8 voted class, u8 voted confidence
+ */
+#define STREAM_SOF                 0xAAU
+#define STREAM_TYPE_RAW            0x01U
+#define STREAM_TYPE_FEATURE        0x02U
+#define STREAM_TYPE_RESULT         0x03U
+#define STREAM_TYPE_STATUS         0x04U
+
+#define STREAM_FEATURE_F32         0U
+#define STREAM_FEATURE_Q16         1U
+
+#define STREAM_SAMPLES_PER_FRAME   (64U / EMG_NUM_CHANNELS)   // Raw frame <= 204 bytes, one log record
+#define STREAM_STATUS_PERIOD_MS    1000U   // STATUS repeat, for readers that attach late
+
+// Stream selection (EMG:STREAM arguments)
+#define STREAM_MASK_RAW            0x01U
+#define STREAM_MASK_FEATURE        0x02U
+#define STREAM_MASK_RESULT         0x04U
+#define STREAM_MASK_ALL            0x07U
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    uint32_t frames_sent;
+    uint32_t frames_dropped;  // Log ring full; the producer never waits
+} Stream_Stats_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+/*
+ * Frames are queued as single records on the debug log ring, so they go
+ * out by UART TX DMA without blocking the DSP or ML task and are never
+ * interleaved with text. Raw streaming at 1 kHz needs the rate returned by
+ * Stream_RequiredBaud; features and results alone fit at 115200.
+ */
+HAL_StatusTypeDef Stream_Start(uint8_t mask, const EMG_Config_t *config);
+void Stream_Stop(void);
+bool Stream_IsEnabled(uint8_t mask);
+uint32_t Stream_RequiredBaud(uint8_t mask, uint32_t sample_rate);
+void Stream_SendRaw(const EMG_Buffer_t *buffer, uint32_t first_index);
+void Stream_SendFeatures(uint32_t sample_index, const int16_t *q_values,
+                         const float *f_values, uint8_t n_features);
+void Stream_SendResult(uint32_t sample_index, const RF_Result_t *result,
+                       uint8_t voted_class, uint8_t voted_confidence);
+void Stream_GetStats(Stream_Stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EMG_STREAM_H */
@@ -0,0 +1,77 @@
+/**
+ * @file feature_mask.h
+ * @brief Bit set over feature vector indices
+ *
+ * The exporter emits one per model with the features that any split
+ * references; the DSP pipeline uses it to skip extractors whose outputs
+ * the deployed forest never reads.
+ */
+
+#ifndef FEATURE_MASK_H
+#define FEATURE_MASK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "emg_config.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define FEATURE_MASK_WORDS      ((EMG_MAX_FEATURES + 31U) / 32U)
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    uint32_t words[FEATURE_MASK_WORDS];   // Bit i of words[i / 32] = feature i
+} Feature_Mask_t;
+
+/* Exported functions --------------------------------------------------------*/
+static inline bool Feature_Mask_Test(const Feature_Mask_t *mask, uint8_t feature)
+{
+    return (mask->words[feature >> 5] >> (feature & 31U)) & 1U;
+}
+
+static inline void Feature_Mask_Set(Feature_Mask_t *mask, uint8_t feature)
+{
+    mask->words[feature >> 5] |= 1UL << (feature & 31U);
+}
+
+// Features 0 .. n_features-1
+static inline void Feature_Mask_SetAll(Feature_Mask_t *mask, uint8_t n_features)
+{
+    memset(mask, 0, sizeof(*mask));
+    for (uint8_t i = 0; i < n_features && i < EMG_MAX_FEATURES; i++) {
+        Feature_Mask_Set(mask, i);
+    }
+}
+
+// Copy a model's mask; models exported without one (NULL) use every feature
+static inline void Feature_Mask_FromModel(Feature_Mask_t *mask, const Feature_Mask_t *model_mask,
+                                          uint8_t n_features)
+{
+    if (model_mask != NULL) {
+        *mask = *model_mask;
+    } else {
+        Feature_Mask_SetAll(mask, n_features);
+    }
+}
+
+static inline uint8_t Feature_Mask_Count(const Feature_Mask_t *mask)
+{
+    uint8_t n = 0;
+
+    for (uint8_t w = 0; w < FEATURE_MASK_WORDS; w++) {
+        n += (uint8_t)__builtin_popcount(mask->words[w]);
+    }
+
+    return n;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FEATURE_MASK_H */
@@ -0,0 +1,176 @@
+/**
+ * @file ipc_ring.c
+ * @brief Shared-memory SPSC ring with hardware-semaphore wakeup
+ *
+ * The region is non-cacheable on the CM7 (memory_map.c) and the CM4 has
+ * no data cache, so both cores read the same bytes; the barriers only
+ * keep the slot copy and the index store in order. Full and empty tests
+ * use free-running 32-bit indices, so all n_slots slots are usable.
+ *
+ * A released semaphore interrupts every core that enabled its
+ * notification, and the HAL disables it again before the callback; the
+ * callback re-arms it. A release that lands in between is not lost: the
+ * consumer drains every slot it finds once it runs.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "ipc_ring.h"
+
+/* Private variables ---------------------------------------------------------*/
+static IPC_Ring_t *consumed_rings[IPC_MAX_RINGS];
+static uint8_t n_consumed;
+
+/* Private functions ---------------------------------------------------------*/
+static inline uint8_t *ring_slot(const IPC_Ring_t *ring, uint32_t index)
+{
+    return &ring->slots[(index & (ring->n_slots - 1U)) * (uint32_t)ring->slot_bytes];
+}
+
+static inline bool ring_empty(const IPC_Ring_t *ring)
+{
+    return ring->shared->head == ring->shared->tail;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Describe a ring at a fixed shared address (no shared write)
+ * @param n_slots    Power of two
+ * @param item_bytes Size of one item; slots are rounded up to words
+ * @return HAL_ERROR if the ring is misaligned or leaves the shared region
+ */
+HAL_StatusTypeDef IPC_Ring_Init(IPC_Ring_t *ring, uint32_t base, uint16_t n_slots,
+                                uint16_t item_bytes, uint32_t hsem_id)
+{
+    if (n_slots == 0 || (n_slots & (n_slots - 1U)) != 0 || item_bytes == 0 || hsem_id >= 32U ||
+        (base % IPC_LINE_BYTES) != 0 || base < MEM_SHARED_REGION_BASE ||
+        base + IPC_RING_BYTES(n_slots, item_bytes) > MEM_SHARED_REGION_BASE + MEM_SHARED_REGION_SIZE) {
+        return HAL_ERROR;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    ring->shared = (IPC_RingShared_t *)base;
+    ring->slots = (uint8_t *)(base + sizeof(IPC_RingShared_t));
+    ring->n_slots = n_slots;
+    ring->item_bytes = item_bytes;
+    ring->slot_bytes = (uint16_t)IPC_SLOT_BYTES(item_bytes);
+    ring->hsem_id = hsem_id;
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Empty the ring; SRAM4 holds garbage after power-up
+ * @note Only while neither side is using it, i.e. before the other core runs
+ */
+void IPC_Ring_Reset(IPC_Ring_t *ring)
+{
+    ring->shared->head = 0;
+    ring->shared->tail = 0;
+    ring->full = 0;
+    __DSB();
+}
+
+/**
+ * @brief Copy one item into the ring and wake the consumer core
+ * @return false if the ring is full (counted in ring->full)
+ */
+bool IPC_Ring_Push(IPC_Ring_t *ring, const void *item)
+{
+    const uint32_t head = ring->shared->head;
+
+    if (head - ring->shared->tail >= ring->n_slots) {
+        ring->full++;
+        return false;
+    }
+
+    memcpy(ring_slot(ring, head), item, ring->item_bytes);
+
+    // Slot contents before the index that publishes them
+    __DMB();
+    ring->shared->head = head + 1U;
+    __DSB();
+
+    // Release raises the consumer core's HSEM interrupt
+    if (HAL_HSEM_FastTake(ring->hsem_id) == HAL_OK) {
+        HAL_HSEM_Release(ring->hsem_id, 0);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Register the task that pops this ring and arm its wakeup
+ * @return HAL_ERROR when IPC_MAX_RINGS rings already have a consumer here
+ */
+HAL_StatusTypeDef IPC_Ring_SetConsumer(IPC_Ring_t *ring, TaskHandle_t task)
+{
+    if (n_consumed >= IPC_MAX_RINGS) {
+        return HAL_ERROR;
+    }
+
+    ring->consumer = task;
+    consumed_rings[n_consumed++] = ring;
+    HAL_HSEM_ActivateNotification(__HAL_HSEM_SEMID_TO_MASK(ring->hsem_id));
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Copy the oldest item out and free its slot
+ * @return false if the ring is empty
+ */
+bool IPC_Ring_Pop(IPC_Ring_t *ring, void *item)
+{
+    const uint32_t tail = ring->shared->tail;
+
+    if (ring->shared->head == tail) {
+        return false;
+    }
+
+    // Index before the slot it published, slot read before it is freed
+    __DMB();
+    memcpy(item, ring_slot(ring, tail), ring->item_bytes);
+    __DMB();
+    ring->shared->tail = tail + 1U;
+
+    return true;
+}
+
+/**
+ * @brief Sleep the consumer task until the ring holds an item
+ * @return false on timeout
+ */
+bool IPC_Ring_Wait(IPC_Ring_t *ring, TickType_t timeout)
+{
+    if (!ring_empty(ring)) {
+        return true;
+    }
+
+    (void)ulTaskNotifyTake(pdTRUE, timeout);
+
+    return !ring_empty(ring);
+}
+
+/**
+ * @brief Wake the consumers of the released semaphores (interrupt context)
+ */
+void IPC_HSEM_FreeCallback(uint32_t sem_mask)
+{
+    BaseType_t woken = pdFALSE;
+
+    for (uint8_t i = 0; i < n_consumed; i++) {
+        IPC_Ring_t *ring = consumed_rings[i];
+        const uint32_t mask = __HAL_HSEM_SEMID_TO_MASK(ring->hsem_id);
+
+        if ((sem_mask & mask) != 0) {
+            HAL_HSEM_ActivateNotification(mask);
+            if (ring->consumer != NULL) {
+                vTaskNotifyGiveFromISR(ring->consumer, &woken);
+            }
+        }
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
@@ -0,0 +1,87 @@
+/**
+ * @file ipc_ring.h
+ * @brief Lock-free single-producer, single-consumer ring between the CM7
+ *        and CM4 in shared SRAM
+ *
+ * A ring is a control block (head and tail on separate 32-byte lines)
+ * followed by n_slots fixed-size slots, at an address both images agree
+ * on; IPC_RING_BYTES gives its footprint. Only the producer writes head
+ * and only the consumer writes tail, so neither side ever takes a lock:
+ * a barrier orders the slot copy before the index update. After a push
+ * the producer takes and releases the ring's hardware semaphore, which
+ * interrupts the other core and wakes the consumer task.
+ *
+ * The HSEM interrupt must sit at or below
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY; main.c routes HAL_HSEM_FreeCallback
+ * to IPC_HSEM_FreeCallback.
+ */
+
+#ifndef IPC_RING_H
+#define IPC_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32h7xx_hal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "memory_map.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define IPC_MAX_RINGS           4U      // Rings one core may consume
+#define IPC_LINE_BYTES          32U     // Head and tail never share a line
+
+/* Exported types ------------------------------------------------------------*/
+// Shared control block; free-running indices, slot = index % n_slots
+typedef struct {
+    volatile uint32_t head;   // Next slot to write (producer)
+    uint8_t reserved0[IPC_LINE_BYTES - sizeof(uint32_t)];
+    volatile uint32_t tail;   // Next slot to read (consumer)
+    uint8_t reserved1[IPC_LINE_BYTES - sizeof(uint32_t)];
+} IPC_RingShared_t;
+
+// Per-core view of one ring
+typedef struct {
+    IPC_RingShared_t *shared;
+    uint8_t *slots;
+    uint16_t n_slots;         // Power of two
+    uint16_t item_bytes;
+    uint16_t slot_bytes;      // item_bytes rounded up to words
+    uint32_t hsem_id;         // Notification semaphore, one per ring
+    TaskHandle_t consumer;    // Set by IPC_Ring_SetConsumer
+    uint32_t full;            // Pushes refused for lack of space (producer side)
+} IPC_Ring_t;
+
+/* Exported macro ------------------------------------------------------------*/
+#define IPC_SLOT_BYTES(item)            (((uint32_t)(item) + 3U) & ~3U)
+// Rounded up to a line, so rings laid out back to back stay aligned
+#define IPC_RING_BYTES(n_slots, item) \
+    ((sizeof(IPC_RingShared_t) + (uint32_t)(n_slots) * IPC_SLOT_BYTES(item) + \
+      IPC_LINE_BYTES - 1U) & ~(IPC_LINE_BYTES - 1U))
+
+/* Exported functions prototypes ---------------------------------------------*/
+// Both cores, same arguments; base inside the shared region, 32-byte aligned
+HAL_StatusTypeDef IPC_Ring_Init(IPC_Ring_t *ring, uint32_t base, uint16_t n_slots,
+                                uint16_t item_bytes, uint32_t hsem_id);
+void IPC_Ring_Reset(IPC_Ring_t *ring);       // Primary core, before the other core starts
+
+// Producer side
+bool IPC_Ring_Push(IPC_Ring_t *ring, const void *item);   // false if full
+
+// Consumer side
+HAL_StatusTypeDef IPC_Ring_SetConsumer(IPC_Ring_t *ring, TaskHandle_t task);
+bool IPC_Ring_Pop(IPC_Ring_t *ring, void *item);          // false if empty
+bool IPC_Ring_Wait(IPC_Ring_t *ring, TickType_t timeout); // true once not empty
+
+// Interrupt context: from HAL_HSEM_FreeCallback
+void IPC_HSEM_FreeCallback(uint32_t sem_mask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IPC_RING_H */
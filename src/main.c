@@ -6,9 +6,15 @@
  * 
  * This implements a real-time sEMG-based gesture recognition system
  * for Turkish Sign Language using Random Forest classification.
+ *
+ * With DUAL_CORE=1 (memory_map.h) the same file builds two images: the
+ * CM7 runs acquisition, DSP, the debug UART and the monitor, the CM4
+ * runs inference and the servos. Feature messages go over one shared
+ * ring and ML reports come back over another (ipc_ring.h).
  */
 
 /* Includes ------------------------------------------------------------------*/
+#include <string.h>
 #include "main.h"
 #include "stm32h7xx_hal.h"
 #include "FreeRTOS.h"
@@ -17,35 +23,290 @@
 #include "semphr.h"
 
 #include "emg_acquisition.h"
+#include "emg_acquisition_dma.h"
 #include "dsp_pipeline.h"
 #include "random_forest.h"
 #include "servo_control.h"
 #include "system_monitor.h"
+#include "profiler.h"
+#include "debug_log.h"
+#include "debug_cmd.h"
+#include "emg_stream.h"
+#include "memory_map.h"
+#include "scratch_arena.h"
+#include "accelerometer.h"
+#include "activity_gate.h"
+#include "model_slot.h"
+#if DUAL_CORE
+#include "ipc_ring.h"
+#endif
+#if defined(BENCHMARK_MODE) && BENCHMARK_MODE
+#include "emg_benchmark.h"   // Needs src/benchmarking on the include path
+#endif
+
+#if RF_INFERENCE_ENGINE == RF_ENGINE_FLAT
+#include "rf_model_flat.h"   // Generated by export_to_c_header(..., layout="flat")
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_CODEGEN
+#include "rf_model_code.h"   // Generated by export_to_c_header(..., layout="code")
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_COMPACT
+#include "rf_model_compact.h"   // Generated by export_to_c_header(..., layout="compact")
+#endif
 
 /* Private defines -----------------------------------------------------------*/
 #define SYSTEM_CORE_CLOCK   280000000U  // 280 MHz
-#define EMG_SAMPLE_RATE     1000U        // 1 kHz
+#define EMG_SAMPLE_RATE     EMG_SAMPLE_RATE_HZ  // emg_config.h
 #define WINDOW_SIZE         256U         // 256 samples
-#define WINDOW_OVERLAP      128U         // 50% overlap
+#ifndef WINDOW_HOP
+#define WINDOW_HOP          128U         // New samples per window (128 = 50% overlap)
+#endif
+#ifndef DEBUG_UART_BAUDRATE
+#define DEBUG_UART_BAUDRATE 115200U      // EMG:STREAM RAW needs 230400 or more
+#endif
+#ifndef BENCHMARK_MODE
+#define BENCHMARK_MODE      0            // 1 = run the kernel benchmark at boot instead of the tasks
+#endif
+
+// Task stacks in words; every kernel object is statically allocated
+#define DSP_TASK_STACK      512U         // Context, window and block live outside the stack
+#define ML_TASK_STACK       768U
+#define SERVO_TASK_STACK    512U
+#define MONITOR_TASK_STACK  512U
+#define FEATURE_QUEUE_LENGTH 4U         // Also the most vectors one ML wakeup batches
+#define RELAY_TASK_STACK    384U         // DUAL_CORE: applies CM4 reports on the CM7
+#define RESULT_RING_SLOTS   16U          // DUAL_CORE: reports in flight, CM4 to CM7
+
+// This image's share of the pipeline; both in single-core builds
+#if DUAL_CORE && defined(CORE_CM4)
+#define APP_DSP_CORE        0
+#else
+#define APP_DSP_CORE        1
+#endif
+#if DUAL_CORE && defined(CORE_CM7)
+#define APP_ML_CORE         0
+#else
+#define APP_ML_CORE         1
+#endif
+
+#if DUAL_CORE
+// Hardware semaphores: CM4 release at boot, then one wakeup per ring
+#define HSEM_ID_BOOT        0U
+#define HSEM_ID_FEATURES    1U
+#define HSEM_ID_RESULTS     2U
+#define CORE_BOOT_TIMEOUT   0xFFFFU      // D2 clock ready polls
+#endif
+
+#if !configSUPPORT_STATIC_ALLOCATION
+#error "configSUPPORT_STATIC_ALLOCATION must be 1 in FreeRTOSConfig.h"
+#endif
+
+#if DSP_QUANTIZED_FEATURES && (RF_INFERENCE_ENGINE == RF_ENGINE_NODES)
+#error "DSP_QUANTIZED_FEATURES needs a folded flat, codegen or compact model"
+#endif
+
+#if DUAL_CORE && MODEL_SLOTS
+#error "MODEL_SLOTS is not supported with DUAL_CORE (messages carry model pointers)"
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+// Item carried by featureQueue (or the feature ring): features plus the
+// window's latency trace. DUAL_CORE images must agree on its layout.
+typedef struct {
+#if DSP_QUANTIZED_FEATURES
+    Feature_VectorQ_t features;
+#else
+    Feature_Vector_t features;
+#endif
+    Latency_Trace_t trace;
+    uint32_t sample_index;    // Running index of the window's newest sample
+#if MODEL_SLOTS
+    const RF_FlatModel_t *model;  // Model the features were extracted for
+#endif
+} Feature_Message_t;
+
+// ML outcome applied on the DSP core, directly or over the result ring
+typedef struct {
+    uint32_t sample_index;    // Newest sample of the classified window
+    RF_Result_t result;       // Forest vote of that window
+    uint8_t gesture;          // Smoothed class and confidence
+    uint8_t confidence;
+    uint8_t n_batch;          // 0: one window; else summary of an n_batch inference
+    uint8_t n_dropped;        // Non-zero: only this many windows dropped by the ML task
+    uint32_t batch_cycles;    // Summary: ML core cycles for the batch
+    uint32_t batch_us;
+} ML_Report_t;
+
+// Scratch region layouts; a stage owns its region for one block/inference
+typedef struct {
+    float volts[EMG_BUFFER_SAMPLES][EMG_NUM_CHANNELS];   // Filtered block from DSP_PreprocessBuffer
+#if DSP_QUANTIZED_FEATURES
+    Feature_Vector_t features;            // Float features before quantization
+#endif
+} DSP_Scratch_t;
+
+typedef struct {
+    Feature_Message_t batch[FEATURE_QUEUE_LENGTH];      // Drained from featureQueue
+    const fixed_point_t *inputs[FEATURE_QUEUE_LENGTH];
+#if !DSP_QUANTIZED_FEATURES
+    fixed_point_t normalized[FEATURE_QUEUE_LENGTH][RF_MAX_FEATURES];
+#endif
+    RF_Vote_t votes[FEATURE_QUEUE_LENGTH];
+    RF_Result_t results[FEATURE_QUEUE_LENGTH];
+#if MODEL_SLOTS
+    bool dropped[FEATURE_QUEUE_LENGTH];   // Extracted for a model the engine refused
+#endif
+} ML_Scratch_t;
+
+SCRATCH_ASSERT_FITS(DSP_Scratch_t, SCRATCH_DSP_SIZE);
+SCRATCH_ASSERT_FITS(ML_Scratch_t, SCRATCH_ML_SIZE);
+_Static_assert(FEATURE_QUEUE_LENGTH <= RF_MAX_BATCH, "FEATURE_QUEUE_LENGTH exceeds RF_MAX_BATCH");
 
 /* Private variables ---------------------------------------------------------*/
 // HAL handles
+#if APP_DSP_CORE
 static SPI_HandleTypeDef hspi1;      // For ADS1299
 static I2C_HandleTypeDef hi2c1;      // For LIS3DH
-static TIM_HandleTypeDef htim1;      // For servo PWM
 static UART_HandleTypeDef huart3;    // For debug
+static DMA_HandleTypeDef hdma_usart3_tx;  // Debug log TX
+static DMA_HandleTypeDef hdma_usart3_rx;  // Debug command RX
+static DMA_HandleTypeDef hdma_spi1_rx;    // ADS1299 frame RX
+static DMA_HandleTypeDef hdma_spi1_tx;    // ADS1299 frame clocking
+#if DSP_USE_FMAC
+static FMAC_HandleTypeDef hfmac;          // Notch filter accelerator
+static DMA_HandleTypeDef hdma_fmac_in;    // Channel row into the FMAC
+static DMA_HandleTypeDef hdma_fmac_out;   // Filtered row out
+#endif
+#endif
+#if APP_ML_CORE
+static TIM_HandleTypeDef htim1;      // For servo PWM
+#endif
 
-// FreeRTOS handles
-static TaskHandle_t emgTaskHandle;
+// FreeRTOS handles and kernel object storage (xTaskCreateStatic/xQueueCreateStatic)
+#if APP_DSP_CORE
 static TaskHandle_t dspTaskHandle;
+static TaskHandle_t monitorTaskHandle;
+static StaticTask_t dspTaskTcb, monitorTaskTcb;
+static StackType_t dspTaskStack[DSP_TASK_STACK];
+static StackType_t monitorTaskStack[MONITOR_TASK_STACK];
+#endif
+#if APP_ML_CORE
 static TaskHandle_t mlTaskHandle;
 static TaskHandle_t servoTaskHandle;
-static TaskHandle_t monitorTaskHandle;
+static StaticTask_t mlTaskTcb, servoTaskTcb;
+static StackType_t mlTaskStack[ML_TASK_STACK];
+static StackType_t servoTaskStack[SERVO_TASK_STACK];
+#endif
+#if DUAL_CORE && APP_DSP_CORE
+static TaskHandle_t relayTaskHandle;
+static StaticTask_t relayTaskTcb;
+static StackType_t relayTaskStack[RELAY_TASK_STACK];
+#endif
+static StaticTask_t idleTaskTcb;
+static StackType_t idleTaskStack[configMINIMAL_STACK_SIZE];
+#if configUSE_TIMERS
+static StaticTask_t timerTaskTcb;
+static StackType_t timerTaskStack[configTIMER_TASK_STACK_DEPTH];
+#endif
 
-static QueueHandle_t emgDataQueue;
+#if DUAL_CORE
+// Rings at fixed SRAM4 offsets, the same in both images; the CM7 empties
+// them before it releases the CM4
+#define FEATURE_RING_BASE   MEM_SHARED_REGION_BASE
+#define RESULT_RING_BASE    (FEATURE_RING_BASE + IPC_RING_BYTES(FEATURE_QUEUE_LENGTH, sizeof(Feature_Message_t)))
+#define SHARED_RING_END     (RESULT_RING_BASE + IPC_RING_BYTES(RESULT_RING_SLOTS, sizeof(ML_Report_t)))
+
+_Static_assert(SHARED_RING_END <= MEM_SHARED_REGION_BASE + MEM_SHARED_REGION_SIZE,
+               "Shared rings exceed MEM_SHARED_REGION_SIZE");
+
+static IPC_Ring_t feature_ring;   // CM7 DSP -> CM4 ML
+static IPC_Ring_t result_ring;    // CM4 ML -> CM7 relay
+#else
 static QueueHandle_t featureQueue;
-static SemaphoreHandle_t emgReadySem;
+static StaticQueue_t featureQueueBuffer;
+static uint8_t featureQueueStorage[FEATURE_QUEUE_LENGTH * sizeof(Feature_Message_t)];
+#endif
+
+#if APP_DSP_CORE
+// DSP working set in DTCM: context (filter state, FFT scratch) and the
+// sliding analysis window (8 KB); the filtered block is in the DSP scratch region
+DTCM_BSS static DSP_Context_t dsp_ctx;
+DTCM_BSS static DSP_SlidingWindow_t dsp_window;
+#endif
+
+// Static RAM owned by main.c, reported by SYS:MEM?
+typedef struct {
+    const char *name;
+    uint32_t bytes;
+} Memory_BudgetItem_t;
+
+#define TASK_BYTES(stack_words)  ((stack_words) * sizeof(StackType_t) + sizeof(StaticTask_t))
+
+#if APP_DSP_CORE
+static const Memory_BudgetItem_t memory_budget[] = {
+    { "DSP_Proc",     TASK_BYTES(DSP_TASK_STACK) },
+#if DUAL_CORE
+    { "ML_Relay",     TASK_BYTES(RELAY_TASK_STACK) },
+#else
+    { "ML_Infer",     TASK_BYTES(ML_TASK_STACK) },
+    { "Servo",        TASK_BYTES(SERVO_TASK_STACK) },
+#endif
+    { "Monitor",      TASK_BYTES(MONITOR_TASK_STACK) },
+    { "Idle/Timer",   sizeof(idleTaskTcb) + sizeof(idleTaskStack)
+#if configUSE_TIMERS
+                      + sizeof(timerTaskTcb) + sizeof(timerTaskStack)
+#endif
+    },
+#if !DUAL_CORE
+    { "Queues",       sizeof(featureQueueBuffer) + sizeof(featureQueueStorage) },
+#endif
+    { "DSP context",  sizeof(DSP_Context_t) + sizeof(DSP_SlidingWindow_t) },
+    { "Scratch",      SCRATCH_IMAGE_BYTES },
+};
+#endif
+
+#if configUSE_TIMERS
+#define TIMER_TASK_BYTES  TASK_BYTES(configTIMER_TASK_STACK_DEPTH)
+#else
+#define TIMER_TASK_BYTES  0U
+#endif
+
+// Per image: each core checks only what it links (shared rings are in SRAM4)
+#if !DUAL_CORE
+#define CORE_TASK_BYTES   (TASK_BYTES(DSP_TASK_STACK) + TASK_BYTES(ML_TASK_STACK) + \
+                           TASK_BYTES(SERVO_TASK_STACK) + TASK_BYTES(MONITOR_TASK_STACK))
+#define CORE_DATA_BYTES   (sizeof(StaticQueue_t) + FEATURE_QUEUE_LENGTH * sizeof(Feature_Message_t) + \
+                           sizeof(DSP_Context_t) + sizeof(DSP_SlidingWindow_t))
+#elif APP_DSP_CORE
+#define CORE_TASK_BYTES   (TASK_BYTES(DSP_TASK_STACK) + TASK_BYTES(RELAY_TASK_STACK) + \
+                           TASK_BYTES(MONITOR_TASK_STACK))
+#define CORE_DATA_BYTES   (sizeof(DSP_Context_t) + sizeof(DSP_SlidingWindow_t))
+#else
+#define CORE_TASK_BYTES   (TASK_BYTES(ML_TASK_STACK) + TASK_BYTES(SERVO_TASK_STACK))
+#define CORE_DATA_BYTES   0U
+#endif
+
+#define MEMORY_BUDGET_TOTAL \
+    (CORE_TASK_BYTES + TASK_BYTES(configMINIMAL_STACK_SIZE) + TIMER_TASK_BYTES + \
+     CORE_DATA_BYTES + SCRATCH_IMAGE_BYTES)
 
+_Static_assert(MEMORY_BUDGET_TOTAL <= STATIC_RAM_BUDGET, "Static RAM exceeds STATIC_RAM_BUDGET");
+
+#if APP_DSP_CORE && DSP_QUANTIZED_FEATURES
+static const float *feature_qscale;  // Folded normalization from the model
+#endif
+
+#if APP_ML_CORE
+// Trace of the gesture last notified to the servo task (critical section)
+static Latency_Trace_t servo_trace;
+
+// Stop the tree loop once the forest majority is decided
+static const RF_EarlyExit_t rf_early_exit = {
+    .enabled = true,
+    .min_trees = 5,
+    .min_confidence = 0     // Majority test only; class identical to a full vote
+};
+#endif
+
+#if APP_DSP_CORE
 // Global system state
 static System_State_t system_state = {
     .mode = MODE_IDLE,
@@ -53,43 +314,107 @@ static System_State_t system_state = {
     .battery_voltage = 0.0f,
     .temperature = 25.0f
 };
+#endif
 
 /* Private function prototypes -----------------------------------------------*/
+#if APP_DSP_CORE
 static void SystemClock_Config(void);
 static void GPIO_Init(void);
 static void SPI1_Init(void);
 static void I2C1_Init(void);
-static void TIM1_Init(void);
 static void UART3_Init(void);
+#if DSP_USE_FMAC
+static void FMAC_Init(void);
+#endif
+#endif
+#if APP_ML_CORE
+static void TIM1_Init(void);
+#endif
 static void Error_Handler(void);
 
+#if DUAL_CORE
+// Boot handshake and shared rings
+#if APP_DSP_CORE
+static void Core_WaitForSecondaryStop(void);
+static void Core_StartSecondary(void);
+#else
+static void Core_WaitForPrimary(void);
+#endif
+static HAL_StatusTypeDef Core_InitRings(void);
+#endif
+
 // FreeRTOS tasks
-static void EMG_AcquisitionTask(void *pvParameters);
+#if APP_DSP_CORE
 static void DSP_ProcessingTask(void *pvParameters);
+static void System_MonitorTask(void *pvParameters);
+#endif
+#if APP_ML_CORE
 static void ML_InferenceTask(void *pvParameters);
 static void Servo_ControlTask(void *pvParameters);
-static void System_MonitorTask(void *pvParameters);
+#endif
+#if DUAL_CORE && APP_DSP_CORE
+static void ML_RelayTask(void *pvParameters);
+#endif
 
 /* Main function -------------------------------------------------------------*/
 int main(void)
 {
+#if APP_DSP_CORE
+    // Load ITCM code and DTCM data before anything runs from them
+    Memory_InitSections();
+    
     // HAL initialization
     HAL_Init();
     
+#if DUAL_CORE
+    // The CM4 parks itself in Stop; clocks change only once it is there
+    Core_WaitForSecondaryStop();
+#endif
+    
     // Configure system clock (280 MHz)
     SystemClock_Config();
     
+    // DMA buffers (and the inter-core region) become non-cacheable before
+    // any transfer or the D-cache
+    if (Memory_ConfigureMPU() != HAL_OK) {
+        Error_Handler();
+    }
+    
     // Initialize peripherals
     GPIO_Init();
     SPI1_Init();
     I2C1_Init();
+#if !DUAL_CORE
     TIM1_Init();
+#endif
     UART3_Init();
+#if DSP_USE_FMAC
+    FMAC_Init();
+#endif
+    
+    // printf goes through the DMA log ring from here on
+    if (Log_Init(&huart3) != HAL_OK) {
+        Error_Handler();
+    }
+    
+    if (Cmd_Init(&huart3) != HAL_OK) {
+        Error_Handler();
+    }
     
     // Enable caches for performance
     SCB_EnableICache();
     SCB_EnableDCache();
+#else
+    // Sleep until the CM7 has set up clocks, pins and the shared rings
+    Core_WaitForPrimary();
+    HAL_Init();
+    TIM1_Init();
+#endif
+    
+    // Start the DWT cycle counter used for timing statistics (per core)
+    Profiler_Init();
     
+#if APP_DSP_CORE
     // Initialize debug console
     printf("\r\n=== sEMG Hand Prosthesis System ===\r\n");
     printf("Firmware Version: 1.0.0\r\n");
@@ -102,40 +427,180 @@ int main(void)
         Error_Handler();
     }
     
+    // DRDY-triggered frame reads into the raw double buffer
+    if (EMG_DMA_Init(&hspi1) != HAL_OK) {
+        printf("ERROR: EMG DMA initialization failed!\r\n");
+        Error_Handler();
+    }
+    
     if (ACC_Init(&hi2c1) != HAL_OK) {
         printf("ERROR: Accelerometer initialization failed!\r\n");
         Error_Handler();
     }
     
+    // Rest/activity gating of the DSP and ML rate
+    Activity_Init();
+#endif
+    
+#if APP_ML_CORE
     if (Servo_Init(&htim1) != HAL_OK) {
         printf("ERROR: Servo initialization failed!\r\n");
         Error_Handler();
     }
     
+    // Trajectory engine runs on the TIM1 update event (one per PWM frame)
+    HAL_NVIC_SetPriority(TIM1_UP_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(TIM1_UP_IRQn);
+    if (HAL_TIM_Base_Start_IT(&htim1) != HAL_OK) {
+        printf("ERROR: Servo update interrupt failed!\r\n");
+        Error_Handler();
+    }
+#endif
+    
+    // Both cores load the model: the DSP core for its feature mask and
+    // folded scales, the ML core to run it
     // Load Random Forest model from Flash
     if (RF_LoadModel() != HAL_OK) {
         printf("ERROR: ML model loading failed!\r\n");
         Error_Handler();
     }
     
+#if MODEL_SLOTS
+    // Newest valid A/B flash slot, else the compiled-in flat model
+    if (ModelSlot_Init(&rf_model_flat) != HAL_OK) {
+        printf("ERROR: Flat ML model loading failed!\r\n");
+        Error_Handler();
+    }
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_FLAT
+    // Flattened trees; normalization still comes from the loaded model
+    if (RF_FlatLoadModel(&rf_model_flat) != HAL_OK) {
+        printf("ERROR: Flat ML model loading failed!\r\n");
+        Error_Handler();
+    }
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_CODEGEN
+    // Generated tree functions; normalization still comes from the loaded model
+    if (RF_CodeLoadModel(&rf_model_code) != HAL_OK) {
+        printf("ERROR: Generated ML model loading failed!\r\n");
+        Error_Handler();
+    }
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_COMPACT
+    // Compact trees; normalization still comes from the loaded model
+    if (RF_CompactLoadModel(&rf_model_compact) != HAL_OK) {
+        printf("ERROR: Compact ML model loading failed!\r\n");
+        Error_Handler();
+    }
+#endif
+    
+#if APP_DSP_CORE && (MODEL_SLOTS || RF_INFERENCE_ENGINE != RF_ENGINE_NODES)
+    // Thresholds are Q8.8 or in the quantized feature domain (folded); the
+    // DSP task must send features in the same one, as model_slot.c checks
+    {
+#if MODEL_SLOTS
+        const float *model_qscale = ModelSlot_Current()->feature_qscale;
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_FLAT
+        const float *model_qscale = rf_model_flat.feature_qscale;
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_CODEGEN
+        const float *model_qscale = rf_model_code.feature_qscale;
+#else
+        const float *model_qscale = rf_model_compact.feature_qscale;
+#endif
+#if DSP_QUANTIZED_FEATURES
+        if (model_qscale == NULL) {
+            printf("ERROR: Model was exported without folded normalization!\r\n");
+            Error_Handler();
+        }
+        feature_qscale = model_qscale;
+#else
+        if (model_qscale != NULL) {
+            printf("ERROR: Folded model needs DSP_QUANTIZED_FEATURES=1!\r\n");
+            Error_Handler();
+        }
+#endif
+    }
+#endif
+    
     printf("Hardware initialization complete.\r\n");
     
-    // Create FreeRTOS objects
-    emgDataQueue = xQueueCreate(4, sizeof(EMG_Buffer_t));
-    featureQueue = xQueueCreate(2, sizeof(Feature_Vector_t));
-    emgReadySem = xSemaphoreCreateBinary();
+#if BENCHMARK_MODE && APP_DSP_CORE
+    // Kernel benchmark over recorded windows, results on the debug UART
+#if DSP_QUANTIZED_FEATURES
+    Bench_RunAll(feature_qscale);
+#else
+    Bench_RunAll(NULL);
+#endif
+    while (1) {
+    }
+#endif
+    
+    // Create FreeRTOS objects in static storage; nothing comes from the heap
+#if DUAL_CORE
+    if (Core_InitRings() != HAL_OK || Scratch_Init() != HAL_OK) {
+#else
+    featureQueue = xQueueCreateStatic(FEATURE_QUEUE_LENGTH, sizeof(Feature_Message_t),
+                                      featureQueueStorage, &featureQueueBuffer);
     
-    if (emgDataQueue == NULL || featureQueue == NULL || emgReadySem == NULL) {
+    if (featureQueue == NULL || Scratch_Init() != HAL_OK) {
+#endif
         printf("ERROR: FreeRTOS object creation failed!\r\n");
         Error_Handler();
     }
     
-    // Create tasks with appropriate priorities
-    xTaskCreate(EMG_AcquisitionTask, "EMG_Acq", 512, NULL, 5, &emgTaskHandle);
-    xTaskCreate(DSP_ProcessingTask, "DSP_Proc", 1024, NULL, 4, &dspTaskHandle);
-    xTaskCreate(ML_InferenceTask, "ML_Infer", 768, NULL, 3, &mlTaskHandle);
-    xTaskCreate(Servo_ControlTask, "Servo", 512, NULL, 2, &servoTaskHandle);
-    xTaskCreate(System_MonitorTask, "Monitor", 512, NULL, 1, &monitorTaskHandle);
+    // Create tasks with appropriate priorities; acquisition runs in interrupts
+#if APP_DSP_CORE
+    dspTaskHandle = xTaskCreateStatic(DSP_ProcessingTask, "DSP_Proc", DSP_TASK_STACK, NULL, 4,
+                                      dspTaskStack, &dspTaskTcb);
+#endif
+#if APP_ML_CORE
+    mlTaskHandle = xTaskCreateStatic(ML_InferenceTask, "ML_Infer", ML_TASK_STACK, NULL, 3,
+                                     mlTaskStack, &mlTaskTcb);
+    servoTaskHandle = xTaskCreateStatic(Servo_ControlTask, "Servo", SERVO_TASK_STACK, NULL, 2,
+                                        servoTaskStack, &servoTaskTcb);
+#endif
+#if DUAL_CORE && APP_DSP_CORE
+    relayTaskHandle = xTaskCreateStatic(ML_RelayTask, "ML_Relay", RELAY_TASK_STACK, NULL, 3,
+                                        relayTaskStack, &relayTaskTcb);
+#endif
+#if APP_DSP_CORE
+    monitorTaskHandle = xTaskCreateStatic(System_MonitorTask, "Monitor", MONITOR_TASK_STACK, NULL, 1,
+                                          monitorTaskStack, &monitorTaskTcb);
+#endif
+    
+#if DUAL_CORE
+    // Each core wakes only for the ring it consumes
+#if APP_DSP_CORE
+    if (IPC_Ring_SetConsumer(&result_ring, relayTaskHandle) != HAL_OK) {
+        Error_Handler();
+    }
+    HAL_NVIC_SetPriority(HSEM1_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(HSEM1_IRQn);
+#else
+    if (IPC_Ring_SetConsumer(&feature_ring, mlTaskHandle) != HAL_OK) {
+        Error_Handler();
+    }
+    HAL_NVIC_SetPriority(HSEM2_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(HSEM2_IRQn);
+#endif
+#endif
+    
+    {
+        Feature_Mask_t used_features;
+        uint8_t n_features = 0;
+        
+        // Engines that do not report a mask leave every feature selected
+        Feature_Mask_SetAll(&used_features, EMG_MAX_FEATURES);
+        if (RF_GET_MODEL_INFO(NULL, &n_features, NULL, &used_features) == HAL_OK) {
+            printf("Model features used: %lu of %lu\r\n",
+                   (uint32_t)Feature_Mask_Count(&used_features), (uint32_t)n_features);
+        }
+    }
+    
+    printf("Static RAM: %lu of %lu bytes\r\n",
+           (uint32_t)MEMORY_BUDGET_TOTAL, (uint32_t)STATIC_RAM_BUDGET);
+    
+#if DUAL_CORE && APP_DSP_CORE
+    // Rings are empty and both ends will exist: let the CM4 run
+    Core_StartSecondary();
+#endif
     
     printf("Starting FreeRTOS scheduler...\r\n");
     
@@ -148,193 +613,729 @@ int main(void)
     }
 }
 
-/* Task Implementations ------------------------------------------------------*/
+/* Feature and report transport ---------------------------------------------*/
+
+#if APP_DSP_CORE
+// Never blocks; false when inference has fallen a batch behind
+static bool Feature_Send(const Feature_Message_t *msg)
+{
+#if DUAL_CORE
+    return IPC_Ring_Push(&feature_ring, msg);
+#else
+    return xQueueSend(featureQueue, msg, 0) == pdTRUE;
+#endif
+}
 
 /**
- * @brief EMG Data Acquisition Task
- * @note Runs at 1 kHz, highest priority
+ * @brief Apply one ML report: result stream, system state, statistics
+ * @note Runs in the ML task, or in the relay task on the CM7 (DUAL_CORE)
  */
-static void EMG_AcquisitionTask(void *pvParameters)
+static void ML_ApplyReport(const ML_Report_t *report)
 {
-    EMG_Buffer_t emg_buffer;
-    uint32_t sample_count = 0;
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    
-    // Configure DMA for continuous acquisition
-    EMG_StartContinuous();
+    if (report->n_dropped != 0) {
+        taskENTER_CRITICAL();   // The DSP task counts here too
+        system_state.stats.dropped_windows += report->n_dropped;
+        taskEXIT_CRITICAL();
+        return;
+    }
     
-    while (1) {
-        // Wait for DMA half/full complete interrupt
-        if (xSemaphoreTake(emgReadySem, pdMS_TO_TICKS(10)) == pdTRUE) {
-            
-            // Read latest samples from DMA buffer
-            EMG_ReadBuffer(&emg_buffer);
-            
-            // Send to DSP task
-            if (xQueueSend(emgDataQueue, &emg_buffer, 0) != pdTRUE) {
-                // Queue full, data dropped
-                system_state.stats.dropped_samples++;
-            }
-            
-            sample_count++;
-            
-            // Update statistics every second
-            if (sample_count >= EMG_SAMPLE_RATE) {
-                system_state.stats.emg_sample_rate = sample_count;
-                sample_count = 0;
-            }
-        }
+    if (report->n_batch == 0) {
+        Stream_SendResult(report->sample_index, &report->result, report->gesture, report->confidence);
         
-        // Maintain 1ms period
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(1));
+        if (report->confidence > 70) {
+            system_state.current_gesture = report->gesture;
+            system_state.gesture_confidence = report->confidence;
+        }
+        return;
+    }
+    
+    // Update statistics (per wakeup, i.e. per batch)
+#if DUAL_CORE
+    // CM4 cycles mean nothing to the CM7 monitor; rescale from us
+    Monitor_RecordInference(report->batch_us * (SystemCoreClock / 1000000U));
+#else
+    Monitor_RecordInference(report->batch_cycles);
+#endif
+    system_state.stats.ml_inference_time = report->batch_us;
+    system_state.stats.total_predictions += report->n_batch;
+    system_state.stats.trees_evaluated = report->result.trees_evaluated;
+    if (report->n_batch > system_state.stats.max_batch) {
+        system_state.stats.max_batch = report->n_batch;
+    }
+    
+    // Debug output
+    if (system_state.debug_enabled) {
+        LOG_DEFERRED(LOG_FMT_GESTURE, report->gesture, report->confidence,
+                     report->result.trees_evaluated, report->batch_us);
     }
 }
+#endif
 
+#if APP_ML_CORE
+// First message waits up to timeout (0: poll)
+static bool Feature_Receive(Feature_Message_t *msg, TickType_t timeout)
+{
+#if DUAL_CORE
+    if (timeout != 0 && !IPC_Ring_Wait(&feature_ring, timeout)) {
+        return false;
+    }
+    return IPC_Ring_Pop(&feature_ring, msg);
+#else
+    return xQueueReceive(featureQueue, msg, timeout) == pdTRUE;
+#endif
+}
+
+// A full result ring drops the report (counted in result_ring.full)
+static void ML_Publish(const ML_Report_t *report)
+{
+#if DUAL_CORE
+    (void)IPC_Ring_Push(&result_ring, report);
+#else
+    ML_ApplyReport(report);
+#endif
+}
+#endif
+
+/* Task Implementations ------------------------------------------------------*/
+
+#if APP_DSP_CORE
 /**
  * @brief DSP Processing Task
  * @note Processes windows of EMG data and extracts features
  */
 static void DSP_ProcessingTask(void *pvParameters)
 {
-    EMG_Buffer_t emg_buffer;
-    Feature_Vector_t features;
-    DSP_Context_t dsp_ctx;
+    EMG_Buffer_t *emg_buffer;
+    DSP_Scratch_t *scratch;
+    Feature_Message_t msg;
+    EMG_Config_t emg_config;
+    const uint32_t sample_period = SystemCoreClock / EMG_SAMPLE_RATE;  // Cycles between DRDYs
+    uint32_t sample_index = 0;  // Samples received since boot, for the stream
+    EMG_DMA_Stats_t emg_stats;
+    uint32_t lost_samples = 0;  // Decoded but never filtered
+    uint32_t rate_samples = 0;
+    uint32_t rate_since = HAL_GetTick();
+    Feature_Mask_t used_features;
+    
+    // Initialize DSP context and the spectral band edges
+    if (DSP_Init(&dsp_ctx) != HAL_OK || DSP_InitSpectralBands(&dsp_ctx) != HAL_OK) {
+        Error_Handler();
+    }
+#if DSP_USE_FMAC
+    // Notch on the FMAC; the CPU path stays in place as the fallback
+    if (DSP_FMAC_Init(&dsp_ctx, &hfmac) != HAL_OK) {
+        printf("WARNING: FMAC unavailable, filtering on the CPU\r\n");
+        dsp_ctx.fmac_failed = true;
+    }
+#endif
+    
+    // Extract only the features the loaded forest reads; engines that do
+    // not report a mask leave every feature selected
+    Feature_Mask_SetAll(&used_features, EMG_MAX_FEATURES);
+    if (RF_GET_MODEL_INFO(NULL, NULL, NULL, &used_features) == HAL_OK) {
+        DSP_SetFeatureMask(&dsp_ctx, &used_features);
+    }
+#if MODEL_SLOTS
+    msg.model = ModelSlot_Current();
+#endif
+    
+    // Convert and filter at block arrival; windows only see clean data
+    EMG_GetConfig(&emg_config);
+    DSP_SetChannelGains(&dsp_ctx, &emg_config);
+    dsp_ctx.prefiltered = true;
     
-    // Initialize DSP context
-    DSP_Init(&dsp_ctx);
+    // Sliding window advancing by WINDOW_HOP samples
+    if (DSP_Window_Init(&dsp_window, WINDOW_HOP) != HAL_OK) {
+        Error_Handler();
+    }
     
-    // Sliding window buffer
-    float window_buffer[WINDOW_SIZE][4];  // 4 channels
-    uint16_t window_idx = 0;
+    // Time-domain features from running sums, O(hop) per window
+    dsp_ctx.td_incremental = true;
+    DSP_ResyncTimeDomainFeatures(&dsp_ctx, &dsp_window);
+    
+    // Frames arrive by DRDY-triggered DMA; this task wakes once per half-buffer
+    if (EMG_DMA_Start(xTaskGetCurrentTaskHandle()) != HAL_OK || EMG_StartContinuous() != HAL_OK) {
+        Error_Handler();
+    }
     
     while (1) {
-        // Wait for EMG data
-        if (xQueueReceive(emgDataQueue, &emg_buffer, portMAX_DELAY) == pdTRUE) {
+#if MODEL_SLOTS
+        // An upload erases and programs the flash bank the DRDY/DMA handlers
+        // run from; ignore frames meanwhile rather than drop them at random
+        if (ModelSlot_HoldAcquisition(false)) {
+            EMG_DMA_Stop();
+            EMG_DMA_GetStats(&emg_stats);
+            lost_samples += emg_stats.dropped_samples;   // EMG_DMA_Start clears them
+            vTaskDelay(1);                               // A frame in flight completes
+            
+            while (ModelSlot_HoldAcquisition(true)) {
+                vTaskDelay(pdMS_TO_TICKS(10));
+            }
+            
+            // Resume with no history across the gap
+            DSP_Reset(&dsp_ctx);
+            if (DSP_Window_Init(&dsp_window, WINDOW_HOP) != HAL_OK ||
+                EMG_DMA_Start(xTaskGetCurrentTaskHandle()) != HAL_OK) {
+                Error_Handler();
+            }
+            DSP_ResyncTimeDomainFeatures(&dsp_ctx, &dsp_window);
+            continue;
+        }
+#endif
+        uint32_t acquire_start = Profiler_Now();
+        
+        // Take the next completed half, or sleep until one completes
+        if (EMG_AcquireBuffer(&emg_buffer) != HAL_OK) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        Profiler_Record(PROF_ACQUISITION, Profiler_Now() - acquire_start);
+        
+        uint32_t received_cycles = Profiler_Now();
+        uint32_t drdy_last = emg_buffer->drdy_cycles;
+        uint16_t n_samples = emg_buffer->n_samples;
+        
+#if MODEL_SLOTS
+        // Adopt an uploaded or selected model between blocks; every window
+        // from here on is extracted and stamped for it
+        {
+            const RF_FlatModel_t *next = ModelSlot_TakePending();
             
-            // Add samples to sliding window
-            for (uint16_t i = 0; i < emg_buffer.n_samples; i++) {
-                for (uint8_t ch = 0; ch < 4; ch++) {
-                    window_buffer[window_idx][ch] = 
-                        EMG_ConvertToVoltage(emg_buffer.samples[i].data[ch]);
+            if (next != NULL) {
+                Feature_Mask_FromModel(&used_features, next->feature_mask, next->n_features);
+                DSP_SetFeatureMask(&dsp_ctx, &used_features);
+#if DSP_QUANTIZED_FEATURES
+                feature_qscale = next->feature_qscale;
+#endif
+                msg.model = next;
+            }
+        }
+#endif
+        
+        // Block temporaries; the DSP region is never shared with an inference
+        scratch = Scratch_Acquire(SCRATCH_OWNER_DSP, sizeof(DSP_Scratch_t));
+        if (scratch == NULL) {
+            EMG_ReleaseBuffer(emg_buffer);
+            lost_samples += n_samples;
+            continue;
+        }
+        
+        // Convert to volts and filter once per sample
+        PROFILE_BEGIN(PROF_PREPROCESS);
+        DSP_KERNEL_PREPROCESS(&dsp_ctx, emg_buffer, scratch->volts);
+        PROFILE_END(PROF_PREPROCESS);
+        
+        // Muscle activity restores full rate before this block's windows
+        Activity_UpdateEmg((const float (*)[EMG_NUM_CHANNELS])scratch->volts, n_samples);
+        
+        // Raw codes go out before the buffer returns to the pool
+        Stream_SendRaw(emg_buffer, sample_index);
+        EMG_ReleaseBuffer(emg_buffer);
+        
+        // Add samples to sliding window
+        for (uint16_t i = 0; i < n_samples; i++) {
+            // Process window once WINDOW_HOP new samples have arrived
+            if (DSP_PushSample(&dsp_ctx, &dsp_window, scratch->volts[i])) {
+                // At rest only every ACTIVITY_LOW_RATE_DIVIDER-th window is evaluated
+                if (!Activity_ShouldProcessWindow()) {
+                    continue;
                 }
                 
-                window_idx++;
+                uint32_t start_cycles = Profiler_Now();
+                
+                // Extract features directly from the ring (no shift)
+                PROFILE_BEGIN(PROF_FEATURES);
+#if DSP_QUANTIZED_FEATURES
+                DSP_ExtractFeatures(&dsp_ctx, DSP_Window_Data(&dsp_window), &scratch->features);
+                DSP_QuantizeFeatures(&scratch->features, feature_qscale, &msg.features);
+#else
+                DSP_ExtractFeatures(&dsp_ctx, DSP_Window_Data(&dsp_window), &msg.features);
+#endif
+                PROFILE_END(PROF_FEATURES);
+                
+                // Latency origin is the DRDY of the sample completing this window
+                msg.trace.origin = drdy_last - (uint32_t)(n_samples - 1U - i) * sample_period;
+                msg.trace.dsp_start = received_cycles;
+                msg.trace.dsp_end = Profiler_Now();
+                msg.sample_index = sample_index + i;
+                
+#if DSP_QUANTIZED_FEATURES
+                Stream_SendFeatures(msg.sample_index, msg.features.values, NULL, msg.features.n_features);
+#else
+                Stream_SendFeatures(msg.sample_index, NULL, msg.features.values, msg.features.n_features);
+#endif
                 
-                // Process complete window with 50% overlap
-                if (window_idx >= WINDOW_SIZE) {
-                    uint32_t start_tick = HAL_GetTick();
-                    
-                    // Extract features
-                    DSP_ExtractFeatures(&dsp_ctx, window_buffer, &features);
-                    
-                    // Send to ML task
-                    xQueueSend(featureQueue, &features, 0);
-                    
-                    // Shift window by 50% (128 samples)
-                    memmove(window_buffer, &window_buffer[WINDOW_OVERLAP], 
-                           WINDOW_OVERLAP * 4 * sizeof(float));
-                    window_idx = WINDOW_OVERLAP;
-                    
-                    // Update timing statistics
-                    system_state.stats.dsp_processing_time = HAL_GetTick() - start_tick;
+                // Send to ML task; a full queue means inference fell a batch behind
+                if (!Feature_Send(&msg)) {
+                    system_state.stats.dropped_windows++;
                 }
+                
+                // Update timing statistics
+                uint32_t cycles = Profiler_Now() - start_cycles;
+                Profiler_Record(PROF_DSP_TOTAL, cycles);
+                Monitor_RecordDSPProcessing(cycles);
+                system_state.stats.dsp_processing_time = Profiler_CyclesToUs(cycles);
             }
         }
+        
+        Scratch_Release(SCRATCH_OWNER_DSP);
+        sample_index += n_samples;
+        
+        // Rate and drops are counted per sample, not per wakeup
+        rate_samples += n_samples;
+        uint32_t elapsed_ms = HAL_GetTick() - rate_since;
+        if (elapsed_ms >= 1000U) {
+            system_state.stats.emg_sample_rate = rate_samples * 1000U / elapsed_ms;
+            rate_samples = 0;
+            rate_since += elapsed_ms;
+        }
+        EMG_DMA_GetStats(&emg_stats);
+        system_state.stats.dropped_samples = emg_stats.dropped_samples + lost_samples;
     }
 }
+#endif
 
+#if APP_ML_CORE
 /**
  * @brief Machine Learning Inference Task
  * @note Runs Random Forest classifier and voting
  */
 static void ML_InferenceTask(void *pvParameters)
 {
-    Feature_Vector_t features;
-    VotingBuffer_t voting_buffer = {0};
-    uint8_t gesture_class;
-    uint8_t confidence;
+    Feature_Message_t first;
+    ML_Scratch_t *scratch;
+    RF_Smooth_t smoother;
+    ML_Report_t report;
+    uint8_t gesture_class = 0;
+    uint8_t final_confidence = 0;
+    uint8_t n_batch;
+#if MODEL_SLOTS
+    const RF_FlatModel_t *ml_model = ModelSlot_Current();   // Loaded in the flat engine
+#endif
+    
+    RF_Smooth_Init(&smoother);
     
     while (1) {
-        // Wait for feature vector
-        if (xQueueReceive(featureQueue, &features, portMAX_DELAY) == pdTRUE) {
-            uint32_t start_tick = HAL_GetTick();
+        // Wait for a feature vector, then take all others already queued
+        if (Feature_Receive(&first, portMAX_DELAY)) {
+            uint32_t start_cycles = Profiler_Now();
             
-            // Run Random Forest inference
-            uint8_t prediction = RF_Predict(features.values, &confidence);
-            
-            // Add to voting buffer
-            Voting_AddPrediction(&voting_buffer, prediction, confidence);
+            scratch = Scratch_Acquire(SCRATCH_OWNER_ML, sizeof(ML_Scratch_t));
+            if (scratch == NULL) {
+                // Nowhere to batch: drop this vector and the ones queued
+                // behind it, counted where the statistics live
+                memset(&report, 0, sizeof(report));
+                report.n_dropped = 1;
+                while (report.n_dropped < FEATURE_QUEUE_LENGTH && Feature_Receive(&first, 0)) {
+                    report.n_dropped++;
+                }
+                ML_Publish(&report);
+                continue;
+            }
             
-            // Get majority vote
-            uint8_t final_confidence;
-            gesture_class = Voting_GetMajority(&voting_buffer, &final_confidence);
+            scratch->batch[0] = first;
+            n_batch = 1;
+            while (n_batch < FEATURE_QUEUE_LENGTH && Feature_Receive(&scratch->batch[n_batch], 0)) {
+                n_batch++;
+            }
             
-            // Update gesture if confidence is sufficient
-            if (final_confidence > 70) {
-                system_state.current_gesture = gesture_class;
-                system_state.gesture_confidence = final_confidence;
+            for (uint8_t v = 0; v < n_batch; v++) {
+                Feature_Message_t *msg = &scratch->batch[v];
                 
-                // Notify servo task
-                xTaskNotify(servoTaskHandle, gesture_class, eSetValueWithOverwrite);
+                msg->trace.ml_start = start_cycles;
+#if DSP_QUANTIZED_FEATURES
+                // Thresholds already include normalization
+                scratch->inputs[v] = msg->features.values;
+#else
+                RF_NormalizeFeatures(msg->features.values, scratch->normalized[v], msg->features.n_features);
+                scratch->inputs[v] = scratch->normalized[v];
+#endif
             }
             
-            // Update statistics
-            system_state.stats.ml_inference_time = HAL_GetTick() - start_tick;
-            system_state.stats.total_predictions++;
+            // One pass over the trees for the whole batch
+            PROFILE_BEGIN(PROF_TREES);
+#if MODEL_SLOTS
+            // Split at model changes; the engine switches only between runs
+            for (uint8_t run = 0; run < n_batch; ) {
+                const RF_FlatModel_t *model = scratch->batch[run].model;
+                uint8_t run_end = run + 1U;
+                
+                while (run_end < n_batch && scratch->batch[run_end].model == model) {
+                    run_end++;
+                }
+                
+                if (model != ml_model) {
+                    if (RF_FlatLoadModel(model) == HAL_OK) {
+                        ml_model = model;
+                        ModelSlot_SetRunning(model);
+                        // Old smoothing history may use other class labels
+                        RF_Smooth_Init(&smoother);
+                    } else {
+                        // The DSP task goes back to ml_model; its mask no longer matches
+                        ModelSlot_Reject(model);
+                    }
+                }
+                
+                for (uint8_t v = run; v < run_end; v++) {
+                    scratch->dropped[v] = (model != ml_model);
+                }
+                if (model == ml_model) {
+                    RF_PREDICT_BATCH(&scratch->inputs[run], run_end - run, &rf_early_exit,
+                                     &scratch->votes[run], &scratch->results[run]);
+                }
+                run = run_end;
+            }
+#else
+            RF_PREDICT_BATCH(scratch->inputs, n_batch, &rf_early_exit, scratch->votes, scratch->results);
+#endif
+            PROFILE_END(PROF_TREES);
             
-            // Debug output
-            if (system_state.debug_enabled) {
-                printf("Gesture: %d, Confidence: %d%%, Time: %lums\r\n",
-                       gesture_class, final_confidence, 
-                       system_state.stats.ml_inference_time);
+            // Vote in window order
+            for (uint8_t v = 0; v < n_batch; v++) {
+                Feature_Message_t *msg = &scratch->batch[v];
+                const RF_Result_t *result = &scratch->results[v];
+                
+#if MODEL_SLOTS
+                // Never classified by a model it was not extracted for
+                if (scratch->dropped[v]) {
+                    taskENTER_CRITICAL();   // The DSP task counts here too
+                    system_state.stats.dropped_windows++;
+                    taskEXIT_CRITICAL();
+                    continue;
+                }
+#endif
+                PROFILE_BEGIN(PROF_VOTING);
+                // Per-class shares where the engine leaves its tallies
+                RF_Smooth_Add(&smoother, result, RF_PREDICT_BATCH_TALLIES ? &scratch->votes[v] : NULL);
+                gesture_class = RF_Smooth_GetResult(&smoother, &final_confidence);
+                PROFILE_END(PROF_VOTING);
+                
+                report.sample_index = msg->sample_index;
+                report.result = *result;
+                report.gesture = gesture_class;
+                report.confidence = final_confidence;
+                report.n_batch = 0;
+                report.n_dropped = 0;
+                ML_Publish(&report);
+                
+                // Update gesture if confidence is sufficient
+                if (final_confidence > 70) {
+                    // Hand the trace over with the gesture, then notify servo task
+                    msg->trace.ml_end = Profiler_Now();
+                    taskENTER_CRITICAL();
+                    servo_trace = msg->trace;
+                    taskEXIT_CRITICAL();
+                    xTaskNotify(servoTaskHandle, gesture_class, eSetValueWithOverwrite);
+                }
             }
+            
+            Scratch_Release(SCRATCH_OWNER_ML);
+            
+            // Batch summary; report still holds the last window's vote
+            uint32_t cycles = Profiler_Now() - start_cycles;
+            Profiler_Record(PROF_ML_TOTAL, cycles);
+            report.n_batch = n_batch;
+            report.n_dropped = 0;
+            report.batch_cycles = cycles;
+            report.batch_us = Profiler_CyclesToUs(cycles);
+            ML_Publish(&report);
         }
     }
 }
 
 /**
  * @brief Servo Control Task
- * @note Updates servo positions based on recognized gestures
+ * @note Hands recognized gestures to the trajectory engine, which moves
+ *       the servos from the TIM1 update interrupt
  */
 static void Servo_ControlTask(void *pvParameters)
 {
     uint32_t gesture_class;
-    uint8_t current_positions[6] = {90, 90, 90, 90, 90, 90};  // Center position
-    uint8_t target_positions[6];
+    uint32_t move_start;
+    Latency_Trace_t trace;
+    bool trace_pending = false;
     
     while (1) {
         // Wait for gesture notification
-        if (xTaskNotifyWait(0, 0xFFFFFFFF, &gesture_class, pdMS_TO_TICKS(20)) == pdTRUE) {
+        if (xTaskNotifyWait(0, 0xFFFFFFFF, &gesture_class, pdMS_TO_TICKS(SERVO_UPDATE_PERIOD_MS)) == pdTRUE) {
             
-            // Look up target positions for gesture
-            Servo_GetGesturePositions(gesture_class, target_positions);
+            taskENTER_CRITICAL();
+            trace = servo_trace;
+            taskEXIT_CRITICAL();
             
-            // Smooth transition to new positions
-            for (uint8_t step = 0; step < 10; step++) {
-                for (uint8_t servo = 0; servo < 6; servo++) {
-                    // Linear interpolation
-                    int16_t delta = target_positions[servo] - current_positions[servo];
-                    current_positions[servo] += delta / 10;
-                    
-                    // Update servo
-                    Servo_SetAngle(servo, current_positions[servo]);
-                }
-                
-                // 20ms per step = 200ms total transition
-                vTaskDelay(pdMS_TO_TICKS(20));
+            // Retargets at the next PWM frame, even mid-transition
+            if (Servo_MoveToGesture((uint8_t)gesture_class, 0) == HAL_OK) {
+                trace_pending = true;
             }
-            
-            // Final position update
-            memcpy(current_positions, target_positions, 6);
-        } else {
-            // No new gesture, maintain current position
-            // This also serves as the PWM refresh cycle
-            for (uint8_t servo = 0; servo < 6; servo++) {
-                Servo_SetAngle(servo, current_positions[servo]);
+        }
+        
+        // First PWM update for the gesture ends its latency trace; the
+        // cores' cycle counters are unrelated, so only on a single core
+        if (trace_pending && Servo_GetLastMoveStart(&move_start)) {
+#if !DUAL_CORE
+            Monitor_RecordLatency(&trace, move_start);
+#else
+            (void)trace;
+#endif
+            trace_pending = false;
+        }
+    }
+}
+#endif
+
+#if DUAL_CORE && APP_DSP_CORE
+/**
+ * @brief ML Report Relay Task
+ * @note Applies the CM4's results and batch summaries on the CM7, where the
+ *       UART, stream and system state live
+ */
+static void ML_RelayTask(void *pvParameters)
+{
+    ML_Report_t report;
+    
+    while (1) {
+        if (IPC_Ring_Wait(&result_ring, portMAX_DELAY)) {
+            while (IPC_Ring_Pop(&result_ring, &report)) {
+                ML_ApplyReport(&report);
             }
         }
     }
 }
+#endif
+
+#if APP_DSP_CORE
+/* Debug commands ------------------------------------------------------------*/
+
+static void Command_SysInfo(const char *args)
+{
+    Log_Stats_t log_stats;
+    Cmd_Stats_t cmd_stats;
+    Stream_Stats_t stream_stats;
+    uint32_t itcm_bytes, dtcm_bytes, dma_bytes;
+    
+    (void)args;
+    Log_GetStats(&log_stats);
+    Cmd_GetStats(&cmd_stats);
+    
+    printf("\r\n=== System Information ===\r\n");
+    printf("Uptime: %lu seconds\r\n", HAL_GetTick() / 1000);
+    printf("EMG Sample Rate: %lu Hz\r\n", system_state.stats.emg_sample_rate);
+    printf("DSP Time: %lu us\r\n", system_state.stats.dsp_processing_time);
+    printf("ML Time: %lu us\r\n", system_state.stats.ml_inference_time);
+    printf("Total Predictions: %lu\r\n", system_state.stats.total_predictions);
+    printf("Trees Evaluated: %lu\r\n", system_state.stats.trees_evaluated);
+    printf("Dropped Windows: %lu (max batch %lu)\r\n",
+           system_state.stats.dropped_windows, system_state.stats.max_batch);
+    printf("Current Gesture: %d (%d%%)\r\n", 
+           system_state.current_gesture, 
+           system_state.gesture_confidence);
+    printf("Battery: %.2f V\r\n", system_state.battery_voltage);
+    printf("Temperature: %.1f C\r\n", system_state.temperature);
+#if configSUPPORT_DYNAMIC_ALLOCATION
+    // Only with a heap_N.c linked, whose heap lies outside MEMORY_BUDGET_TOTAL
+    printf("Free Heap: %d bytes\r\n", xPortGetFreeHeapSize());
+#endif
+    Memory_GetUsage(&itcm_bytes, &dtcm_bytes, &dma_bytes);
+    printf("ITCM/DTCM/DMA: %lu/%lu/%lu bytes\r\n", itcm_bytes, dtcm_bytes, dma_bytes);
+    printf("Log Dropped: %lu records, %lu bytes on TX error\r\n",
+           log_stats.records_dropped, log_stats.bytes_dropped);
+    printf("Cmd RX Overruns: %lu bytes\r\n", cmd_stats.overruns);
+    printf("Cmd RX Errors: %lu (%lu bytes dropped)\r\n", cmd_stats.line_errors, cmd_stats.error_bytes);
+    Stream_GetStats(&stream_stats);
+    printf("Stream Frames: %lu sent, %lu dropped\r\n",
+           stream_stats.frames_sent, stream_stats.frames_dropped);
+}
+
+static void Command_SysProf(const char *args)
+{
+    (void)args;
+    printf("\r\n=== Profiler (us) ===\r\n");
+    for (uint8_t p = 0; p < PROF_NUM_PROBES; p++) {
+        Profiler_Stats_t prof;
+        Profiler_GetStats((Profiler_Probe_t)p, &prof);
+        printf("%-12s n=%lu min=%lu avg=%lu max=%lu p99=%lu\r\n",
+               Profiler_GetProbeName((Profiler_Probe_t)p), prof.count,
+               Profiler_CyclesToUs(prof.min_cycles),
+               Profiler_CyclesToUs(prof.avg_cycles),
+               Profiler_CyclesToUs(prof.max_cycles),
+               Profiler_CyclesToUs(prof.p99_cycles));
+    }
+}
+
+static void Command_SysProfReset(const char *args)
+{
+    (void)args;
+    Profiler_Reset();
+    printf("Profiler statistics cleared.\r\n");
+}
+
+static void Command_SysLat(const char *args)
+{
+    (void)args;
+    Monitor_PrintLatencyReport();
+}
+
+static void Command_SysLatReset(const char *args)
+{
+    (void)args;
+    Monitor_ResetLatency();
+    printf("Latency statistics cleared.\r\n");
+}
+
+static void Command_SysMem(const char *args)
+{
+    Scratch_Stats_t scratch;
+    uint32_t total = 0;
+    
+    (void)args;
+    printf("\r\n=== Static Memory (bytes) ===\r\n");
+    for (uint8_t i = 0; i < sizeof(memory_budget) / sizeof(memory_budget[0]); i++) {
+        printf("%-14s %lu\r\n", memory_budget[i].name, memory_budget[i].bytes);
+        total += memory_budget[i].bytes;
+    }
+    printf("%-14s %lu of %lu\r\n", "Total", total, (uint32_t)STATIC_RAM_BUDGET);
+    
+    Scratch_GetStats(&scratch);
+    printf("Scratch peak: DSP %lu of %lu, ML %lu of %lu\r\n",
+           scratch.peak_bytes[SCRATCH_OWNER_DSP], scratch.capacity[SCRATCH_OWNER_DSP],
+           scratch.peak_bytes[SCRATCH_OWNER_ML], scratch.capacity[SCRATCH_OWNER_ML]);
+    printf("Scratch failures: %lu\r\n", scratch.failed);
+#if DUAL_CORE
+    printf("Stack free (words): DSP %lu, relay %lu\r\n",
+           (uint32_t)uxTaskGetStackHighWaterMark(dspTaskHandle),
+           (uint32_t)uxTaskGetStackHighWaterMark(relayTaskHandle));
+    printf("Ring full: features %lu\r\n", feature_ring.full);
+#else
+    printf("Stack free (words): DSP %lu, ML %lu\r\n",
+           (uint32_t)uxTaskGetStackHighWaterMark(dspTaskHandle),
+           (uint32_t)uxTaskGetStackHighWaterMark(mlTaskHandle));
+#endif
+}
+
+static void Command_SysPower(const char *args)
+{
+    Activity_Stats_t activity;
+    
+    (void)args;
+    Activity_GetStats(&activity);
+    printf("\r\n=== Activity Gate ===\r\n");
+    printf("Mode: %s\r\n", activity.mode == ACTIVITY_LOW_RATE ? "LOW RATE" : "FULL RATE");
+    printf("Low-rate: %lu entries, %lu s total\r\n",
+           activity.low_rate_entries, activity.low_rate_ms / 1000);
+    printf("Wakeups: %lu EMG, %lu motion\r\n", activity.emg_wakeups, activity.motion_wakeups);
+    printf("Windows skipped: %lu\r\n", activity.windows_skipped);
+}
+
+static void Command_SysPowerGate(const char *args)
+{
+    if (strcmp(args, "ON") == 0) {
+        Activity_SetEnabled(true);
+    } else if (strcmp(args, "OFF") == 0) {
+        Activity_SetEnabled(false);
+    } else {
+        printf("ERR usage: SYS:POWER:GATE ON|OFF\r\n");
+        return;
+    }
+    printf("Activity gating %s.\r\n", args);
+}
+
+static void Command_EmgStart(const char *args)
+{
+    (void)args;
+    system_state.mode = MODE_ACTIVE;
+    printf("EMG acquisition started.\r\n");
+}
+
+static void Command_EmgStop(const char *args)
+{
+    (void)args;
+    system_state.mode = MODE_IDLE;
+    printf("EMG acquisition stopped.\r\n");
+}
+
+// EMG:STREAM [RAW] [FEAT] [PRED] | ALL | OFF; no arguments streams everything
+static void Command_EmgStream(const char *args)
+{
+    EMG_Config_t emg_config;
+    uint8_t mask = 0;
+    uint32_t required;
+    
+    while (*args != '\0') {
+        size_t len = strcspn(args, " ");
+        
+        if (len == 3 && strncmp(args, "RAW", 3) == 0) {
+            mask |= STREAM_MASK_RAW;
+        } else if (len == 4 && strncmp(args, "FEAT", 4) == 0) {
+            mask |= STREAM_MASK_FEATURE;
+        } else if (len == 4 && strncmp(args, "PRED", 4) == 0) {
+            mask |= STREAM_MASK_RESULT;
+        } else if (len == 3 && strncmp(args, "ALL", 3) == 0) {
+            mask |= STREAM_MASK_ALL;
+        } else if (len == 3 && strncmp(args, "OFF", 3) == 0) {
+            Stream_Stop();
+            printf("EMG streaming stopped.\r\n");
+            return;
+        } else {
+            printf("ERR usage: EMG:STREAM [RAW] [FEAT] [PRED] | ALL | OFF\r\n");
+            return;
+        }
+        
+        args += len;
+        while (*args == ' ') {
+            args++;
+        }
+    }
+    
+    if (mask == 0) {
+        mask = STREAM_MASK_ALL;
+    }
+    
+    EMG_GetConfig(&emg_config);
+    required = Stream_RequiredBaud(mask, emg_config.sample_rate);
+    
+    if (huart3.Init.BaudRate < required) {
+        printf("ERR stream needs %lu baud, UART runs at %lu\r\n",
+               required, huart3.Init.BaudRate);
+        return;
+    }
+    
+    printf("EMG streaming started (mask 0x%02X).\r\n", mask);
+    
+    if (Stream_Start(mask, &emg_config) != HAL_OK) {
+        printf("ERR stream configuration\r\n");
+    }
+}
+
+static void Command_DebugOn(const char *args)
+{
+    (void)args;
+    system_state.debug_enabled = true;
+    printf("Debug output enabled.\r\n");
+}
+
+static void Command_DebugOff(const char *args)
+{
+    (void)args;
+    system_state.debug_enabled = false;
+    printf("Debug output disabled.\r\n");
+}
+
+// Lines not listed here fall through to Monitor_ProcessCommand
+static const Cmd_Entry_t main_commands[] = {
+    {"SYS:INFO?",      Command_SysInfo,      "System information"},
+    {"SYS:PROF?",      Command_SysProf,      "Per-stage cycle timing (us)"},
+    {"SYS:PROF:RESET", Command_SysProfReset, "Clear profiler statistics"},
+    {"SYS:LAT?",       Command_SysLat,       "DRDY-to-PWM latency per stage (us)"},
+    {"SYS:LAT:RESET",  Command_SysLatReset,  "Clear latency statistics"},
+    {"SYS:MEM?",       Command_SysMem,       "Static memory budget and scratch use"},
+    {"SYS:POWER?",     Command_SysPower,     "Activity gate mode and counters"},
+    {"SYS:POWER:GATE", Command_SysPowerGate, "ON | OFF: low-rate mode at rest"},
+    {"EMG:START",      Command_EmgStart,     "Start acquisition"},
+    {"EMG:STOP",       Command_EmgStop,      "Stop acquisition"},
+    {"EMG:STREAM",     Command_EmgStream,    "Binary stream: [RAW] [FEAT] [PRED] | ALL | OFF"},
+    {"DEBUG:ON",       Command_DebugOn,      "Enable per-prediction output"},
+    {"DEBUG:OFF",      Command_DebugOff,     "Disable per-prediction output"},
+};
 
 /**
  * @brief System Monitor Task
@@ -342,54 +1343,25 @@ static void Servo_ControlTask(void *pvParameters)
  */
 static void System_MonitorTask(void *pvParameters)
 {
-    char rx_buffer[128];
-    uint16_t rx_idx = 0;
+    char line[CMD_MAX_LINE];
+    
+    Cmd_Register(main_commands, sizeof(main_commands) / sizeof(main_commands[0]));
+#if MODEL_SLOTS
+    ModelSlot_RegisterCommands();
+#endif
+    Cmd_SetFallback(Monitor_ProcessCommand);
     
     while (1) {
-        // Check for UART commands
-        if (UART_Available(&huart3)) {
-            char c = UART_GetChar(&huart3);
-            
-            if (c == '\r' || c == '\n') {
-                rx_buffer[rx_idx] = '\0';
-                
-                // Process command
-                if (strncmp(rx_buffer, "SYS:INFO?", 9) == 0) {
-                    printf("\r\n=== System Information ===\r\n");
-                    printf("Uptime: %lu seconds\r\n", HAL_GetTick() / 1000);
-                    printf("EMG Sample Rate: %lu Hz\r\n", system_state.stats.emg_sample_rate);
-                    printf("DSP Time: %lu ms\r\n", system_state.stats.dsp_processing_time);
-                    printf("ML Time: %lu ms\r\n", system_state.stats.ml_inference_time);
-                    printf("Total Predictions: %lu\r\n", system_state.stats.total_predictions);
-                    printf("Current Gesture: %d (%d%%)\r\n", 
-                           system_state.current_gesture, 
-                           system_state.gesture_confidence);
-                    printf("Battery: %.2f V\r\n", system_state.battery_voltage);
-                    printf("Temperature: %.1f C\r\n", system_state.temperature);
-                    printf("Free Heap: %d bytes\r\n", xPortGetFreeHeapSize());
-                } 
-                else if (strncmp(rx_buffer, "EMG:START", 9) == 0) {
-                    system_state.mode = MODE_ACTIVE;
-                    printf("EMG acquisition started.\r\n");
-                }
-                else if (strncmp(rx_buffer, "EMG:STOP", 8) == 0) {
-                    system_state.mode = MODE_IDLE;
-                    printf("EMG acquisition stopped.\r\n");
-                }
-                else if (strncmp(rx_buffer, "DEBUG:ON", 8) == 0) {
-                    system_state.debug_enabled = true;
-                    printf("Debug output enabled.\r\n");
-                }
-                else if (strncmp(rx_buffer, "DEBUG:OFF", 9) == 0) {
-                    system_state.debug_enabled = false;
-                    printf("Debug output disabled.\r\n");
-                }
-                
-                rx_idx = 0;
-            } else if (rx_idx < sizeof(rx_buffer) - 1) {
-                rx_buffer[rx_idx++] = c;
-            }
+        // Sleeps until a full command line arrives or housekeeping is due
+        if (Cmd_WaitLine(line, sizeof(line), pdMS_TO_TICKS(100))) {
+            Cmd_Dispatch(line);
         }
+#if MODEL_SLOTS
+        ModelSlot_Poll();
+#endif
+        
+        // Arm motion for the activity gate (latch every pass, FIFO every second)
+        Activity_UpdateMotion();
         
         // Update battery voltage (every second)
         static uint32_t last_battery_check = 0;
@@ -407,13 +1379,13 @@ static void System_MonitorTask(void *pvParameters)
         
         // Watchdog reset
         HAL_IWDG_Refresh(&hiwdg);
-        
-        vTaskDelay(pdMS_TO_TICKS(100));
     }
 }
+#endif
 
 /* Peripheral Initialization -------------------------------------------------*/
 
+#if APP_DSP_CORE
 /**
  * @brief System Clock Configuration
  * @note Configures system clock to 280 MHz using PLL
@@ -483,10 +1455,30 @@ static void GPIO_Init(void)
     HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
     
     // Configure ADS1299 control pins
-    GPIO_InitStruct.Pin = GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_2;  // DRDY, START, RESET
+    GPIO_InitStruct.Pin = GPIO_PIN_1 | GPIO_PIN_2;  // START, RESET
     GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
     GPIO_InitStruct.Pull = GPIO_PULLUP;
     HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+    
+    // DRDY falls when a frame is ready; its EXTI starts the SPI DMA read
+    GPIO_InitStruct.Pin = ADS1299_DRDY_Pin;
+    GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;
+    HAL_GPIO_Init(ADS1299_DRDY_GPIO_Port, &GPIO_InitStruct);
+    
+    // Software chip select, idle high
+    HAL_GPIO_WritePin(ADS1299_CS_GPIO_Port, ADS1299_CS_Pin, GPIO_PIN_SET);
+    GPIO_InitStruct.Pin = ADS1299_CS_Pin;
+    GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(ADS1299_CS_GPIO_Port, &GPIO_InitStruct);
+    
+    // LIS3DH INT1 (latched wake-up); polled, EXTI0 belongs to DRDY
+    GPIO_InitStruct.Pin = ACC_INT1_Pin;
+    GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+    GPIO_InitStruct.Pull = GPIO_PULLDOWN;
+    HAL_GPIO_Init(ACC_INT1_GPIO_Port, &GPIO_InitStruct);
 }
 
 /**
@@ -509,6 +1501,53 @@ static void SPI1_Init(void)
     if (HAL_SPI_Init(&hspi1) != HAL_OK) {
         Error_Handler();
     }
+    
+    // One full-duplex DMA transfer per DRDY: RX into the raw frame buffer,
+    // TX clocks out zeros (no command while in RDATAC)
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    hdma_spi1_rx.Instance = DMA1_Stream0;
+    hdma_spi1_rx.Init.Request = DMA_REQUEST_SPI1_RX;
+    hdma_spi1_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_spi1_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_spi1_rx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_spi1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_spi1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_spi1_rx.Init.Mode = DMA_NORMAL;
+    hdma_spi1_rx.Init.Priority = DMA_PRIORITY_HIGH;
+    hdma_spi1_rx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    
+    if (HAL_DMA_Init(&hdma_spi1_rx) != HAL_OK) {
+        Error_Handler();
+    }
+    
+    __HAL_LINKDMA(&hspi1, hdmarx, hdma_spi1_rx);
+    
+    hdma_spi1_tx.Instance = DMA1_Stream1;
+    hdma_spi1_tx.Init.Request = DMA_REQUEST_SPI1_TX;
+    hdma_spi1_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_spi1_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_spi1_tx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_spi1_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_spi1_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_spi1_tx.Init.Mode = DMA_NORMAL;
+    hdma_spi1_tx.Init.Priority = DMA_PRIORITY_HIGH;
+    hdma_spi1_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    
+    if (HAL_DMA_Init(&hdma_spi1_tx) != HAL_OK) {
+        Error_Handler();
+    }
+    
+    __HAL_LINKDMA(&hspi1, hdmatx, hdma_spi1_tx);
+    
+    // Above the UART and servo, still within FreeRTOS-safe priorities
+    HAL_NVIC_SetPriority(DMA1_Stream0_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream0_IRQn);
+    HAL_NVIC_SetPriority(DMA1_Stream1_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream1_IRQn);
+    HAL_NVIC_SetPriority(SPI1_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(SPI1_IRQn);
+    HAL_NVIC_SetPriority(EXTI0_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(EXTI0_IRQn);
 }
 
 /**
@@ -529,6 +1568,9 @@ static void I2C1_Init(void)
     }
 }
 
+#endif
+
+#if APP_ML_CORE
 /**
  * @brief TIM1 Initialization for Servo PWM
  */
@@ -565,13 +1607,16 @@ static void TIM1_Init(void)
     }
 }
 
+#endif
+
+#if APP_DSP_CORE
 /**
  * @brief UART3 Initialization for Debug
  */
 static void UART3_Init(void)
 {
     huart3.Instance = USART3;
-    huart3.Init.BaudRate = 115200;
+    huart3.Init.BaudRate = DEBUG_UART_BAUDRATE;
     huart3.Init.WordLength = UART_WORDLENGTH_8B;
     huart3.Init.StopBits = UART_STOPBITS_1;
     huart3.Init.Parity = UART_PARITY_NONE;
@@ -582,7 +1627,188 @@ static void UART3_Init(void)
     if (HAL_UART_Init(&huart3) != HAL_OK) {
         Error_Handler();
     }
+    
+    // TX DMA for the non-blocking debug log
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    hdma_usart3_tx.Instance = DMA1_Stream7;
+    hdma_usart3_tx.Init.Request = DMA_REQUEST_USART3_TX;
+    hdma_usart3_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_usart3_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_usart3_tx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_usart3_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_usart3_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_usart3_tx.Init.Mode = DMA_NORMAL;
+    hdma_usart3_tx.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_usart3_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    
+    if (HAL_DMA_Init(&hdma_usart3_tx) != HAL_OK) {
+        Error_Handler();
+    }
+    
+    __HAL_LINKDMA(&huart3, hdmatx, hdma_usart3_tx);
+    
+    // Circular RX DMA for idle-line command reception
+    hdma_usart3_rx.Instance = DMA1_Stream6;
+    hdma_usart3_rx.Init.Request = DMA_REQUEST_USART3_RX;
+    hdma_usart3_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_usart3_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_usart3_rx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_usart3_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_usart3_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_usart3_rx.Init.Mode = DMA_CIRCULAR;
+    hdma_usart3_rx.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_usart3_rx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    
+    if (HAL_DMA_Init(&hdma_usart3_rx) != HAL_OK) {
+        Error_Handler();
+    }
+    
+    __HAL_LINKDMA(&huart3, hdmarx, hdma_usart3_rx);
+    
+    HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 7, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+    HAL_NVIC_SetPriority(DMA1_Stream7_IRQn, 7, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream7_IRQn);
+    HAL_NVIC_SetPriority(USART3_IRQn, 7, 0);
+    HAL_NVIC_EnableIRQ(USART3_IRQn);
+}
+
+#if DSP_USE_FMAC
+/**
+ * @brief FMAC Initialization for the notch filter, DMA both ways
+ */
+static void FMAC_Init(void)
+{
+    __HAL_RCC_FMAC_CLK_ENABLE();
+    hfmac.Instance = FMAC;
+    
+    if (HAL_FMAC_Init(&hfmac) != HAL_OK) {
+        Error_Handler();
+    }
+    
+    // q15 rows from non-cacheable SRAM, one halfword per request
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    hdma_fmac_in.Instance = DMA1_Stream2;
+    hdma_fmac_in.Init.Request = DMA_REQUEST_FMAC_WRITE;
+    hdma_fmac_in.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_fmac_in.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_fmac_in.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_fmac_in.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_fmac_in.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_fmac_in.Init.Mode = DMA_NORMAL;
+    hdma_fmac_in.Init.Priority = DMA_PRIORITY_MEDIUM;
+    hdma_fmac_in.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    
+    if (HAL_DMA_Init(&hdma_fmac_in) != HAL_OK) {
+        Error_Handler();
+    }
+    
+    __HAL_LINKDMA(&hfmac, hdmaIn, hdma_fmac_in);
+    
+    hdma_fmac_out.Instance = DMA1_Stream3;
+    hdma_fmac_out.Init.Request = DMA_REQUEST_FMAC_READ;
+    hdma_fmac_out.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_fmac_out.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_fmac_out.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_fmac_out.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_fmac_out.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_fmac_out.Init.Mode = DMA_NORMAL;
+    hdma_fmac_out.Init.Priority = DMA_PRIORITY_MEDIUM;
+    hdma_fmac_out.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    
+    if (HAL_DMA_Init(&hdma_fmac_out) != HAL_OK) {
+        Error_Handler();
+    }
+    
+    __HAL_LINKDMA(&hfmac, hdmaOut, hdma_fmac_out);
+    
+    // Below EMG acquisition, above the UART
+    HAL_NVIC_SetPriority(DMA1_Stream2_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream2_IRQn);
+    HAL_NVIC_SetPriority(DMA1_Stream3_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream3_IRQn);
+    HAL_NVIC_SetPriority(FMAC_IRQn, 6, 0);
+    HAL_NVIC_EnableIRQ(FMAC_IRQn);
+}
+#endif
+#endif
+
+#if DUAL_CORE
+/* Core start-up -------------------------------------------------------------*/
+
+#if APP_DSP_CORE
+/**
+ * @brief Wait for the CM4 to park in Stop (D2 clock off) after reset
+ */
+static void Core_WaitForSecondaryStop(void)
+{
+    uint32_t timeout = CORE_BOOT_TIMEOUT;
+    
+    while (__HAL_RCC_GET_FLAG(RCC_FLAG_D2CKRDY) != RESET && timeout > 0) {
+        timeout--;
+    }
+    if (timeout == 0) {
+        Error_Handler();
+    }
+}
+
+/**
+ * @brief Release the CM4 from Stop through the boot semaphore
+ * @note After Core_InitRings; the CM4 attaches to rings that are already empty
+ */
+static void Core_StartSecondary(void)
+{
+    uint32_t timeout = CORE_BOOT_TIMEOUT;
+    
+    __HAL_RCC_HSEM_CLK_ENABLE();
+    if (HAL_HSEM_FastTake(HSEM_ID_BOOT) != HAL_OK) {
+        Error_Handler();
+    }
+    HAL_HSEM_Release(HSEM_ID_BOOT, 0);
+    
+    while (__HAL_RCC_GET_FLAG(RCC_FLAG_D2CKRDY) == RESET && timeout > 0) {
+        timeout--;
+    }
+    if (timeout == 0) {
+        Error_Handler();
+    }
+}
+#else
+/**
+ * @brief Park the CM4 in Stop until the CM7 releases the boot semaphore
+ */
+static void Core_WaitForPrimary(void)
+{
+    __HAL_RCC_HSEM_CLK_ENABLE();
+    HAL_HSEM_ActivateNotification(__HAL_HSEM_SEMID_TO_MASK(HSEM_ID_BOOT));
+    HAL_PWREx_ClearPendingEvent();
+    HAL_PWREx_EnterSTOPMode(PWR_MAINREGULATOR_ON, PWR_STOPENTRY_WFE, PWR_D2_DOMAIN);
+    __HAL_HSEM_CLEAR_FLAG(__HAL_HSEM_SEMID_TO_MASK(HSEM_ID_BOOT));
+}
+#endif
+
+/**
+ * @brief Describe both shared rings; the CM7 also empties them
+ */
+static HAL_StatusTypeDef Core_InitRings(void)
+{
+    __HAL_RCC_HSEM_CLK_ENABLE();
+    
+    if (IPC_Ring_Init(&feature_ring, FEATURE_RING_BASE, FEATURE_QUEUE_LENGTH,
+                      sizeof(Feature_Message_t), HSEM_ID_FEATURES) != HAL_OK ||
+        IPC_Ring_Init(&result_ring, RESULT_RING_BASE, RESULT_RING_SLOTS,
+                      sizeof(ML_Report_t), HSEM_ID_RESULTS) != HAL_OK) {
+        return HAL_ERROR;
+    }
+    
+#if APP_DSP_CORE
+    IPC_Ring_Reset(&feature_ring);
+    IPC_Ring_Reset(&result_ring);
+#endif
+    
+    return HAL_OK;
 }
+#endif
 
 /**
  * @brief Error Handler
@@ -595,8 +1821,11 @@ static void Error_Handler(void)
     // Turn on error LED
     HAL_GPIO_WritePin(GPIOB, GPIO_PIN_2, GPIO_PIN_SET);  // Red LED
     
-    // Log error if possible
+#if APP_DSP_CORE
+    // Log error if possible; interrupts are off, so push the ring out by polling
     printf("\r\nFATAL ERROR! System halted.\r\n");
+    Log_FlushBlocking();
+#endif
     
     // Infinite loop
     while (1) {
@@ -605,10 +1834,160 @@ static void Error_Handler(void)
     }
 }
 
+/* Interrupt handlers --------------------------------------------------------*/
+#if APP_ML_CORE
+void TIM1_UP_IRQHandler(void)
+{
+    HAL_TIM_IRQHandler(&htim1);
+}
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+    if (htim->Instance == TIM1) {
+        Servo_UpdateMovement();
+    }
+}
+#endif
+
+#if APP_DSP_CORE
+void EXTI0_IRQHandler(void)
+{
+    HAL_GPIO_EXTI_IRQHandler(ADS1299_DRDY_Pin);
+}
+
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+    if (GPIO_Pin == ADS1299_DRDY_Pin) {
+        EMG_DRDY_IRQHandler();
+    }
+}
+
+void DMA1_Stream0_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_spi1_rx);
+}
+
+void DMA1_Stream1_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_spi1_tx);
+}
+
+void SPI1_IRQHandler(void)
+{
+    HAL_SPI_IRQHandler(&hspi1);
+}
+
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+    if (hspi->Instance == SPI1) {
+        EMG_SPI_TxRxCpltCallback();
+    }
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+    if (hspi->Instance == SPI1) {
+        EMG_SPI_ErrorCallback();
+    }
+}
+
+#if DSP_USE_FMAC
+void DMA1_Stream2_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_fmac_in);
+}
+
+void DMA1_Stream3_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_fmac_out);
+}
+
+void FMAC_IRQHandler(void)
+{
+    HAL_FMAC_IRQHandler(&hfmac);
+}
+
+void HAL_FMAC_OutputDataReadyCallback(FMAC_HandleTypeDef *hfmac_cb)
+{
+    if (hfmac_cb->Instance == FMAC) {
+        DSP_FMAC_TransferComplete();
+    }
+}
+
+void HAL_FMAC_ErrorCallback(FMAC_HandleTypeDef *hfmac_cb)
+{
+    if (hfmac_cb->Instance == FMAC) {
+        DSP_FMAC_TransferError();
+    }
+}
+#endif
+
+void DMA1_Stream6_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_usart3_rx);
+}
+
+void DMA1_Stream7_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_usart3_tx);
+}
+
+void USART3_IRQHandler(void)
+{
+    HAL_UART_IRQHandler(&huart3);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == USART3) {
+        Log_TxComplete();
+    }
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == USART3) {
+        // RX line errors leave a TX DMA running; only a TX DMA error ends it
+        if ((huart->ErrorCode & HAL_UART_ERROR_DMA) != 0U && huart->gState == HAL_UART_STATE_READY &&
+            huart->hdmatx != NULL && huart->hdmatx->ErrorCode != HAL_DMA_ERROR_NONE) {
+            Log_TxComplete();
+        }
+        Cmd_RxError();
+    }
+}
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    if (huart->Instance == USART3) {
+        Cmd_RxEvent(Size);
+    }
+}
+#endif
+
+#if DUAL_CORE
+#if APP_DSP_CORE
+void HSEM1_IRQHandler(void)
+#else
+void HSEM2_IRQHandler(void)
+#endif
+{
+    HAL_HSEM_IRQHandler();
+}
+
+void HAL_HSEM_FreeCallback(uint32_t SemMask)
+{
+    IPC_HSEM_FreeCallback(SemMask);
+}
+#endif
+
 /* Printf retargeting --------------------------------------------------------*/
 int _write(int file, char *ptr, int len)
 {
-    HAL_UART_Transmit(&huart3, (uint8_t *)ptr, len, HAL_MAX_DELAY);
+#if APP_DSP_CORE
+    // Never waits on the UART; overflow is counted in Log_GetStats
+    Log_Write(ptr, (uint32_t)len);
+#endif
+    // The CM4 has no console in DUAL_CORE builds; its output is discarded
     return len;
 }
 
@@ -623,4 +2002,35 @@ void vApplicationMallocFailedHook(void)
 {
     printf("ERROR: Malloc failed!\r\n");
     Error_Handler();
-}
\ No newline at end of file
+}
+
+#if configUSE_IDLE_HOOK
+void vApplicationIdleHook(void)
+{
+#if APP_DSP_CORE
+    // WFI between DMA bursts while the activity gate is in low-rate mode
+    Activity_IdleSleep();
+#endif
+}
+#endif
+
+// Kernel task storage for configSUPPORT_STATIC_ALLOCATION
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                   StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize)
+{
+    *ppxIdleTaskTCBBuffer = &idleTaskTcb;
+    *ppxIdleTaskStackBuffer = idleTaskStack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+#if configUSE_TIMERS
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
+                                    StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize)
+{
+    *ppxTimerTaskTCBBuffer = &timerTaskTcb;
+    *ppxTimerTaskStackBuffer = timerTaskStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+#endif
\ No newline at end of file
@@ -37,10 +37,13 @@ typedef enum {
 
 typedef struct {
     uint32_t emg_sample_rate;
-    uint32_t dsp_processing_time;
-    uint32_t ml_inference_time;
+    uint32_t dsp_processing_time;     // Last DSP window, microseconds
+    uint32_t ml_inference_time;       // Last inference, microseconds
     uint32_t total_predictions;
     uint32_t dropped_samples;
+    uint32_t trees_evaluated;     // Trees evaluated by the last inference (early exit)
+    uint32_t dropped_windows;     // Feature vectors never classified (full queue, no scratch)
+    uint32_t max_batch;           // Most vectors one ML wakeup has batched
 } System_Stats_t;
 
 typedef struct {
@@ -0,0 +1,122 @@
+/**
+ * @file memory_map.c
+ * @brief TCM section start-up and MPU setup for the DMA buffer region
+ *
+ * The sections come from memory_sections.ld. The DMA region is mapped as
+ * shareable, non-cacheable normal memory, so DMA and the CPU always see
+ * the same bytes and drivers skip SCB_CleanDCache/SCB_InvalidateDCache.
+ * DUAL_CORE builds map the inter-core region the same way on the CM7, so
+ * both cores see each other's ring writes without cache maintenance.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "memory_map.h"
+
+/* Private variables ---------------------------------------------------------*/
+#if MEM_PLACEMENT
+// Linker symbols (memory_sections.ld)
+extern uint32_t _siitcm_text, _sitcm_text, _eitcm_text;
+extern uint32_t _sidtcm_data, _sdtcm_data, _edtcm_data;
+extern uint32_t _sdtcm_bss, _edtcm_bss;
+extern uint32_t _sdma_buffer, _edma_buffer;
+#endif
+
+/* Private functions ---------------------------------------------------------*/
+#if MEM_PLACEMENT
+static void copy_words(uint32_t *dst, const uint32_t *src, const uint32_t *end)
+{
+    while (dst < end) {
+        *dst++ = *src++;
+    }
+}
+
+static void zero_words(uint32_t *dst, const uint32_t *end)
+{
+    while (dst < end) {
+        *dst++ = 0;
+    }
+}
+#endif
+
+#if MEM_PLACEMENT || (DUAL_CORE && defined(CORE_CM7))
+static void region_non_cacheable(uint8_t number, uint32_t base, uint8_t size)
+{
+    MPU_Region_InitTypeDef region = {0};
+
+    region.Enable = MPU_REGION_ENABLE;
+    region.Number = number;
+    region.BaseAddress = base;
+    region.Size = size;
+    region.SubRegionDisable = 0x00;
+    region.TypeExtField = MPU_TEX_LEVEL1;          // Normal memory, non-cacheable
+    region.AccessPermission = MPU_REGION_FULL_ACCESS;
+    region.DisableExec = MPU_INSTRUCTION_ACCESS_DISABLE;
+    region.IsShareable = MPU_ACCESS_SHAREABLE;
+    region.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
+    region.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+    HAL_MPU_ConfigRegion(&region);
+}
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Load ITCM code and DTCM data from flash, zero DTCM and DMA bss
+ */
+void Memory_InitSections(void)
+{
+#if MEM_PLACEMENT
+    copy_words(&_sitcm_text, &_siitcm_text, &_eitcm_text);
+    copy_words(&_sdtcm_data, &_sidtcm_data, &_edtcm_data);
+    zero_words(&_sdtcm_bss, &_edtcm_bss);
+    zero_words(&_sdma_buffer, &_edma_buffer);
+
+    // Code was written through the data side; fetch it fresh
+    __DSB();
+    __ISB();
+#endif
+}
+
+/**
+ * @brief Make the DMA buffer region (and the inter-core region) non-cacheable
+ * @note Call before SCB_EnableDCache
+ */
+HAL_StatusTypeDef Memory_ConfigureMPU(void)
+{
+#if MEM_PLACEMENT
+    if ((uint32_t)&_sdma_buffer < MEM_DMA_REGION_BASE ||
+        (uint32_t)&_edma_buffer > MEM_DMA_REGION_BASE + MEM_DMA_REGION_SIZE) {
+        return HAL_ERROR;
+    }
+#endif
+
+#if MEM_PLACEMENT || (DUAL_CORE && defined(CORE_CM7))
+    HAL_MPU_Disable();
+#if MEM_PLACEMENT
+    region_non_cacheable(MPU_REGION_NUMBER0, MEM_DMA_REGION_BASE, MEM_DMA_REGION_MPU_SIZE);
+#endif
+#if DUAL_CORE && defined(CORE_CM7)
+    region_non_cacheable(MPU_REGION_NUMBER1, MEM_SHARED_REGION_BASE, MEM_SHARED_REGION_MPU_SIZE);
+#endif
+    HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+#endif
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Bytes placed in ITCM, DTCM and the DMA region
+ */
+void Memory_GetUsage(uint32_t *itcm_bytes, uint32_t *dtcm_bytes, uint32_t *dma_bytes)
+{
+#if MEM_PLACEMENT
+    *itcm_bytes = (uint32_t)&_eitcm_text - (uint32_t)&_sitcm_text;
+    *dtcm_bytes = ((uint32_t)&_edtcm_data - (uint32_t)&_sdtcm_data) +
+                  ((uint32_t)&_edtcm_bss - (uint32_t)&_sdtcm_bss);
+    *dma_bytes = (uint32_t)&_edma_buffer - (uint32_t)&_sdma_buffer;
+#else
+    *itcm_bytes = 0;
+    *dtcm_bytes = 0;
+    *dma_bytes = 0;
+#endif
+}
@@ -0,0 +1,115 @@
+/**
+ * @file memory_map.h
+ * @brief Placement of hot code and data in TCM and of DMA buffers in
+ *        non-cacheable SRAM
+ *
+ * Section names match memory_sections.ld, which the project linker script
+ * includes. With MEM_PLACEMENT = 0 every macro keeps only its alignment,
+ * so host builds and tools link the same sources unchanged.
+ *
+ * DUAL_CORE builds (CM7 + CM4 parts) add a shared SRAM4 region at a fixed
+ * address that neither image links into; the rings in it are laid out
+ * from MEM_SHARED_REGION_BASE by main.c, identically in both images.
+ */
+
+#ifndef MEMORY_MAP_H
+#define MEMORY_MAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm32h7xx_hal.h"
+#include "emg_config.h"
+
+/* Build configuration -------------------------------------------------------*/
+#ifndef MEM_PLACEMENT
+#define MEM_PLACEMENT           1   // 0 = leave placement to the default sections
+#endif
+
+// 1 = DSP on the CM7, inference and servo on the CM4 (ipc_ring.h); the
+// image is built once per core with CORE_CM7 or CORE_CM4 defined
+#ifndef DUAL_CORE
+#define DUAL_CORE               0
+#endif
+
+#if DUAL_CORE && !defined(CORE_CM7) && !defined(CORE_CM4)
+#error "DUAL_CORE needs CORE_CM7 or CORE_CM4"
+#endif
+
+#if DUAL_CORE && defined(CORE_CM4) && MEM_PLACEMENT
+#error "The CM4 has no TCM: build its image with MEM_PLACEMENT=0"
+#endif
+
+// Scratch regions in DTCM (scratch_arena.h), one per stage so the DSP and
+// ML tasks never wait on each other. The DSP region holds the filtered
+// block (4 KB at 4 channels, plus the float features); the ML region holds
+// a batch and RF_SCRATCH_BYTES must fit it: 2 KB at 4 channels.
+#ifndef SCRATCH_DSP_SIZE
+#define SCRATCH_DSP_SIZE        (1024U * EMG_NUM_CHANNELS + 256U)
+#endif
+#ifndef SCRATCH_ML_SIZE
+#define SCRATCH_ML_SIZE         (1024U + 256U * EMG_NUM_CHANNELS)
+#endif
+
+// Statically allocated RAM main.c may use for task stacks, kernel objects
+// and the scratch regions; checked at compile time, itemized by SYS:MEM?. The
+// sliding window and scratch regions scale per channel: 32 KB at 4 channels.
+#ifndef STATIC_RAM_BUDGET
+#define STATIC_RAM_BUDGET       ((16U + 4U * EMG_NUM_CHANNELS) * 1024U)
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+// Non-cacheable DMA region (MPU region 0); must match RAM_DMA in
+// memory_sections.ld. Size is a power of two and the base aligned to it.
+#define MEM_DMA_REGION_BASE     0x30000000U   // AHB SRAM1, reachable by DMA1/DMA2
+#define MEM_DMA_REGION_SIZE     0x00008000U   // 32 KB
+#define MEM_DMA_REGION_MPU_SIZE MPU_REGION_SIZE_32KB
+
+// Inter-core region (MPU region 1 on the CM7, non-cacheable); must be
+// left out of RAM in both linker scripts. The CM4 has no data cache.
+#define MEM_SHARED_REGION_BASE     0x38000000U   // SRAM4 (D3), reachable by both cores
+#define MEM_SHARED_REGION_SIZE     0x00004000U   // 16 KB
+#define MEM_SHARED_REGION_MPU_SIZE MPU_REGION_SIZE_16KB
+
+/* Exported macro ------------------------------------------------------------*/
+#if MEM_PLACEMENT
+// Zero-wait-state instruction TCM; noinline keeps callers in flash from
+// pulling the body back out of ITCM
+#define ITCM_CODE               __attribute__((section(".itcm_text"), noinline))
+// Data TCM: single-cycle, never cached, not reachable by DMA1/DMA2
+#define DTCM_DATA               __attribute__((section(".dtcm_data")))     // Initialized
+#define DTCM_RODATA             __attribute__((section(".dtcm_rodata")))   // const, copied from flash
+#define DTCM_BSS                __attribute__((section(".dtcm_bss")))      // Zeroed
+// DMA source/target in the MPU non-cacheable region; no cache maintenance needed
+#define DMA_BUFFER              __attribute__((section(".dma_buffer"), aligned(32)))
+#else
+#define ITCM_CODE
+#define DTCM_DATA
+#define DTCM_RODATA
+#define DTCM_BSS
+#define DMA_BUFFER              __attribute__((aligned(32)))
+#endif
+
+// DMA buffers sit in cacheable memory only without MEM_PLACEMENT; drivers
+// clean/invalidate around transfers in that case
+#define MEM_DMA_CACHE_MAINTENANCE  (!MEM_PLACEMENT)
+
+/* Exported functions prototypes ---------------------------------------------*/
+/*
+ * Call Memory_InitSections first thing in main(), before any ITCM_CODE
+ * function runs or DTCM data is read; the stock startup code only copies
+ * .data and zeroes .bss. Call Memory_ConfigureMPU before SCB_EnableDCache.
+ */
+void Memory_InitSections(void);
+HAL_StatusTypeDef Memory_ConfigureMPU(void);   // HAL_ERROR if .dma_buffer outgrew the region
+                                               // (CM7 only in DUAL_CORE builds)
+void Memory_GetUsage(uint32_t *itcm_bytes, uint32_t *dtcm_bytes, uint32_t *dma_bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MEMORY_MAP_H */
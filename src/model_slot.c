@@ -0,0 +1,758 @@
+/**
+ * @file model_slot.c
+ * @brief A/B model slots: boot selection, upload, validation and handoff
+ *
+ * Only the monitor task erases, programs and validates slots. The handoff
+ * to the pipeline is three pointers: pending_model (monitor -> DSP task),
+ * dsp_model (stamped on new feature messages) and ml_model (loaded in the
+ * flat engine). A slot's descriptor is rewritten only by an upload, which
+ * is refused until the pipeline has settled on one model (no pending
+ * swap, DSP and ML on the same descriptor) and always targets the other
+ * slot, so a descriptor is never changed while queued messages refer to it.
+ *
+ * Flash is erased or programmed only while the DSP task has confirmed that
+ * acquisition is stopped (hold_request / hold_granted), from MODEL:BEGIN
+ * until the upload ends one way or another.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "model_slot.h"
+#include "dsp_pipeline.h"
+#include "debug_cmd.h"
+
+#if MODEL_SLOTS
+
+/* Private defines -----------------------------------------------------------*/
+#define SLOT_WORD_BYTES         (FLASH_NB_32BITWORD_IN_FLASHWORD * 4U)   // Programming unit
+#define SLOT_HEADER_BYTES       ((uint32_t)sizeof(Model_SlotHeader_t))
+#define SLOT_ERASED_WORD        0xFFFFFFFFU
+
+_Static_assert(sizeof(Model_SlotHeader_t) == 64U, "Model_SlotHeader_t layout changed");
+_Static_assert(sizeof(RF_FlatTree_t) == 254U, "RF_FlatTree_t no longer matches export_model_slot");
+_Static_assert(SLOT_HEADER_BYTES % SLOT_WORD_BYTES == 0U, "Header is not whole flash words");
+_Static_assert(FEATURE_MASK_WORDS <= MODEL_SLOT_MASK_WORDS, "Feature_Mask_t exceeds the slot header");
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    uint32_t base;            // Memory-mapped address
+    uint32_t sector;          // Erase sector
+} Slot_Flash_t;
+
+typedef struct {
+    bool active;
+    uint8_t slot;
+    uint32_t image_size;
+    uint32_t received;                          // Next expected offset
+    uint32_t last_tick;                         // HAL tick of the last command
+    Model_SlotHeader_t header;                  // Programmed last, by ModelSlot_CommitUpload
+    uint32_t word[SLOT_WORD_BYTES / 4U];        // Flash word being assembled
+} Slot_Upload_t;
+
+/* Private variables ---------------------------------------------------------*/
+static const Slot_Flash_t slot_flash[MODEL_SLOT_COUNT] = {
+    { MODEL_SLOT_A_ADDR, MODEL_SLOT_A_SECTOR },
+    { MODEL_SLOT_B_ADDR, MODEL_SLOT_B_SECTOR },
+};
+
+// RAM descriptors over the images; trees and scales are read from flash
+static RF_FlatModel_t slot_model[MODEL_SLOT_COUNT];
+static Feature_Mask_t slot_mask[MODEL_SLOT_COUNT];
+static Model_SlotHeader_t slot_header[MODEL_SLOT_COUNT];
+static Model_SlotState_t slot_state[MODEL_SLOT_COUNT];
+static const RF_FlatModel_t *builtin_model = NULL;
+
+static uint8_t selected = MODEL_SLOT_BUILTIN;          // Monitor task
+static const RF_FlatModel_t *volatile pending_model = NULL;
+static const RF_FlatModel_t *volatile dsp_model = NULL;
+static const RF_FlatModel_t *volatile ml_model = NULL;
+
+static Slot_Upload_t upload;
+
+// Acquisition pause: requested by the monitor task, confirmed by the DSP task
+static volatile bool hold_request = false;
+static volatile bool hold_granted = false;
+
+/* Private functions ---------------------------------------------------------*/
+// CRC-32 as zlib.crc32 (reflected, polynomial 0x04C11DB7)
+static uint32_t crc32(const uint8_t *data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFFU;
+
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 1U) ? (crc >> 1) ^ 0xEDB88320U : (crc >> 1);
+        }
+    }
+
+    return ~crc;
+}
+
+static const RF_FlatModel_t *slot_to_model(uint8_t slot)
+{
+    return (slot == MODEL_SLOT_BUILTIN) ? builtin_model : &slot_model[slot];
+}
+
+static uint8_t model_to_slot(const RF_FlatModel_t *model)
+{
+    for (uint8_t s = 0; s < MODEL_SLOT_COUNT; s++) {
+        if (model == &slot_model[s]) {
+            return s;
+        }
+    }
+
+    return MODEL_SLOT_BUILTIN;
+}
+
+// Ask the DSP task to stop acquisition and wait until it has
+static HAL_StatusTypeDef acquisition_hold(void)
+{
+    const uint32_t start = HAL_GetTick();
+
+    hold_request = true;
+    while (!hold_granted) {
+        if (HAL_GetTick() - start > MODEL_SLOT_HOLD_TIMEOUT_MS) {
+            hold_request = false;
+            return HAL_TIMEOUT;
+        }
+        vTaskDelay(1);
+    }
+
+    return HAL_OK;
+}
+
+static void acquisition_release(void)
+{
+    hold_granted = false;
+    hold_request = false;
+}
+
+// End the upload without a bootable image and restart acquisition
+static void upload_abort(uint8_t slot, Model_SlotState_t state)
+{
+    upload.active = false;
+    slot_state[slot] = state;
+    acquisition_release();
+}
+
+// Reads of the slot must not hit lines cached before an erase or program
+static void slot_invalidate(uint8_t slot)
+{
+    SCB_InvalidateDCache_by_Addr((uint32_t *)slot_flash[slot].base, (int32_t)MODEL_SLOT_SIZE);
+}
+
+static HAL_StatusTypeDef slot_erase(uint8_t slot)
+{
+    FLASH_EraseInitTypeDef erase = {
+        .TypeErase = FLASH_TYPEERASE_SECTORS,
+        .Banks = MODEL_SLOT_FLASH_BANK,
+        .Sector = slot_flash[slot].sector,
+        .NbSectors = 1,
+        .VoltageRange = FLASH_VOLTAGE_RANGE_3,
+    };
+    uint32_t sector_error = 0;
+    HAL_StatusTypeDef status;
+
+    // The erase stalls the bank the acquisition ISRs are fetched from
+    if (!hold_granted) {
+        return HAL_ERROR;
+    }
+
+    HAL_FLASH_Unlock();
+    status = HAL_FLASHEx_Erase(&erase, &sector_error);
+    HAL_FLASH_Lock();
+    slot_invalidate(slot);
+
+    return status;
+}
+
+static HAL_StatusTypeDef slot_program(uint8_t slot, uint32_t offset, const uint32_t *word)
+{
+    HAL_StatusTypeDef status;
+
+    if (!hold_granted) {
+        return HAL_ERROR;
+    }
+
+    HAL_FLASH_Unlock();
+    status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_FLASHWORD, slot_flash[slot].base + offset,
+                               (uint32_t)(uintptr_t)word);
+    HAL_FLASH_Lock();
+
+    return status;
+}
+
+/*
+ * Check header h against the image in the slot and, if it passes, fill the
+ * slot's descriptor. The descriptor must not be in use.
+ */
+static bool slot_check(uint8_t slot, const Model_SlotHeader_t *h)
+{
+    const uint8_t *base = (const uint8_t *)slot_flash[slot].base;
+    RF_FlatModel_t *model = &slot_model[slot];
+    Feature_Mask_t *mask = &slot_mask[slot];
+    uint32_t trees_end;
+
+    if (h->magic != MODEL_SLOT_MAGIC || h->format != MODEL_SLOT_FORMAT ||
+        h->header_size != SLOT_HEADER_BYTES ||
+        crc32((const uint8_t *)h, offsetof(Model_SlotHeader_t, header_crc)) != h->header_crc) {
+        return false;
+    }
+
+    if (h->n_trees == 0 || h->n_trees > RF_MAX_TREES || h->image_size > MODEL_SLOT_SIZE) {
+        return false;
+    }
+
+    trees_end = h->header_size + (uint32_t)h->n_trees * sizeof(RF_FlatTree_t);
+    if (trees_end > h->image_size) {
+        return false;
+    }
+
+    // Features arrive quantized or normalized per build; the thresholds must match
+#if DSP_QUANTIZED_FEATURES
+    if (h->qscale_offset == 0) {
+        return false;
+    }
+#else
+    if (h->qscale_offset != 0) {
+        return false;
+    }
+#endif
+    if (h->qscale_offset != 0 &&
+        ((h->qscale_offset & 3U) != 0 || h->qscale_offset < trees_end ||
+         h->qscale_offset + (uint32_t)h->n_features * sizeof(float) > h->image_size)) {
+        return false;
+    }
+
+    for (uint8_t w = FEATURE_MASK_WORDS; w < MODEL_SLOT_MASK_WORDS; w++) {
+        if (h->feature_mask[w] != 0) {
+            return false;
+        }
+    }
+
+    if (crc32(base + h->header_size, h->image_size - h->header_size) != h->payload_crc) {
+        return false;
+    }
+
+    memcpy(mask->words, h->feature_mask, sizeof(mask->words));
+    model->trees = (const RF_FlatTree_t *)(base + h->header_size);
+    model->feature_qscale = (h->qscale_offset != 0) ? (const float *)(base + h->qscale_offset) : NULL;
+    model->feature_mask = mask;
+    model->n_trees = h->n_trees;
+    model->n_features = h->n_features;
+    model->n_classes = h->n_classes;
+
+    if (!RF_FlatValidateModel(model)) {
+        return false;
+    }
+
+    // The DSP skips features outside the mask; no reachable split may read one
+    for (uint8_t t = 0; t < model->n_trees; t++) {
+        const RF_FlatTree_t *tree = &model->trees[t];
+
+        for (uint8_t i = 0; i < RF_FLAT_INTERNAL_NODES; i++) {
+            if (tree->threshold[i] != INT16_MAX && !Feature_Mask_Test(mask, tree->feature_idx[i])) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static Model_SlotState_t slot_scan(uint8_t slot)
+{
+    memcpy(&slot_header[slot], (const void *)slot_flash[slot].base, sizeof(slot_header[slot]));
+
+    if (slot_header[slot].magic == SLOT_ERASED_WORD) {
+        return MODEL_SLOT_EMPTY;
+    }
+
+    return slot_check(slot, &slot_header[slot]) ? MODEL_SLOT_VALID : MODEL_SLOT_INVALID;
+}
+
+static void slot_activate(uint8_t slot)
+{
+    taskENTER_CRITICAL();
+    pending_model = slot_to_model(slot);
+    taskEXIT_CRITICAL();
+
+    selected = slot;
+}
+
+// Messages or a pending swap may still refer to a second descriptor
+static bool swap_in_progress(void)
+{
+    return pending_model != NULL || dsp_model != ml_model;
+}
+
+// Slot an upload may overwrite: the one not selected, else the older one
+static uint8_t inactive_slot(void)
+{
+    if (selected != MODEL_SLOT_BUILTIN) {
+        return (uint8_t)(1U - selected);
+    }
+    if (slot_state[0] != MODEL_SLOT_VALID) {
+        return 0;
+    }
+    if (slot_state[1] != MODEL_SLOT_VALID) {
+        return 1;
+    }
+
+    return (slot_header[0].version <= slot_header[1].version) ? 0 : 1;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Validate both slots and load the valid one with the highest version
+ * @param builtin Compiled-in model, used when neither slot is valid
+ * @note Before the scheduler starts; replaces RF_FlatLoadModel at boot
+ */
+HAL_StatusTypeDef ModelSlot_Init(const RF_FlatModel_t *builtin)
+{
+    uint8_t best = MODEL_SLOT_BUILTIN;
+
+    builtin_model = builtin;
+    memset(&upload, 0, sizeof(upload));
+
+    for (uint8_t s = 0; s < MODEL_SLOT_COUNT; s++) {
+        slot_state[s] = slot_scan(s);
+
+        if (slot_state[s] == MODEL_SLOT_VALID &&
+            (best == MODEL_SLOT_BUILTIN || slot_header[s].version > slot_header[best].version)) {
+            best = s;
+        }
+    }
+
+    if (best != MODEL_SLOT_BUILTIN && RF_FlatLoadModel(&slot_model[best]) != HAL_OK) {
+        slot_state[best] = MODEL_SLOT_INVALID;
+        best = MODEL_SLOT_BUILTIN;
+    }
+    if (best == MODEL_SLOT_BUILTIN && RF_FlatLoadModel(builtin) != HAL_OK) {
+        return HAL_ERROR;
+    }
+
+    selected = best;
+    pending_model = NULL;
+    dsp_model = slot_to_model(best);
+    ml_model = dsp_model;
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Model the DSP task currently extracts features for
+ */
+const RF_FlatModel_t *ModelSlot_Current(void)
+{
+    return dsp_model;
+}
+
+/**
+ * @brief Model to adopt before the next window
+ * @return NULL if there is no new model since the last call
+ * @note DSP task only; the caller updates its feature mask and scales and
+ *       stamps the returned model on every following feature message
+ */
+const RF_FlatModel_t *ModelSlot_TakePending(void)
+{
+    const RF_FlatModel_t *model;
+
+    taskENTER_CRITICAL();
+    model = pending_model;
+    pending_model = NULL;
+    if (model != NULL) {
+        dsp_model = model;
+    }
+    taskEXIT_CRITICAL();
+
+    return model;
+}
+
+/**
+ * @brief Acquisition handshake for uploads, polled before every block
+ * @param stopped The caller has stopped taking DRDY frames
+ * @return true while an upload wants acquisition stopped; once it returns
+ *         false the caller restarts acquisition from an empty window
+ * @note DSP task only
+ */
+bool ModelSlot_HoldAcquisition(bool stopped)
+{
+    const bool request = hold_request;
+
+    hold_granted = stopped && request;
+
+    return request;
+}
+
+/**
+ * @brief Record the model the flat engine was switched to
+ * @note ML task only, after RF_FlatLoadModel
+ */
+void ModelSlot_SetRunning(const RF_FlatModel_t *model)
+{
+    ml_model = model;
+}
+
+/**
+ * @brief Report a model RF_FlatLoadModel refused
+ * @note ML task only. The slot is marked invalid and, unless another
+ *       switch is already queued, the DSP task is sent back to the model
+ *       the engine still runs, which also ends the swap
+ */
+void ModelSlot_Reject(const RF_FlatModel_t *model)
+{
+    const uint8_t slot = model_to_slot(model);
+
+    taskENTER_CRITICAL();
+    if (slot != MODEL_SLOT_BUILTIN) {
+        slot_state[slot] = MODEL_SLOT_INVALID;
+    }
+    if (pending_model == NULL && dsp_model == model) {
+        pending_model = ml_model;
+        selected = model_to_slot(ml_model);
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Erase the inactive slot for an upload of image_size bytes
+ * @param slot Receives the slot being written
+ * @return HAL_BUSY while a previous swap has not reached the ML task
+ */
+HAL_StatusTypeDef ModelSlot_BeginUpload(uint32_t image_size, uint8_t *slot)
+{
+    uint8_t target;
+
+    if (image_size <= SLOT_HEADER_BYTES || image_size > MODEL_SLOT_SIZE) {
+        return HAL_ERROR;
+    }
+    if (swap_in_progress()) {
+        return HAL_BUSY;
+    }
+
+    // A restarted upload still holds acquisition; no second handshake
+    if (!upload.active && acquisition_hold() != HAL_OK) {
+        return HAL_TIMEOUT;
+    }
+
+    target = inactive_slot();
+    upload.active = false;
+    slot_state[target] = MODEL_SLOT_UPLOADING;
+    memset(&slot_header[target], 0, sizeof(slot_header[target]));
+
+    if (slot_erase(target) != HAL_OK) {
+        upload_abort(target, MODEL_SLOT_INVALID);
+        return HAL_ERROR;
+    }
+
+    memset(&upload, 0, sizeof(upload));
+    upload.active = true;
+    upload.slot = target;
+    upload.image_size = image_size;
+    upload.last_tick = HAL_GetTick();
+    *slot = target;
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Append image bytes; the payload is programmed a flash word at a time
+ * @param offset Must equal the bytes received so far
+ */
+HAL_StatusTypeDef ModelSlot_WriteUpload(uint32_t offset, const uint8_t *data, uint16_t len)
+{
+    if (!upload.active || offset != upload.received || len > upload.image_size - upload.received) {
+        return HAL_ERROR;
+    }
+    upload.last_tick = HAL_GetTick();
+
+    for (uint16_t i = 0; i < len; i++) {
+        const uint32_t pos = upload.received++;
+
+        if (pos < SLOT_HEADER_BYTES) {
+            ((uint8_t *)&upload.header)[pos] = data[i];
+            continue;
+        }
+
+        ((uint8_t *)upload.word)[pos % SLOT_WORD_BYTES] = data[i];
+
+        if (upload.received % SLOT_WORD_BYTES == 0 &&
+            slot_program(upload.slot, upload.received - SLOT_WORD_BYTES, upload.word) != HAL_OK) {
+            upload_abort(upload.slot, MODEL_SLOT_INVALID);
+            return HAL_ERROR;
+        }
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Check the uploaded image in flash, write its header and switch to it
+ * @note The new model takes effect at the DSP task's next block
+ */
+HAL_StatusTypeDef ModelSlot_CommitUpload(void)
+{
+    const uint8_t slot = upload.slot;
+    const uint32_t tail = upload.received % SLOT_WORD_BYTES;
+
+    if (!upload.active || upload.received != upload.image_size ||
+        upload.header.image_size != upload.image_size) {
+        return HAL_ERROR;
+    }
+    upload.active = false;
+
+    // Last partial word, padded as erased flash
+    if (tail != 0) {
+        memset((uint8_t *)upload.word + tail, 0xFF, SLOT_WORD_BYTES - tail);
+        if (slot_program(slot, upload.received - tail, upload.word) != HAL_OK) {
+            upload_abort(slot, MODEL_SLOT_INVALID);
+            return HAL_ERROR;
+        }
+    }
+    slot_invalidate(slot);
+
+    if (!slot_check(slot, &upload.header)) {
+        upload_abort(slot, MODEL_SLOT_INVALID);
+        return HAL_ERROR;
+    }
+
+    // Header last: the slot becomes bootable only once the image checked out
+    for (uint32_t offset = 0; offset < SLOT_HEADER_BYTES; offset += SLOT_WORD_BYTES) {
+        if (slot_program(slot, offset, (const uint32_t *)((const uint8_t *)&upload.header + offset)) != HAL_OK) {
+            upload_abort(slot, MODEL_SLOT_INVALID);
+            return HAL_ERROR;
+        }
+    }
+    slot_invalidate(slot);
+
+    if (memcmp((const void *)slot_flash[slot].base, &upload.header, SLOT_HEADER_BYTES) != 0) {
+        upload_abort(slot, MODEL_SLOT_INVALID);
+        return HAL_ERROR;
+    }
+
+    acquisition_release();
+    slot_header[slot] = upload.header;
+    slot_state[slot] = MODEL_SLOT_VALID;
+    slot_activate(slot);
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Switch to a valid slot or the built-in model (until the next boot)
+ * @note Boot still prefers the highest valid version
+ */
+HAL_StatusTypeDef ModelSlot_Select(uint8_t slot)
+{
+    if (slot > MODEL_SLOT_BUILTIN ||
+        (slot != MODEL_SLOT_BUILTIN && slot_state[slot] != MODEL_SLOT_VALID)) {
+        return HAL_ERROR;
+    }
+
+    slot_activate(slot);
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Abandon an upload that has been idle for MODEL_SLOT_UPLOAD_TIMEOUT_MS
+ * @note Monitor task, every pass; restarts acquisition
+ */
+void ModelSlot_Poll(void)
+{
+    if (upload.active && HAL_GetTick() - upload.last_tick > MODEL_SLOT_UPLOAD_TIMEOUT_MS) {
+        printf("WARNING: model upload timed out, acquisition resumed\r\n");
+        upload_abort(upload.slot, MODEL_SLOT_EMPTY);
+    }
+}
+
+/**
+ * @brief State and shape of one slot
+ * @param slot 0 = A, 1 = B, MODEL_SLOT_BUILTIN
+ */
+void ModelSlot_GetInfo(uint8_t slot, Model_SlotInfo_t *info)
+{
+    memset(info, 0, sizeof(*info));
+
+    if (slot == MODEL_SLOT_BUILTIN) {
+        info->state = (builtin_model != NULL) ? MODEL_SLOT_VALID : MODEL_SLOT_EMPTY;
+        if (builtin_model != NULL) {
+            info->n_trees = builtin_model->n_trees;
+            info->n_features = builtin_model->n_features;
+            info->n_classes = builtin_model->n_classes;
+        }
+    } else if (slot < MODEL_SLOT_COUNT) {
+        info->state = slot_state[slot];
+        if (slot_state[slot] == MODEL_SLOT_VALID || slot_state[slot] == MODEL_SLOT_INVALID) {
+            info->version = slot_header[slot].version;
+            info->image_size = slot_header[slot].image_size;
+            info->payload_crc = slot_header[slot].payload_crc;
+            info->n_trees = slot_header[slot].n_trees;
+            info->n_features = slot_header[slot].n_features;
+            info->n_classes = slot_header[slot].n_classes;
+        }
+    } else {
+        return;
+    }
+
+    info->active = (selected == slot);
+}
+
+/* Command handlers ----------------------------------------------------------*/
+static const char *const slot_names[MODEL_SLOT_COUNT + 1U] = { "A", "B", "BUILTIN" };
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+static void Command_ModelSlot(const char *args)
+{
+    static const char *const state_names[] = { "EMPTY", "INVALID", "VALID", "UPLOADING" };
+    Model_SlotInfo_t info;
+
+    (void)args;
+    printf("\r\n=== Model Slots ===\r\n");
+
+    for (uint8_t s = 0; s <= MODEL_SLOT_BUILTIN; s++) {
+        ModelSlot_GetInfo(s, &info);
+        printf("%c %-7s %-9s", info.active ? '*' : ' ', slot_names[s], state_names[info.state]);
+        if (info.state == MODEL_SLOT_VALID) {
+            printf(" v%lu, %lu trees, %lu features, %lu classes, %lu bytes",
+                   info.version, (uint32_t)info.n_trees, (uint32_t)info.n_features,
+                   (uint32_t)info.n_classes, info.image_size);
+        }
+        printf("\r\n");
+    }
+
+    if (upload.active) {
+        printf("Upload to %s: %lu of %lu bytes\r\n",
+               slot_names[upload.slot], upload.received, upload.image_size);
+    }
+}
+
+// MODEL:BEGIN <image bytes>
+static void Command_ModelBegin(const char *args)
+{
+    char *end;
+    uint32_t size = strtoul(args, &end, 0);
+    uint8_t slot = 0;
+    HAL_StatusTypeDef status;
+
+    if (end == args) {
+        printf("ERR usage: MODEL:BEGIN <bytes>\r\n");
+        return;
+    }
+
+    status = ModelSlot_BeginUpload(size, &slot);
+    if (status == HAL_BUSY) {
+        printf("ERR model swap in progress, retry\r\n");
+    } else if (status == HAL_TIMEOUT) {
+        printf("ERR acquisition did not pause, retry\r\n");
+    } else if (status != HAL_OK) {
+        printf("ERR size (max %lu) or erase failed\r\n", (uint32_t)MODEL_SLOT_SIZE);
+    } else {
+        printf("OK slot %s, acquisition paused\r\n", slot_names[slot]);
+    }
+}
+
+// MODEL:DATA <offset> <hex bytes>; replies OK <next offset>
+static void Command_ModelData(const char *args)
+{
+    uint8_t data[CMD_MAX_LINE / 2];
+    uint16_t len = 0;
+    char *end;
+    uint32_t offset = strtoul(args, &end, 0);
+
+    if (end == args) {
+        printf("ERR usage: MODEL:DATA <offset> <hex>\r\n");
+        return;
+    }
+    while (*end == ' ') {
+        end++;
+    }
+
+    while (end[0] != '\0' && len < sizeof(data)) {
+        const int hi = hex_nibble(end[0]);
+        const int lo = (hi >= 0) ? hex_nibble(end[1]) : -1;
+
+        if (lo < 0) {
+            printf("ERR bad hex at %lu\r\n", offset + len);
+            return;
+        }
+        data[len++] = (uint8_t)((hi << 4) | lo);
+        end += 2;
+    }
+
+    if (ModelSlot_WriteUpload(offset, data, len) != HAL_OK) {
+        printf("ERR write at %lu, expected %lu\r\n", offset, upload.received);
+        return;
+    }
+
+    printf("OK %lu\r\n", offset + len);
+}
+
+static void Command_ModelCommit(const char *args)
+{
+    (void)args;
+
+    if (ModelSlot_CommitUpload() != HAL_OK) {
+        printf("ERR image incomplete or rejected\r\n");
+        return;
+    }
+
+    printf("OK model v%lu from slot %s\r\n", slot_header[upload.slot].version,
+           slot_names[upload.slot]);
+}
+
+static void Command_ModelSelect(const char *args)
+{
+    for (uint8_t s = 0; s <= MODEL_SLOT_BUILTIN; s++) {
+        if (strcmp(args, slot_names[s]) == 0) {
+            if (ModelSlot_Select(s) != HAL_OK) {
+                printf("ERR slot %s has no valid model\r\n", slot_names[s]);
+            } else {
+                printf("OK model from %s\r\n", slot_names[s]);
+            }
+            return;
+        }
+    }
+
+    printf("ERR usage: MODEL:SELECT A|B|BUILTIN\r\n");
+}
+
+static const Cmd_Entry_t model_commands[] = {
+    {"MODEL:SLOT?",  Command_ModelSlot,   "A/B model slots and the active model"},
+    {"MODEL:BEGIN",  Command_ModelBegin,  "<bytes>: pause acquisition, erase the inactive slot"},
+    {"MODEL:DATA",   Command_ModelData,   "<offset> <hex>: program image bytes"},
+    {"MODEL:COMMIT", Command_ModelCommit, "Validate the upload, switch to it, resume"},
+    {"MODEL:SELECT", Command_ModelSelect, "A | B | BUILTIN: switch to a valid model"},
+};
+
+/**
+ * @brief Add the MODEL:* commands to the debug command dispatcher
+ * @note Monitor task, before its first Cmd_WaitLine
+ */
+HAL_StatusTypeDef ModelSlot_RegisterCommands(void)
+{
+    return Cmd_Register(model_commands, sizeof(model_commands) / sizeof(model_commands[0]));
+}
+
+#endif /* MODEL_SLOTS */
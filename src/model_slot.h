@@ -0,0 +1,163 @@
+/**
+ * @file model_slot.h
+ * @brief A/B flash slots for replacing the flat-engine forest at run time
+ *
+ * Two flash sectors each hold one model image: a Model_SlotHeader_t
+ * (version, CRCs, shape, feature mask) followed by the RF_FlatTree_t
+ * array and, for folded models, the n_features quantization scales. The
+ * trees are read in place from memory-mapped flash; only a small
+ * RF_FlatModel_t descriptor per slot lives in RAM.
+ *
+ * An upload (MODEL:BEGIN / MODEL:DATA / MODEL:COMMIT on the debug UART)
+ * always goes to the slot not in use, so the running model is never
+ * touched. The payload is programmed as it arrives and the header last,
+ * after the image has been checked in flash: a reset or an abandoned
+ * upload leaves a slot without a valid header, which boot ignores.
+ *
+ * The slots share the STM32H7S3's single internal flash bank with the
+ * firmware, so an erase or program stalls every instruction fetch from it,
+ * the vector table and the DRDY / SPI DMA handlers included. Acquisition is
+ * therefore paused for the whole upload rather than losing frames behind
+ * each flash operation: MODEL:BEGIN asks the DSP task to ignore DRDY
+ * (ModelSlot_HoldAcquisition) and erases only once it has, and the
+ * acquisition restarts from an empty window when the upload is committed,
+ * fails, or has been idle for MODEL_SLOT_UPLOAD_TIMEOUT_MS. No gesture is
+ * classified meanwhile; MODEL:SELECT does not touch the flash and does not
+ * pause anything.
+ *
+ * Validation runs in the monitor task. A good image becomes the pending
+ * model; the DSP task adopts it between blocks (feature mask and folded
+ * scales) and stamps every feature message with the model it was
+ * extracted for, and the ML task switches the flat engine only between
+ * batches of messages with the same stamp. No vector is ever classified
+ * by a model other than the one its features were computed for: if the
+ * engine rejects a model, its messages are dropped and the DSP task is
+ * sent back to the model the engine still runs (ModelSlot_Reject).
+ */
+
+#ifndef MODEL_SLOT_H
+#define MODEL_SLOT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32h7xx_hal.h"
+#include "random_forest.h"
+
+/* Build configuration -------------------------------------------------------*/
+#ifndef MODEL_SLOTS
+#define MODEL_SLOTS             0   // 1 = boot from and upload to the A/B slots
+#endif
+
+// Default: last two 8 KB sectors of the STM32H7S3 user flash. The project
+// linker script must end FLASH below MODEL_SLOT_A_ADDR.
+#ifndef MODEL_SLOT_A_ADDR
+#define MODEL_SLOT_A_ADDR       0x0800C000U
+#endif
+#ifndef MODEL_SLOT_B_ADDR
+#define MODEL_SLOT_B_ADDR       0x0800E000U
+#endif
+#ifndef MODEL_SLOT_SIZE
+#define MODEL_SLOT_SIZE         0x00002000U   // One erase sector per slot
+#endif
+#ifndef MODEL_SLOT_A_SECTOR
+#define MODEL_SLOT_A_SECTOR     6U
+#endif
+#ifndef MODEL_SLOT_B_SECTOR
+#define MODEL_SLOT_B_SECTOR     7U
+#endif
+#ifndef MODEL_SLOT_FLASH_BANK
+#define MODEL_SLOT_FLASH_BANK   FLASH_BANK_1
+#endif
+
+// Acquisition pause around an upload
+#ifndef MODEL_SLOT_HOLD_TIMEOUT_MS
+#define MODEL_SLOT_HOLD_TIMEOUT_MS      200U    // DSP task must stop within this (several blocks)
+#endif
+#ifndef MODEL_SLOT_UPLOAD_TIMEOUT_MS
+#define MODEL_SLOT_UPLOAD_TIMEOUT_MS    5000U   // Abandon an upload idle this long, resume acquisition
+#endif
+
+#if MODEL_SLOTS && (RF_INFERENCE_ENGINE != RF_ENGINE_FLAT)
+#error "MODEL_SLOTS needs RF_INFERENCE_ENGINE == RF_ENGINE_FLAT"
+#endif
+
+/* Exported constants --------------------------------------------------------*/
+#define MODEL_SLOT_COUNT        2U
+#define MODEL_SLOT_BUILTIN      MODEL_SLOT_COUNT   // Slot index of the compiled-in model
+
+#define MODEL_SLOT_MAGIC        0x534C4652U   // "RFLS"
+#define MODEL_SLOT_FORMAT       1U
+#define MODEL_SLOT_MASK_WORDS   8U            // Header mask capacity, 256 features
+
+/* Exported types ------------------------------------------------------------*/
+// Start of every slot image; 64 bytes, a whole number of flash words.
+// Written by RandomForestEMG.export_model_slot()
+typedef struct {
+    uint32_t magic;           // MODEL_SLOT_MAGIC
+    uint16_t format;          // MODEL_SLOT_FORMAT
+    uint16_t header_size;     // sizeof(Model_SlotHeader_t); trees start here
+    uint32_t version;         // Boot picks the valid slot with the highest
+    uint32_t image_size;      // Header + payload bytes
+    uint32_t payload_crc;     // CRC-32 (zlib) of bytes header_size .. image_size-1
+    uint8_t n_trees;
+    uint8_t n_features;
+    uint8_t n_classes;
+    uint8_t reserved;         // 0
+    uint32_t qscale_offset;   // n_features floats from the slot start, 0 if thresholds are Q8.8
+    uint32_t feature_mask[MODEL_SLOT_MASK_WORDS];   // Feature_Mask_t words, rest 0
+    uint32_t header_crc;      // CRC-32 of the preceding header bytes
+} Model_SlotHeader_t;
+
+typedef enum {
+    MODEL_SLOT_EMPTY = 0,     // Erased, or no header yet
+    MODEL_SLOT_INVALID,       // Header present, image failed a check
+    MODEL_SLOT_VALID,
+    MODEL_SLOT_UPLOADING      // Erased for an upload in progress
+} Model_SlotState_t;
+
+typedef struct {
+    Model_SlotState_t state;
+    uint32_t version;
+    uint32_t image_size;
+    uint32_t payload_crc;
+    uint8_t n_trees;
+    uint8_t n_features;
+    uint8_t n_classes;
+    bool active;              // Selected model (may still be pending)
+} Model_SlotInfo_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+// Boot: validate both slots and load the newest valid one, else builtin
+HAL_StatusTypeDef ModelSlot_Init(const RF_FlatModel_t *builtin);
+const RF_FlatModel_t *ModelSlot_Current(void);
+void ModelSlot_GetInfo(uint8_t slot, Model_SlotInfo_t *info);   // 0 = A, 1 = B, MODEL_SLOT_BUILTIN
+
+// DSP task: model to adopt before the next window, NULL if unchanged
+const RF_FlatModel_t *ModelSlot_TakePending(void);
+// DSP task: true while an upload needs acquisition stopped; stopped = DRDY is ignored
+bool ModelSlot_HoldAcquisition(bool stopped);
+// ML task: model the flat engine now runs, or one RF_FlatLoadModel refused
+void ModelSlot_SetRunning(const RF_FlatModel_t *model);
+void ModelSlot_Reject(const RF_FlatModel_t *model);
+
+// Monitor task: upload into the inactive slot, then validate and activate it
+HAL_StatusTypeDef ModelSlot_BeginUpload(uint32_t image_size, uint8_t *slot);   // HAL_BUSY mid-swap,
+                                                                              // HAL_TIMEOUT if not paused
+HAL_StatusTypeDef ModelSlot_WriteUpload(uint32_t offset, const uint8_t *data, uint16_t len);
+HAL_StatusTypeDef ModelSlot_CommitUpload(void);
+HAL_StatusTypeDef ModelSlot_Select(uint8_t slot);             // Roll back to a valid slot or builtin
+void ModelSlot_Poll(void);                                     // Every pass: abandon idle uploads
+
+// MODEL:* commands on the debug UART
+HAL_StatusTypeDef ModelSlot_RegisterCommands(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MODEL_SLOT_H */
@@ -8,8 +8,32 @@ import numpy as np
 from sklearn.ensemble import RandomForestClassifier
 from sklearn.model_selection import cross_val_score, StratifiedKFold
 from typing import Dict, Tuple, Optional
+import math
 import pickle
 import struct
+import warnings
+import zlib
+
+
+# Flattened layout (must match RF_FLAT_* in random_forest.h)
+RF_FLAT_DEPTH = 6
+RF_FLAT_INTERNAL_NODES = (1 << RF_FLAT_DEPTH) - 1
+RF_FLAT_LEAVES = 1 << RF_FLAT_DEPTH
+Q8_8_MAX = 32767
+Q8_8_MIN = -32768
+RF_MAX_TREES = 15
+RF_VOTE_WEIGHT = 255                # One tree's vote; uint8 leaf probability scale
+
+# Compact layout (must match RF_COMPACT_* in random_forest.h)
+RF_COMPACT_MAX_NODES = 127
+RF_COMPACT_MAX_THRESHOLDS = 256
+
+# A/B slot image (must match Model_SlotHeader_t in model_slot.h)
+MODEL_SLOT_MAGIC = 0x534C4652       # "RFLS"
+MODEL_SLOT_FORMAT = 1
+MODEL_SLOT_HEADER_SIZE = 64
+MODEL_SLOT_MASK_WORDS = 8
+MODEL_SLOT_SIZE = 0x2000            # Default MODEL_SLOT_SIZE
 
 
 class RandomForestEMG:
@@ -50,6 +74,7 @@ class RandomForestEMG:
         self.n_classes = None
         self.feature_names = None
         self.class_names = None
+        self.feature_max_abs = None
         
     def train(self, X_train: np.ndarray, y_train: np.ndarray, 
               feature_names: Optional[list] = None,
@@ -71,6 +96,9 @@ class RandomForestEMG:
         self.feature_names = feature_names
         self.class_names = class_names
         
+        # Feature ranges for folding normalization into thresholds
+        self.feature_max_abs = np.max(np.abs(X_train), axis=0)
+        
         # Train model
         self.model.fit(X_train, y_train)
         
@@ -144,14 +172,59 @@ class RandomForestEMG:
             'ram_usage_kb': ram_usage / 1024
         }
     
-    def export_to_c_header(self, filepath: str, model_name: str = "rf_model"):
+    def export_to_c_header(self, filepath: str, model_name: str = "rf_model",
+                           layout: str = "nodes", fold_normalization: bool = False,
+                           leaf_proba: bool = False, lossy_thresholds: bool = False,
+                           check_X: Optional[np.ndarray] = None):
         """
         Export model to C header file for embedded deployment.
         
         Args:
             filepath: Output file path
             model_name: Name for the model variable
+            layout: "nodes" for RF_Model_t (interpreted node table),
+                    "flat" for RF_FlatModel_t (implicit complete trees),
+                    "code" for RF_CodeModel_t (one generated function per tree) or
+                    "compact" for RF_CompactModel_t (4-byte nodes, shared
+                    threshold table, trees of any depth)
+            fold_normalization: For "flat"/"code"/"compact", quantize thresholds per
+                    feature as floor(t * scale) and emit the scales, so the
+                    firmware compares int16 features directly (no
+                    RF_NormalizeFeatures)
+            leaf_proba: For "compact", also emit each leaf's class
+                    distribution as uint8 summing to 255, so trees vote
+                    soft (probability-weighted) instead of one class each
+            lossy_thresholds: For "compact", allow merging nearby thresholds
+                    when the forest has more than RF_COMPACT_MAX_THRESHOLDS
+                    distinct ones; the exported model then decides
+                    differently near the merged thresholds. Requires check_X
+            check_X: For "compact", feature vectors to classify with the
+                    exported model as the firmware would; the agreement
+                    with the sklearn model is written to the header and a
+                    warning is raised on any disagreement
         """
+        if leaf_proba and layout != "compact":
+            raise ValueError("leaf_proba requires layout 'compact'")
+        if (lossy_thresholds or check_X is not None) and layout != "compact":
+            raise ValueError("lossy_thresholds and check_X require layout 'compact'")
+        if lossy_thresholds and check_X is None:
+            raise ValueError("lossy_thresholds requires check_X to measure the effect")
+        qscale = self._feature_qscales() if fold_normalization else None
+        if layout == "flat":
+            self._export_flat_c_header(filepath, model_name, qscale)
+            return
+        if layout == "code":
+            self._export_code_c_header(filepath, model_name, qscale)
+            return
+        if layout == "compact":
+            self._export_compact_c_header(filepath, model_name, qscale, leaf_proba,
+                                          lossy_thresholds, check_X)
+            return
+        if fold_normalization:
+            raise ValueError("fold_normalization requires layout 'flat', 'code' or 'compact'")
+        if layout != "nodes":
+            raise ValueError(f"Unknown export layout: {layout}")
+        
         with open(filepath, 'w') as f:
             # Write header guard
             f.write(f"#ifndef {model_name.upper()}_H\n")
@@ -169,19 +242,22 @@ class RandomForestEMG:
             
             # Write feature normalization parameters (placeholder)
             f.write("// Feature normalization parameters (Q8.8 format)\n")
-            f.write(f"const fixed_point_t {model_name}_feature_scale[{self.n_features}] = {{\n")
+            f.write(f"RF_MODEL_DATA const fixed_point_t {model_name}_feature_scale[{self.n_features}] = {{\n")
             for i in range(self.n_features):
                 f.write(f"    256,  // Feature {i}\n")
             f.write("};\n\n")
             
-            f.write(f"const fixed_point_t {model_name}_feature_offset[{self.n_features}] = {{\n")
+            f.write(f"RF_MODEL_DATA const fixed_point_t {model_name}_feature_offset[{self.n_features}] = {{\n")
             for i in range(self.n_features):
                 f.write(f"    0,  // Feature {i}\n")
             f.write("};\n\n")
             
+            mask_ref = self._write_feature_mask(f, model_name)
+            
             # Write tree data
             f.write(f"// Random Forest model data\n")
-            f.write(f"const RF_Model_t {model_name} = {{\n")
+            f.write(f"RF_MODEL_DATA const RF_Model_t {model_name} = {{\n")
+            f.write(f"    .feature_mask = {mask_ref},\n")
             f.write(f"    .n_trees = {len(self.model.estimators_)},\n")
             f.write(f"    .n_features = {self.n_features},\n")
             f.write(f"    .n_classes = {self.n_classes},\n")
@@ -219,6 +295,491 @@ class RandomForestEMG:
             # Write footer
             f.write(f"#endif // {model_name.upper()}_H\n")
     
+    @staticmethod
+    def _to_q8_8(value: float) -> int:
+        """Convert to Q8.8, truncating like the node exporter and saturating."""
+        return int(np.clip(int(value * 256), Q8_8_MIN, Q8_8_MAX))
+    
+    def _feature_qscales(self) -> list:
+        """
+        Per-feature quantization scales mapping the training range onto int16.
+        
+        The firmware computes q = sat16(x * scale) in DSP_QuantizeFeatures.
+        """
+        if self.feature_max_abs is None:
+            raise ValueError("Feature ranges unknown; train the model before folding")
+        scales = [Q8_8_MAX / float(m) if m > 0 else 1.0 for m in self.feature_max_abs]
+        # Round to float32 so thresholds match the firmware's arithmetic
+        return [struct.unpack('f', struct.pack('f', v))[0] for v in scales]
+    
+    @staticmethod
+    def _quantize_threshold(value: float, feature: int, qscale: Optional[list]) -> int:
+        """Threshold in the firmware feature domain (Q8.8 or folded int16)."""
+        if qscale is None:
+            return RandomForestEMG._to_q8_8(value)
+        # floor keeps x <= t  =>  q(x) <= q(t) for the monotone quantizer
+        return int(np.clip(math.floor(value * qscale[feature]), Q8_8_MIN, Q8_8_MAX))
+    
+    @staticmethod
+    def _write_qscale(f, model_name: str, qscale: Optional[list]) -> str:
+        """Emit the folded scales; returns the C initializer for feature_qscale."""
+        if qscale is None:
+            return "NULL"
+        f.write("// Folded normalization: q = sat16(x * scale)\n")
+        f.write(f"RF_MODEL_DATA static const float {model_name}_feature_qscale[{len(qscale)}] = {{\n")
+        for i, scale in enumerate(qscale):
+            f.write(f"    {float(scale)!r}f,  // Feature {i}\n")
+        f.write("};\n\n")
+        return f"{model_name}_feature_qscale"
+    
+    def used_features(self) -> list:
+        """Sorted indices of the features referenced by any split of any tree."""
+        used = set()
+        for estimator in self.model.estimators_:
+            feature = estimator.tree_.feature
+            used.update(int(i) for i in feature[feature >= 0])
+        return sorted(used)
+    
+    def _write_feature_mask(self, f, model_name: str) -> str:
+        """Emit the used-feature Feature_Mask_t; returns the C initializer for feature_mask."""
+        used = self.used_features()
+        words = [0] * ((self.n_features + 31) // 32)
+        for i in used:
+            words[i // 32] |= 1 << (i % 32)
+        f.write(f"// Features read by the trees ({len(used)} of {self.n_features}); "
+                f"DSP_ExtractFeatures skips the rest\n")
+        f.write(f"RF_MODEL_DATA static const Feature_Mask_t {model_name}_feature_mask = {{\n")
+        f.write("    .words = {" + ", ".join(f"0x{w:08X}U" for w in words) + "}\n")
+        f.write("};\n\n")
+        return f"&{model_name}_feature_mask"
+    
+    @staticmethod
+    def _flatten_tree(tree, qscale: Optional[list] = None) -> Tuple[list, list, list]:
+        """
+        Lay out a fitted sklearn tree as an implicit complete binary tree.
+        
+        Leaves above RF_FLAT_DEPTH are padded with always-left nodes
+        (threshold Q8_8_MAX) whose leaves repeat the leaf class.
+        
+        Returns:
+            feature_idx, threshold, leaf_class lists
+        """
+        if tree.max_depth > RF_FLAT_DEPTH:
+            raise ValueError(f"Tree depth {tree.max_depth} exceeds flat layout "
+                             f"depth {RF_FLAT_DEPTH}")
+        
+        feature_idx = [0] * RF_FLAT_INTERNAL_NODES
+        threshold = [Q8_8_MAX] * RF_FLAT_INTERNAL_NODES
+        leaf_class = [0] * RF_FLAT_LEAVES
+        
+        def fill(node: int, pos: int, level: int):
+            is_leaf = tree.feature[node] < 0
+            if level == RF_FLAT_DEPTH:
+                leaf_class[pos - RF_FLAT_INTERNAL_NODES] = int(np.argmax(tree.value[node]))
+                return
+            if is_leaf:
+                # Padding node: x > INT16_MAX never holds, always go left
+                fill(node, 2 * pos + 1, level + 1)
+                fill(node, 2 * pos + 2, level + 1)
+                return
+            feature_idx[pos] = int(tree.feature[node])
+            threshold[pos] = RandomForestEMG._quantize_threshold(
+                tree.threshold[node], feature_idx[pos], qscale)
+            fill(tree.children_left[node], 2 * pos + 1, level + 1)
+            fill(tree.children_right[node], 2 * pos + 2, level + 1)
+        
+        fill(0, 0, 0)
+        return feature_idx, threshold, leaf_class
+    
+    def _export_flat_c_header(self, filepath: str, model_name: str,
+                              qscale: Optional[list] = None):
+        """Export model as RF_FlatModel_t for RF_FlatLoadModel()."""
+        with open(filepath, 'w') as f:
+            guard = f"{model_name.upper()}_FLAT_H"
+            f.write(f"#ifndef {guard}\n")
+            f.write(f"#define {guard}\n\n")
+            
+            f.write('#include <stdint.h>\n')
+            f.write('#include "random_forest.h"\n\n')
+            
+            f.write(f"// Model: {model_name} (flattened layout, depth {RF_FLAT_DEPTH})\n")
+            f.write(f"// Trees: {len(self.model.estimators_)}\n")
+            f.write(f"// Features: {self.n_features}\n")
+            f.write(f"// Classes: {self.n_classes}\n\n")
+            
+            n_trees = len(self.model.estimators_)
+            f.write(f"RF_MODEL_DATA static const RF_FlatTree_t {model_name}_flat_trees[{n_trees}] = {{\n")
+            for tree_idx, estimator in enumerate(self.model.estimators_):
+                feature_idx, threshold, leaf_class = self._flatten_tree(estimator.tree_, qscale)
+                f.write(f"    {{ // Tree {tree_idx}\n")
+                f.write("        .threshold = {" + ", ".join(map(str, threshold)) + "},\n")
+                f.write("        .feature_idx = {" + ", ".join(map(str, feature_idx)) + "},\n")
+                f.write("        .leaf_class = {" + ", ".join(map(str, leaf_class)) + "}\n")
+                f.write("    },\n")
+            f.write("};\n\n")
+            
+            qscale_ref = self._write_qscale(f, model_name, qscale)
+            mask_ref = self._write_feature_mask(f, model_name)
+            
+            f.write(f"RF_MODEL_DATA const RF_FlatModel_t {model_name}_flat = {{\n")
+            f.write(f"    .trees = {model_name}_flat_trees,\n")
+            f.write(f"    .feature_qscale = {qscale_ref},\n")
+            f.write(f"    .feature_mask = {mask_ref},\n")
+            f.write(f"    .n_trees = {n_trees},\n")
+            f.write(f"    .n_features = {self.n_features},\n")
+            f.write(f"    .n_classes = {self.n_classes}\n")
+            f.write("};\n\n")
+            
+            f.write(f"#endif // {guard}\n")
+    
+    def export_model_slot(self, filepath: str, version: int,
+                          fold_normalization: bool = False,
+                          slot_size: int = MODEL_SLOT_SIZE):
+        """
+        Write a binary A/B flash slot image for MODEL:BEGIN / MODEL:DATA /
+        MODEL:COMMIT (model_slot.h, src/utils/upload_model.py).
+        
+        The trees are the RF_FlatTree_t records of layout="flat", followed
+        by the folded scales when fold_normalization is set; this must match
+        DSP_QUANTIZED_FEATURES of the firmware, which rejects the image
+        otherwise. An unfolded image is normalized with the firmware's
+        built-in RF_Model_t parameters.
+        
+        Args:
+            filepath: Output .bin path
+            version: Slot version; boot runs the valid slot with the highest
+            fold_normalization: As for export_to_c_header
+            slot_size: MODEL_SLOT_SIZE of the firmware build
+        """
+        n_trees = len(self.model.estimators_)
+        if n_trees > RF_MAX_TREES:
+            raise ValueError(f"{n_trees} trees exceed RF_MAX_TREES ({RF_MAX_TREES})")
+        if self.n_features > 32 * MODEL_SLOT_MASK_WORDS:
+            raise ValueError("Feature mask does not fit the slot header")
+        
+        qscale = self._feature_qscales() if fold_normalization else None
+        payload = bytearray()
+        for estimator in self.model.estimators_:
+            feature_idx, threshold, leaf_class = self._flatten_tree(estimator.tree_, qscale)
+            # RF_FlatTree_t: int16 threshold[63], uint8 feature_idx[63],
+            # uint8 leaf_class[64], 1 byte tail padding (254 bytes)
+            payload += struct.pack(f"<{RF_FLAT_INTERNAL_NODES}h", *threshold)
+            payload += bytes(feature_idx) + bytes(leaf_class) + b"\x00"
+        
+        qscale_offset = 0
+        if qscale is not None:
+            payload += b"\x00" * (-(MODEL_SLOT_HEADER_SIZE + len(payload)) % 4)
+            qscale_offset = MODEL_SLOT_HEADER_SIZE + len(payload)
+            payload += struct.pack(f"<{len(qscale)}f", *qscale)
+        
+        image_size = MODEL_SLOT_HEADER_SIZE + len(payload)
+        if image_size > slot_size:
+            raise ValueError(f"Slot image of {image_size} bytes exceeds the {slot_size}-byte slot")
+        
+        mask = [0] * MODEL_SLOT_MASK_WORDS
+        for i in self.used_features():
+            mask[i // 32] |= 1 << (i % 32)
+        
+        header = struct.pack("<IHHIIIBBBBI8I", MODEL_SLOT_MAGIC, MODEL_SLOT_FORMAT,
+                             MODEL_SLOT_HEADER_SIZE, version, image_size, zlib.crc32(payload),
+                             n_trees, self.n_features, self.n_classes, 0, qscale_offset, *mask)
+        header += struct.pack("<I", zlib.crc32(header))
+        
+        with open(filepath, 'wb') as f:
+            f.write(header)
+            f.write(payload)
+    
+    @staticmethod
+    def _tree_to_c(tree, node: int, indent: int, qscale: Optional[list] = None) -> list:
+        """Emit one sklearn tree as nested if/else with immediate thresholds."""
+        pad = "    " * indent
+        if tree.feature[node] < 0:
+            return [f"{pad}return {int(np.argmax(tree.value[node]))};"]
+        feature = int(tree.feature[node])
+        threshold = RandomForestEMG._quantize_threshold(tree.threshold[node], feature, qscale)
+        lines = [f"{pad}if (x[{feature}] <= {threshold}) {{"]
+        lines += RandomForestEMG._tree_to_c(tree, tree.children_left[node], indent + 1, qscale)
+        lines.append(f"{pad}}} else {{")
+        lines += RandomForestEMG._tree_to_c(tree, tree.children_right[node], indent + 1, qscale)
+        lines.append(f"{pad}}}")
+        return lines
+    
+    def _export_code_c_header(self, filepath: str, model_name: str,
+                              qscale: Optional[list] = None):
+        """Export model as generated tree functions for RF_CodeLoadModel()."""
+        n_trees = len(self.model.estimators_)
+        with open(filepath, 'w') as f:
+            guard = f"{model_name.upper()}_CODE_H"
+            f.write(f"#ifndef {guard}\n")
+            f.write(f"#define {guard}\n\n")
+            
+            f.write('#include <stdint.h>\n')
+            f.write('#include "random_forest.h"\n\n')
+            
+            f.write(f"// Model: {model_name} (generated code)\n")
+            f.write(f"// Trees: {n_trees}\n")
+            f.write(f"// Features: {self.n_features}\n")
+            f.write(f"// Classes: {self.n_classes}\n\n")
+            
+            for tree_idx, estimator in enumerate(self.model.estimators_):
+                f.write(f"RF_ITCM_CODE static uint8_t {model_name}_tree_{tree_idx}"
+                        f"(const fixed_point_t *x)\n{{\n")
+                if estimator.tree_.feature[0] < 0:
+                    f.write("    (void)x;  // Single-leaf tree\n")
+                f.write("\n".join(self._tree_to_c(estimator.tree_, 0, 1, qscale)))
+                f.write("\n}\n\n")
+            
+            f.write(f"static const RF_TreeFn_t {model_name}_code_trees[{n_trees}] = {{\n")
+            for tree_idx in range(n_trees):
+                f.write(f"    {model_name}_tree_{tree_idx},\n")
+            f.write("};\n\n")
+            
+            qscale_ref = self._write_qscale(f, model_name, qscale)
+            mask_ref = self._write_feature_mask(f, model_name)
+            
+            f.write(f"const RF_CodeModel_t {model_name}_code = {{\n")
+            f.write(f"    .trees = {model_name}_code_trees,\n")
+            f.write(f"    .feature_qscale = {qscale_ref},\n")
+            f.write(f"    .feature_mask = {mask_ref},\n")
+            f.write(f"    .n_trees = {n_trees},\n")
+            f.write(f"    .n_features = {self.n_features},\n")
+            f.write(f"    .n_classes = {self.n_classes}\n")
+            f.write("};\n\n")
+            
+            f.write(f"#endif // {guard}\n")
+    
+    @staticmethod
+    def _compact_tree(tree, qscale: Optional[list] = None) -> Tuple[list, list, list]:
+        """
+        Lay out a fitted sklearn tree as RF_CompactNode_t records.
+        
+        Internal nodes are numbered in pre-order, so every child link points
+        forward; a leaf child is stored as ~leaf_index.
+        
+        Returns:
+            nodes as [feature, threshold, left, right] (threshold still a
+            value, not a table index), leaf classes, leaf class
+            distributions (RF_VOTE_WEIGHT per leaf)
+        """
+        nodes = []
+        leaves = []
+        probas = []
+        
+        def visit(node: int) -> int:
+            if tree.feature[node] < 0:
+                leaves.append(int(np.argmax(tree.value[node])))
+                probas.append(RandomForestEMG._quantize_proba(tree.value[node][0]))
+                return ~(len(leaves) - 1)
+            idx = len(nodes)
+            feature = int(tree.feature[node])
+            nodes.append([feature, RandomForestEMG._quantize_threshold(tree.threshold[node], feature, qscale), 0, 0])
+            nodes[idx][2] = visit(tree.children_left[node])
+            nodes[idx][3] = visit(tree.children_right[node])
+            return idx
+        
+        visit(0)
+        if len(nodes) > RF_COMPACT_MAX_NODES:
+            raise ValueError(f"Tree has {len(nodes)} splits; compact layout allows "
+                             f"{RF_COMPACT_MAX_NODES}")
+        return nodes, leaves, probas
+    
+    @staticmethod
+    def _quantize_proba(counts) -> list:
+        """
+        Leaf class distribution as uint8 summing exactly to RF_VOTE_WEIGHT.
+        
+        Largest-remainder rounding: every tree then adds the same weight,
+        which the firmware's absolute-majority early exit relies on.
+        """
+        counts = [float(c) for c in counts]
+        total = sum(counts)
+        exact = [c * RF_VOTE_WEIGHT / total for c in counts]
+        proba = [int(math.floor(e)) for e in exact]
+        by_remainder = sorted(range(len(counts)), key=lambda c: proba[c] - exact[c])
+        for c in by_remainder[:RF_VOTE_WEIGHT - sum(proba)]:
+            proba[c] += 1
+        return proba
+    
+    @staticmethod
+    def _threshold_table(values: list, max_entries: int = RF_COMPACT_MAX_THRESHOLDS,
+                         lossy: bool = False) -> Tuple[list, dict, int]:
+        """
+        Shared threshold table for the compact layout.
+        
+        With more than max_entries distinct thresholds the table does not fit
+        and a ValueError is raised, unless lossy is set: then the closest
+        adjacent values are merged until it fits, each group represented by
+        its rounded mean. The table is shared by all features, so a merge can
+        join thresholds of features with unrelated scales; only inputs
+        between an original threshold and its representative change branch.
+        
+        Returns:
+            table (sorted), index of each original value, largest shift
+        """
+        groups = [[v] for v in sorted(set(values))]
+        if len(groups) > max_entries and not lossy:
+            raise ValueError(f"{len(groups)} distinct thresholds exceed the compact table "
+                             f"({max_entries}); use fewer or shallower trees, another "
+                             f"layout, or lossy_thresholds=True with check_X")
+        while len(groups) > max_entries:
+            i = min(range(len(groups) - 1), key=lambda k: groups[k + 1][0] - groups[k][-1])
+            groups[i:i + 2] = [groups[i] + groups[i + 1]]
+        
+        table = []
+        index = {}
+        max_shift = 0
+        for group in groups:
+            centre = int(round(sum(group) / len(group)))
+            for v in group:
+                index[v] = len(table)
+                max_shift = max(max_shift, abs(v - centre))
+            table.append(centre)
+        return table, index, max_shift
+    
+    @staticmethod
+    def _firmware_inputs(X: np.ndarray, qscale: Optional[list] = None) -> np.ndarray:
+        """
+        Feature vectors in the domain the firmware compares against thresholds:
+        FLOAT_TO_FIXED (Q8.8, as the thresholds) or, folded, DSP_QuantizeFeatures.
+        """
+        X = np.asarray(X, dtype=np.float32)
+        if qscale is None:
+            q = np.trunc(X * np.float32(256.0) + np.float32(0.5))
+        else:
+            q = np.floor(X * np.asarray(qscale, dtype=np.float32))
+        return np.clip(q, Q8_8_MIN, Q8_8_MAX).astype(np.int32)
+    
+    def _compact_predict(self, trees: list, table: list, index: dict, leaf_proba: bool,
+                         X: np.ndarray, qscale: Optional[list] = None) -> np.ndarray:
+        """
+        Labels the firmware's compact engine returns for X (full vote, no early
+        exit): the traversal of compact_leaf and the argmax of RF_Vote_GetResult.
+        """
+        Q = self._firmware_inputs(X, qscale)
+        votes = np.zeros((len(Q), self.n_classes), dtype=np.int64)
+        for nodes, leaves, probas in trees:
+            for s, q in enumerate(Q):
+                i = 0 if nodes else -1
+                while i >= 0:
+                    feature, threshold, left, right = nodes[i]
+                    i = left if q[feature] <= table[index[threshold]] else right
+                if leaf_proba:
+                    votes[s] += probas[~i]
+                else:
+                    votes[s, leaves[~i]] += RF_VOTE_WEIGHT
+        # argmax keeps the first of equal weights, as the firmware does
+        return self.model.classes_[np.argmax(votes, axis=1)]
+    
+    def _export_compact_c_header(self, filepath: str, model_name: str,
+                                 qscale: Optional[list] = None, leaf_proba: bool = False,
+                                 lossy_thresholds: bool = False,
+                                 check_X: Optional[np.ndarray] = None):
+        """Export model as RF_CompactModel_t for RF_CompactLoadModel()."""
+        trees = [self._compact_tree(e.tree_, qscale) for e in self.model.estimators_]
+        n_trees = len(trees)
+        if n_trees > RF_MAX_TREES:
+            raise ValueError(f"{n_trees} trees exceed RF_MAX_TREES ({RF_MAX_TREES})")
+        
+        table, index, max_shift = self._threshold_table(
+            [node[1] for nodes, _, _ in trees for node in nodes] or [0],
+            lossy=lossy_thresholds)
+        
+        agree = None
+        if check_X is not None:
+            exported = self._compact_predict(trees, table, index, leaf_proba, check_X, qscale)
+            agree = int(np.sum(exported == self.model.predict(check_X)))
+            if agree < len(exported):
+                warnings.warn(f"Exported compact model disagrees with sklearn on "
+                              f"{len(exported) - agree} of {len(exported)} check vectors")
+        n_nodes = sum(len(nodes) for nodes, _, _ in trees)
+        n_leaves = sum(len(leaves) for _, leaves, _ in trees)
+        n_bytes = 4 * n_nodes + n_leaves + 2 * (n_trees + 1) + 2 * len(table)
+        if leaf_proba:
+            n_bytes += n_leaves * self.n_classes
+        
+        with open(filepath, 'w') as f:
+            guard = f"{model_name.upper()}_COMPACT_H"
+            f.write(f"#ifndef {guard}\n")
+            f.write(f"#define {guard}\n\n")
+            
+            f.write('#include <stdint.h>\n')
+            f.write('#include "random_forest.h"\n\n')
+            
+            f.write(f"// Model: {model_name} (compact layout"
+                    f"{', soft votes' if leaf_proba else ''})\n")
+            f.write(f"// Trees: {n_trees}\n")
+            f.write(f"// Features: {self.n_features}\n")
+            f.write(f"// Classes: {self.n_classes}\n")
+            f.write(f"// Splits: {n_nodes}, leaves: {n_leaves}, thresholds: {len(table)}, "
+                    f"{n_bytes} bytes\n")
+            if max_shift > 0:
+                f.write(f"// Thresholds merged to fit {RF_COMPACT_MAX_THRESHOLDS} entries; "
+                        f"largest shift {max_shift} LSB\n")
+            if agree is not None:
+                f.write(f"// Check: {agree} of {len(check_X)} vectors classified as by sklearn\n")
+            f.write("\n")
+            
+            f.write(f"RF_MODEL_DATA static const fixed_point_t {model_name}_compact_thresholds"
+                    f"[{len(table)}] = {{\n")
+            for i in range(0, len(table), 12):
+                f.write("    " + ", ".join(str(t) for t in table[i:i + 12]) + ",\n")
+            f.write("};\n\n")
+            
+            # A forest of single-leaf trees still needs a non-empty array
+            f.write(f"RF_MODEL_DATA static const RF_CompactNode_t {model_name}_compact_nodes"
+                    f"[{max(n_nodes, 1)}] = {{\n")
+            for tree_idx, (nodes, _, _) in enumerate(trees):
+                f.write(f"    // Tree {tree_idx}\n")
+                for feature, threshold, left, right in nodes:
+                    f.write(f"    {{ {feature}, {index[threshold]}, {left}, {right} }},\n")
+            if n_nodes == 0:
+                f.write("    { 0, 0, -1, -1 },  // Unused\n")
+            f.write("};\n\n")
+            
+            f.write(f"RF_MODEL_DATA static const uint8_t {model_name}_compact_leaves[{n_leaves}] = {{\n")
+            for tree_idx, (_, leaves, _) in enumerate(trees):
+                f.write(f"    {', '.join(map(str, leaves))},  // Tree {tree_idx}\n")
+            f.write("};\n\n")
+            
+            starts = [0]
+            for nodes, _, _ in trees:
+                starts.append(starts[-1] + len(nodes))
+            f.write(f"RF_MODEL_DATA static const uint16_t {model_name}_compact_node_start"
+                    f"[{n_trees + 1}] = {{\n")
+            f.write("    " + ", ".join(map(str, starts)) + "\n")
+            f.write("};\n\n")
+            
+            proba_ref = "NULL"
+            if leaf_proba:
+                proba_ref = f"{model_name}_compact_leaf_proba"
+                f.write(f"// Class distribution per leaf, {RF_VOTE_WEIGHT} per row\n")
+                f.write(f"RF_MODEL_DATA static const uint8_t {proba_ref}"
+                        f"[{n_leaves * self.n_classes}] = {{\n")
+                for tree_idx, (_, _, probas) in enumerate(trees):
+                    f.write(f"    // Tree {tree_idx}\n")
+                    for proba in probas:
+                        f.write("    " + ", ".join(map(str, proba)) + ",\n")
+                f.write("};\n\n")
+            
+            qscale_ref = self._write_qscale(f, model_name, qscale)
+            mask_ref = self._write_feature_mask(f, model_name)
+            
+            f.write(f"RF_MODEL_DATA const RF_CompactModel_t {model_name}_compact = {{\n")
+            f.write(f"    .nodes = {model_name}_compact_nodes,\n")
+            f.write(f"    .leaf_class = {model_name}_compact_leaves,\n")
+            f.write(f"    .node_start = {model_name}_compact_node_start,\n")
+            f.write(f"    .thresholds = {model_name}_compact_thresholds,\n")
+            f.write(f"    .feature_qscale = {qscale_ref},\n")
+            f.write(f"    .feature_mask = {mask_ref},\n")
+            f.write(f"    .leaf_proba = {proba_ref},\n")
+            f.write(f"    .n_thresholds = {len(table)},\n")
+            f.write(f"    .n_trees = {n_trees},\n")
+            f.write(f"    .n_features = {self.n_features},\n")
+            f.write(f"    .n_classes = {self.n_classes}\n")
+            f.write("};\n\n")
+            
+            f.write(f"#endif // {guard}\n")
+    
     def save_model(self, filepath: str):
         """Save model to pickle file."""
         with open(filepath, 'wb') as f:
@@ -2,6 +2,7 @@
 import os
 import string
 import pickle
+import struct
 import scipy.io
 import numpy as np
 import tensorflow as tf
@@ -408,3 +409,191 @@ def load_dataset(dataset_name: str = None,
 
     return train_ds, val_ds, test_ds #quantization_ds,
 
+
+
+# Firmware EMG stream (EMG:STREAM) -----------------------------------------
+# Frame layout is defined in src/emg_stream.h:
+#   SOF 0xAA | LEN u16 | TYPE u8 | PAYLOAD[LEN] | CRC16-CCITT u16 (over LEN..PAYLOAD)
+
+STREAM_SOF = 0xAA
+STREAM_TYPE_RAW = 0x01
+STREAM_TYPE_FEATURE = 0x02
+STREAM_TYPE_RESULT = 0x03
+STREAM_TYPE_STATUS = 0x04
+STREAM_FEATURE_F32 = 0
+STREAM_FEATURE_Q16 = 1
+
+
+def _crc16_ccitt(data: bytes) -> int:
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def _iter_stream_frames(buf: bytearray, stats: dict):
+    """
+    Yields (type, payload) for every valid frame in buf and removes the consumed
+    bytes. A trailing incomplete frame is left in buf for the next chunk.
+    """
+    while True:
+        start = buf.find(bytes([STREAM_SOF]))
+        if start < 0:
+            buf.clear()
+            return
+        del buf[:start]
+
+        if len(buf) < 4:
+            return
+        length = buf[1] | (buf[2] << 8)
+        size = 4 + length + 2
+        if len(buf) < size:
+            return
+
+        crc = buf[size - 2] | (buf[size - 1] << 8)
+        if _crc16_ccitt(bytes(buf[1:4 + length])) != crc:
+            # False SOF (text or a corrupted frame): resync one byte later
+            stats['crc_errors'] += 1
+            del buf[:1]
+            continue
+
+        frame_type = buf[3]
+        payload = bytes(buf[4:4 + length])
+        del buf[:size]
+        yield frame_type, payload
+
+
+def parse_emg_stream(chunks, volts: bool = True) -> dict:
+    """
+    Decodes the binary stream sent by the firmware after EMG:STREAM.
+
+    Args:
+        chunks: Iterable of bytes objects (file or serial reads), or a single bytes object
+        volts (bool): Convert raw ADC codes to volts using the STATUS frame
+
+    Returns:
+        dict with
+            'emg_data'        (n_samples, 4) raw codes or volts, in sample order
+            'sample_index'    (n_samples,) firmware sample index of each row
+            'features'        (n_windows, n_features) values as handed to the forest
+            'feature_index'   (n_windows,) index of each window's newest sample
+            'feature_format'  'f32' or 'q16' (q16 values are folded-normalization units)
+            'predictions'     (n_results, 5) class, confidence, trees, voted class, voted confidence
+            'prediction_index'(n_results,)
+            'status'          last STATUS frame as a dict (sample_rate, gain, volts_per_code, ...)
+            'gaps'            number of raw-sample discontinuities (dropped frames)
+            'crc_errors'      number of rejected frames
+    """
+    if isinstance(chunks, (bytes, bytearray)):
+        chunks = [chunks]
+
+    stats = {'crc_errors': 0}
+    status = {}
+    raw_blocks, raw_index = [], []
+    features, feature_index, feature_format = [], [], None
+    predictions, prediction_index = [], []
+    buf = bytearray()
+
+    for chunk in chunks:
+        buf.extend(chunk)
+        for frame_type, payload in _iter_stream_frames(buf, stats):
+            if frame_type == STREAM_TYPE_STATUS and len(payload) >= 12:
+                rate, n_ch, mask, gain, _, volts_per_code = struct.unpack_from('<IBBBBf', payload)
+                status = {'sample_rate': rate, 'n_channels': n_ch, 'stream_mask': mask,
+                          'gain': gain, 'volts_per_code': volts_per_code}
+
+            elif frame_type == STREAM_TYPE_RAW and len(payload) >= 6:
+                first, n_ch, n = struct.unpack_from('<IBB', payload)
+                codes = np.frombuffer(payload[6:6 + 3 * n_ch * n], dtype=np.uint8).reshape(n, n_ch, 3)
+                values = codes[..., 0].astype(np.int32) | (codes[..., 1].astype(np.int32) << 8) | \
+                    (codes[..., 2].astype(np.int32) << 16)
+                values = np.where(values & 0x800000, values - (1 << 24), values)  # Sign-extend int24
+                raw_blocks.append(values)
+                raw_index.append(first + np.arange(n, dtype=np.int64))
+
+            elif frame_type == STREAM_TYPE_FEATURE and len(payload) >= 6:
+                index, n, fmt = struct.unpack_from('<IBB', payload)
+                dtype = '<i2' if fmt == STREAM_FEATURE_Q16 else '<f4'
+                features.append(np.frombuffer(payload[6:], dtype=dtype, count=n).astype(np.float32))
+                feature_index.append(index)
+                feature_format = 'q16' if fmt == STREAM_FEATURE_Q16 else 'f32'
+
+            elif frame_type == STREAM_TYPE_RESULT and len(payload) >= 9:
+                prediction_index.append(struct.unpack_from('<I', payload)[0])
+                predictions.append(list(payload[4:9]))
+
+    emg = np.concatenate(raw_blocks) if raw_blocks else np.zeros((0, 4), dtype=np.int32)
+    index = np.concatenate(raw_index) if raw_index else np.zeros(0, dtype=np.int64)
+    if volts and status.get('volts_per_code'):
+        emg = emg.astype(np.float64) * status['volts_per_code']
+
+    return {
+        'emg_data': emg,
+        'sample_index': index,
+        'features': np.stack(features) if features else np.zeros((0, 0), dtype=np.float32),
+        'feature_index': np.array(feature_index, dtype=np.int64),
+        'feature_format': feature_format,
+        'predictions': np.array(predictions, dtype=np.uint8).reshape(-1, 5),
+        'prediction_index': np.array(prediction_index, dtype=np.int64),
+        'status': status,
+        'gaps': int(np.count_nonzero(np.diff(index) != 1)) if index.size > 1 else 0,
+        'crc_errors': stats['crc_errors'],
+    }
+
+
+def read_emg_stream(source: str, duration: float = None, baudrate: int = 230400,
+                    stream: str = "ALL", volts: bool = True) -> dict:
+    """
+    Records the firmware stream from a serial port, or decodes a raw capture file.
+
+    Args:
+        source (str): Serial port (e.g. COM3, /dev/ttyACM0) or path to a capture file
+        duration (float): Seconds to record from a serial port
+        baudrate (int): Must match DEBUG_UART_BAUDRATE of the firmware build
+        stream (str): Arguments of EMG:STREAM (RAW, FEAT, PRED, ALL)
+        volts (bool): Convert raw codes to volts
+
+    Returns:
+        dict as returned by parse_emg_stream
+    """
+    if os.path.isfile(source):
+        with open(source, 'rb') as f:
+            return parse_emg_stream([f.read()], volts=volts)
+
+    import time
+    import serial
+
+    if duration is None:
+        raise ValueError("duration is required when recording from a serial port")
+
+    chunks = []
+    with serial.Serial(source, baudrate, timeout=0.1) as ser:
+        ser.write("EMG:STREAM {}\r\n".format(stream).encode())
+        end = time.monotonic() + duration
+        while time.monotonic() < end:
+            chunks.append(ser.read(ser.in_waiting or 1))
+        ser.write(b"EMG:STREAM OFF\r\n")
+
+    return parse_emg_stream(chunks, volts=volts)
+
+
+def save_emg_stream_npz(recording: dict, filename: str, label: str,
+                        subject: str = "", session: int = 0) -> None:
+    """
+    Saves a parse_emg_stream result in the dataset .npz format (datasets/README.md),
+    adding the firmware features and predictions alongside 'emg_data'.
+    """
+    rate = recording['status'].get('sample_rate', 1000)
+    np.savez_compressed(filename,
+                        emg_data=recording['emg_data'],
+                        timestamp=recording['sample_index'] / float(rate),
+                        label=label,
+                        subject=subject,
+                        session=session,
+                        fw_features=recording['features'],
+                        fw_feature_index=recording['feature_index'],
+                        fw_predictions=recording['predictions'],
+                        metadata=dict(recording['status'], gaps=recording['gaps'],
+                                      feature_format=recording['feature_format']))
@@ -0,0 +1,195 @@
+/**
+ * @file profiler.c
+ * @brief DWT cycle-counter probes with min/avg/max/p99 statistics
+ *
+ * Each probe keeps running min/max/sum and a log-linear histogram
+ * (4 buckets per octave), so p50/p99 are available without storing samples.
+ * A probe must be recorded from a single task; readers may see a
+ * partially updated probe, which only affects diagnostics.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "profiler.h"
+
+/* Private variables ---------------------------------------------------------*/
+static Profiler_Histogram_t probes[PROF_NUM_PROBES];
+
+static const char *const probe_names[PROF_NUM_PROBES] = {
+    "acquisition",
+    "preprocess",
+    "fft",
+    "features",
+    "trees",
+    "voting",
+    "dsp_total",
+    "ml_total"
+};
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t bucket_index(uint32_t cycles)
+{
+    uint32_t octave;
+
+    if (cycles < (1U << PROFILER_MIN_OCTAVE)) {
+        return 0;
+    }
+
+    octave = 31U - (uint32_t)__builtin_clz(cycles);
+
+    if (octave >= PROFILER_MIN_OCTAVE + PROFILER_OCTAVES) {
+        return PROFILER_BUCKETS - 1;
+    }
+
+    // Two bits below the leading one select the quarter-octave
+    return (octave - PROFILER_MIN_OCTAVE) * PROFILER_SUB_BUCKETS +
+           ((cycles >> (octave - 2U)) & (PROFILER_SUB_BUCKETS - 1U));
+}
+
+static uint32_t bucket_upper_edge(uint32_t idx)
+{
+    uint32_t octave = idx / PROFILER_SUB_BUCKETS + PROFILER_MIN_OCTAVE;
+    uint32_t sub = idx % PROFILER_SUB_BUCKETS;
+
+    return (PROFILER_SUB_BUCKETS + sub + 1U) << (octave - 2U);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Enable the DWT cycle counter and clear all probes
+ */
+void Profiler_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;    // Unlock DWT on Cortex-M7
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    Profiler_Reset();
+}
+
+/**
+ * @brief Clear statistics of all probes
+ */
+void Profiler_Reset(void)
+{
+    for (uint8_t i = 0; i < PROF_NUM_PROBES; i++) {
+        Profiler_HistogramReset(&probes[i]);
+    }
+}
+
+/**
+ * @brief Add one measurement to a probe
+ * @param cycles Elapsed cycles (wrap-safe when taken as end - start)
+ */
+void Profiler_Record(Profiler_Probe_t probe, uint32_t cycles)
+{
+    if (probe >= PROF_NUM_PROBES) {
+        return;
+    }
+
+    Profiler_HistogramRecord(&probes[probe], cycles);
+}
+
+/**
+ * @brief Snapshot of min/avg/max/p50/p99 for one probe
+ */
+void Profiler_GetStats(Profiler_Probe_t probe, Profiler_Stats_t *stats)
+{
+    if (probe >= PROF_NUM_PROBES) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    Profiler_HistogramGetStats(&probes[probe], stats);
+}
+
+/**
+ * @brief Human-readable probe name
+ */
+const char* Profiler_GetProbeName(Profiler_Probe_t probe)
+{
+    return (probe < PROF_NUM_PROBES) ? probe_names[probe] : "unknown";
+}
+
+/**
+ * @brief Convert cycles to microseconds at the current core clock
+ */
+uint32_t Profiler_CyclesToUs(uint32_t cycles)
+{
+    return cycles / (SystemCoreClock / 1000000U);
+}
+
+/**
+ * @brief Clear a histogram
+ */
+void Profiler_HistogramReset(Profiler_Histogram_t *hist)
+{
+    memset(hist, 0, sizeof(*hist));
+    hist->min_cycles = UINT32_MAX;
+}
+
+/**
+ * @brief Add one measurement to a histogram
+ */
+void Profiler_HistogramRecord(Profiler_Histogram_t *hist, uint32_t cycles)
+{
+    hist->count++;
+    hist->sum_cycles += cycles;
+
+    if (cycles < hist->min_cycles) {
+        hist->min_cycles = cycles;
+    }
+
+    if (cycles > hist->max_cycles) {
+        hist->max_cycles = cycles;
+    }
+
+    hist->buckets[bucket_index(cycles)]++;
+}
+
+/**
+ * @brief Snapshot of min/avg/max/p50/p99 of a histogram
+ */
+void Profiler_HistogramGetStats(const Profiler_Histogram_t *hist, Profiler_Stats_t *stats)
+{
+    uint32_t target50;
+    uint32_t target99;
+    uint32_t seen = 0;
+
+    memset(stats, 0, sizeof(*stats));
+
+    if (hist->count == 0) {
+        return;
+    }
+
+    stats->count = hist->count;
+    stats->min_cycles = hist->min_cycles;
+    stats->max_cycles = hist->max_cycles;
+    stats->avg_cycles = (uint32_t)(hist->sum_cycles / hist->count);
+
+    // Smallest bucket edges covering 50% / 99% of the samples
+    target50 = hist->count - hist->count / 2U;
+    target99 = hist->count - hist->count / 100U;
+
+    for (uint32_t i = 0; i < PROFILER_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (stats->p50_cycles == 0 && seen >= target50) {
+            stats->p50_cycles = bucket_upper_edge(i);
+        }
+        if (seen >= target99) {
+            stats->p99_cycles = bucket_upper_edge(i);
+            break;
+        }
+    }
+
+    // The bucket edge can overshoot the true maximum
+    if (stats->p50_cycles > stats->max_cycles) {
+        stats->p50_cycles = stats->max_cycles;
+    }
+
+    if (stats->p99_cycles > stats->max_cycles) {
+        stats->p99_cycles = stats->max_cycles;
+    }
+}
@@ -0,0 +1,114 @@
+/**
+ * @file profiler.h
+ * @brief Cycle-accurate hot-path profiling on the Cortex-M7 DWT cycle counter
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32h7xx_hal.h"
+
+/* Build configuration -------------------------------------------------------*/
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED       1
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+// Named probes along the pipeline
+typedef enum {
+    PROF_ACQUISITION = 0,     // Half-buffer unpack in EMG_AcquireBuffer
+    PROF_PREPROCESS,          // Conversion + filtering (fused, DSP_PreprocessBuffer)
+    PROF_FFT,                 // Window + FFT + magnitude, per channel
+    PROF_FEATURES,            // DSP_ExtractFeatures
+    PROF_TREES,               // Forest traversal
+    PROF_VOTING,              // Temporal voting
+    PROF_DSP_TOTAL,           // One DSP window, end to end
+    PROF_ML_TOTAL,            // One inference, end to end
+    PROF_NUM_PROBES
+} Profiler_Probe_t;
+
+// Per-probe statistics, in CPU cycles
+typedef struct {
+    uint32_t count;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint32_t avg_cycles;
+    uint32_t p50_cycles;      // Median, same bucket resolution as p99
+    uint32_t p99_cycles;      // Upper edge of the histogram bucket (<= 19% high)
+} Profiler_Stats_t;
+
+/* Exported constants --------------------------------------------------------*/
+// Log-linear histogram: 4 buckets per octave from 2^6 to 2^28 cycles
+// (~1 s at 280 MHz, enough for end-to-end latencies)
+#define PROFILER_MIN_OCTAVE    6
+#define PROFILER_OCTAVES       22
+#define PROFILER_SUB_BUCKETS   4
+#define PROFILER_BUCKETS       (PROFILER_OCTAVES * PROFILER_SUB_BUCKETS)
+
+/* Exported types ------------------------------------------------------------*/
+// Running min/max/sum and log-linear histogram of one measured quantity.
+// Used by the probes below and by other modules' own statistics; a
+// histogram must be recorded from a single context.
+typedef struct {
+    uint32_t count;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t sum_cycles;
+    uint32_t buckets[PROFILER_BUCKETS];
+} Profiler_Histogram_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void Profiler_Init(void);
+void Profiler_Reset(void);
+void Profiler_Record(Profiler_Probe_t probe, uint32_t cycles);
+void Profiler_GetStats(Profiler_Probe_t probe, Profiler_Stats_t *stats);
+const char* Profiler_GetProbeName(Profiler_Probe_t probe);
+
+void Profiler_HistogramReset(Profiler_Histogram_t *hist);
+void Profiler_HistogramRecord(Profiler_Histogram_t *hist, uint32_t cycles);
+void Profiler_HistogramGetStats(const Profiler_Histogram_t *hist, Profiler_Stats_t *stats);
+uint32_t Profiler_CyclesToUs(uint32_t cycles);
+
+/* Exported macro ------------------------------------------------------------*/
+static inline uint32_t Profiler_Now(void)
+{
+    return DWT->CYCCNT;
+}
+
+#if PROFILER_ENABLED
+// Explicit begin/end pair within one block
+#define PROFILE_BEGIN(probe)   const uint32_t prof_start_##probe = Profiler_Now()
+#define PROFILE_END(probe)     Profiler_Record((probe), Profiler_Now() - prof_start_##probe)
+
+// Scoped probe: records when the enclosing block exits
+typedef struct {
+    Profiler_Probe_t probe;
+    uint32_t start;
+} Profiler_Scope_t;
+
+static inline void Profiler_ScopeExit(Profiler_Scope_t *scope)
+{
+    Profiler_Record(scope->probe, Profiler_Now() - scope->start);
+}
+
+#define PROFILE_SCOPE(probe) \
+    Profiler_Scope_t prof_scope_##probe __attribute__((cleanup(Profiler_ScopeExit))) = \
+        { (probe), Profiler_Now() }
+#else
+#define PROFILE_BEGIN(probe)   do { } while (0)
+#define PROFILE_END(probe)     do { } while (0)
+#define PROFILE_SCOPE(probe)   do { } while (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILER_H */
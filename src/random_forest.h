@@ -13,6 +13,38 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include <stdint.h>
 #include <stdbool.h>
+#include "memory_map.h"
+#include "emg_config.h"
+#include "feature_mask.h"
+
+/* Build configuration -------------------------------------------------------*/
+// Inference engine used by RF_PREDICT
+#define RF_ENGINE_NODES             0   // RF_Model_t node-table interpreter
+#define RF_ENGINE_FLAT              1   // RF_FlatModel_t implicit-tree layout
+#define RF_ENGINE_CODEGEN           2   // RF_CodeModel_t generated tree functions
+#define RF_ENGINE_COMPACT           3   // RF_CompactModel_t 4-byte nodes, shared thresholds
+
+#ifndef RF_INFERENCE_ENGINE
+#define RF_INFERENCE_ENGINE         RF_ENGINE_NODES
+#endif
+
+// Placement of generated tree code (instruction TCM, zero wait states)
+#ifndef RF_ITCM_CODE
+#define RF_ITCM_CODE                ITCM_CODE
+#endif
+
+// Placement of exported model tables (data TCM, copied from flash at boot)
+#ifndef RF_MODEL_DATA
+#define RF_MODEL_DATA               DTCM_RODATA
+#endif
+
+// Temporal smoothing: each inference moves the per-class scores by
+// 2^-RF_SMOOTH_SHIFT of the way to its own class shares, a span of about
+// 2^(RF_SMOOTH_SHIFT + 1) - 1 inferences (1 = 3, the former 3-deep vote).
+// Halving the hop size: add 1 to smooth over the same time
+#ifndef RF_SMOOTH_SHIFT
+#define RF_SMOOTH_SHIFT             1
+#endif
 
 /* Exported types ------------------------------------------------------------*/
 // Fixed-point type for memory efficiency (Q8.8 format)
@@ -43,11 +75,106 @@ typedef struct {
     uint8_t n_classes;        // Number of output classes
     
     // Feature normalization parameters (Q8.8 format)
-    fixed_point_t feature_scale[30];
-    fixed_point_t feature_offset[30];
+    fixed_point_t feature_scale[EMG_MAX_FEATURES];
+    fixed_point_t feature_offset[EMG_MAX_FEATURES];
+    
+    const Feature_Mask_t *feature_mask; // Features referenced by any split, NULL = all
 } RF_Model_t;
 
-// Voting buffer for temporal smoothing
+// Flattened tree: implicit complete binary tree of depth RF_FLAT_DEPTH.
+// Internal node i has children 2i+1 (x <= t) and 2i+2 (x > t); leaves
+// shallower than RF_FLAT_DEPTH are padded with always-left nodes
+// (threshold = INT16_MAX), so every traversal takes exactly RF_FLAT_DEPTH steps
+typedef struct {
+    fixed_point_t threshold[63];  // Q8.8 split thresholds, RF_FLAT_INTERNAL_NODES
+    uint8_t feature_idx[63];      // Split feature per internal node
+    uint8_t leaf_class[64];       // Class label per leaf, RF_FLAT_LEAVES
+} RF_FlatTree_t;
+
+// Random Forest in flattened layout (normalization shared with RF_Model_t)
+typedef struct {
+    const RF_FlatTree_t *trees; // n_trees trees, in DTCM or memory-mapped flash
+    const float *feature_qscale; // Folded normalization scales, NULL if thresholds are Q8.8
+    const Feature_Mask_t *feature_mask; // Features referenced by any split, NULL = all
+    uint8_t n_trees;
+    uint8_t n_features;
+    uint8_t n_classes;
+} RF_FlatModel_t;
+
+// Generated straight-line tree: nested comparisons with immediate thresholds
+typedef uint8_t (*RF_TreeFn_t)(const fixed_point_t *features);
+
+// Random Forest as generated code (export_to_c_header(..., layout="code"))
+typedef struct {
+    const RF_TreeFn_t *trees; // One function per tree
+    const float *feature_qscale; // Folded normalization scales, NULL if thresholds are Q8.8
+    const Feature_Mask_t *feature_mask; // Features referenced by any split, NULL = all
+    uint8_t n_trees;
+    uint8_t n_features;
+    uint8_t n_classes;
+} RF_CodeModel_t;
+
+// Compact internal node (layout="compact"). A child >= 0 is an internal
+// node of the same tree, always after its parent (pre-order); a negative
+// child c is leaf ~c of the tree
+typedef struct {
+    uint8_t feature_idx;      // Split feature
+    uint8_t threshold_idx;    // Into RF_CompactModel_t.thresholds
+    int8_t left;              // Taken when x <= threshold
+    int8_t right;
+} RF_CompactNode_t;
+
+// Random Forest in compact layout: trees of any shape, internal nodes and
+// leaves in two forest-wide arrays. Tree t has node_start[t+1] - node_start[t]
+// internal nodes (0 = single leaf) and one more leaf, its leaves starting
+// at leaf_class[node_start[t] + t]
+typedef struct {
+    const RF_CompactNode_t *nodes;
+    const uint8_t *leaf_class;
+    const uint16_t *node_start;    // n_trees + 1 entries
+    const fixed_point_t *thresholds; // Shared split thresholds, n_thresholds entries
+    const float *feature_qscale; // Folded normalization scales, NULL if thresholds are Q8.8
+    const Feature_Mask_t *feature_mask; // Features referenced by any split, NULL = all
+    const uint8_t *leaf_proba;     // n_classes per leaf in leaf_class order, each row summing
+                                   // to RF_VOTE_WEIGHT; NULL = one hard vote per tree
+    uint16_t n_thresholds;
+    uint8_t n_trees;
+    uint8_t n_features;
+    uint8_t n_classes;
+} RF_CompactModel_t;
+
+// Per-inference tree vote tally. Every tree adds RF_VOTE_WEIGHT: all to one
+// class (hard vote) or spread over its leaf's class distribution (soft vote)
+typedef struct {
+    uint16_t weight[29];      // RF_MAX_CLASSES, at most RF_MAX_TREES * RF_VOTE_WEIGHT
+    uint8_t leader;           // Class with most votes so far
+    uint8_t n_evaluated;      // Trees evaluated so far
+    uint8_t n_trees;          // Trees in the model
+    uint8_t n_classes;
+} RF_Vote_t;
+
+// Early termination of the tree loop
+typedef struct {
+    bool enabled;
+    uint8_t min_trees;        // Trees evaluated before the confidence test applies
+    uint8_t min_confidence;   // Stop once leader share of evaluated trees reaches this (0 = majority test only)
+} RF_EarlyExit_t;
+
+// Inference result
+typedef struct {
+    uint8_t class_id;
+    uint8_t confidence;       // Winner weight / weight of all n_trees (0-100)
+    uint8_t trees_evaluated;  // 0 if the engine does not report it
+} RF_Result_t;
+
+// Per-class exponentially weighted score over successive inferences;
+// constant size and update cost whatever the smoothing span
+typedef struct {
+    uint16_t score[29];       // RF_MAX_CLASSES, confidence (0-100) in Q8
+    bool primed;              // false until the first inference after a reset
+} RF_Smooth_t;
+
+// Voting buffer for temporal smoothing (3-deep majority, RF_Node_t engine)
 typedef struct {
     uint8_t predictions[3];   // Last 3 predictions
     uint8_t confidences[3];   // Confidence for each prediction
@@ -63,8 +190,19 @@ typedef struct {
 // Model constraints
 #define RF_MAX_TREES                15
 #define RF_MAX_NODES_PER_TREE       63
-#define RF_MAX_FEATURES             30
+#define RF_MAX_FEATURES             EMG_MAX_FEATURES   // emg_config.h
 #define RF_MAX_CLASSES              29  // For Turkish Sign Language
+#define RF_MAX_BATCH                8   // Feature vectors per RF_PREDICT_BATCH call
+#define RF_VOTE_WEIGHT              255 // One tree's vote; also the uint8 leaf probability scale
+
+// Compact layout; int8 child links bound the nodes of one tree
+#define RF_COMPACT_MAX_NODES        127     // Internal nodes per tree
+#define RF_COMPACT_MAX_THRESHOLDS   256     // uint8 threshold_idx
+
+// Flattened layout
+#define RF_FLAT_DEPTH               6
+#define RF_FLAT_INTERNAL_NODES      ((1 << RF_FLAT_DEPTH) - 1)
+#define RF_FLAT_LEAVES              (1 << RF_FLAT_DEPTH)
 
 // Node type flags
 #define RF_NODE_IS_LEAF             0x80
@@ -75,20 +213,157 @@ typedef struct {
 #define FLOAT_TO_FIXED(x)   ((fixed_point_t)((x) * FIXED_POINT_SCALE + 0.5f))
 #define FIXED_TO_FLOAT(x)   ((float)(x) / FIXED_POINT_SCALE)
 
+// ML scratch bytes one batch needs (normalized inputs and vote tallies)
+#define RF_SCRATCH_BYTES(n_features) \
+    ((uint32_t)RF_MAX_BATCH * ((uint32_t)(n_features) * sizeof(fixed_point_t) + sizeof(RF_Vote_t)))
+
+// Model description of the engine RF_PREDICT runs; any output may be NULL
+#if RF_INFERENCE_ENGINE == RF_ENGINE_FLAT
+#define RF_GET_MODEL_INFO(n_trees, n_features, n_classes, used_features) \
+    RF_FlatGetModelInfo((n_trees), (n_features), (n_classes), (used_features))
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_CODEGEN
+#define RF_GET_MODEL_INFO(n_trees, n_features, n_classes, used_features) \
+    RF_CodeGetModelInfo((n_trees), (n_features), (n_classes), (used_features))
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_COMPACT
+#define RF_GET_MODEL_INFO(n_trees, n_features, n_classes, used_features) \
+    RF_CompactGetModelInfo((n_trees), (n_features), (n_classes), (used_features))
+#else
+#define RF_GET_MODEL_INFO(n_trees, n_features, n_classes, used_features) \
+    RF_GetModelInfo((n_trees), (n_features), (n_classes), (used_features))
+#endif
+
+// Inference engine dispatch
+#if RF_INFERENCE_ENGINE == RF_ENGINE_FLAT
+#define RF_PREDICT(features, confidence)  RF_FlatPredict((features), (confidence))
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_CODEGEN
+#define RF_PREDICT(features, confidence)  RF_CodePredict((features), (confidence))
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_COMPACT
+#define RF_PREDICT(features, confidence)  RF_CompactPredict((features), (confidence))
+#else
+#define RF_PREDICT(features, confidence)  RF_Predict((features), (confidence))
+#endif
+
+// Pre-quantized features (DSP_QuantizeFeatures with the model's feature_qscale)
+#if RF_INFERENCE_ENGINE == RF_ENGINE_FLAT
+#define RF_PREDICT_FIXED(features, confidence)  RF_FlatPredictFixed((features), (confidence))
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_CODEGEN
+#define RF_PREDICT_FIXED(features, confidence)  RF_CodePredictFixed((features), (confidence))
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_COMPACT
+#define RF_PREDICT_FIXED(features, confidence)  RF_CompactPredictFixed((features), (confidence))
+#else
+#define RF_PREDICT_FIXED(features, confidence)  RF_PredictFixed((features), (confidence))
+#endif
+
+// Inference with early exit and tree count (node interpreter always runs every tree)
+#if RF_INFERENCE_ENGINE == RF_ENGINE_FLAT
+#define RF_PREDICT_EX(features, early_exit, result)        RF_FlatPredictEx((features), (early_exit), (result))
+#define RF_PREDICT_FIXED_EX(features, early_exit, result)  RF_FlatPredictFixedEx((features), (early_exit), (result))
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_CODEGEN
+#define RF_PREDICT_EX(features, early_exit, result)        RF_CodePredictEx((features), (early_exit), (result))
+#define RF_PREDICT_FIXED_EX(features, early_exit, result)  RF_CodePredictFixedEx((features), (early_exit), (result))
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_COMPACT
+#define RF_PREDICT_EX(features, early_exit, result)        RF_CompactPredictEx((features), (early_exit), (result))
+#define RF_PREDICT_FIXED_EX(features, early_exit, result)  RF_CompactPredictFixedEx((features), (early_exit), (result))
+#else
+#define RF_PREDICT_EX(features, early_exit, result) \
+    do { (void)(early_exit); (result)->trees_evaluated = 0; \
+         (result)->class_id = RF_Predict((features), &(result)->confidence); } while (0)
+#define RF_PREDICT_FIXED_EX(features, early_exit, result) \
+    do { (void)(early_exit); (result)->trees_evaluated = 0; \
+         (result)->class_id = RF_PredictFixed((features), &(result)->confidence); } while (0)
+#endif
+
+// Batch of normalized vectors, tree-major (node interpreter falls back to one
+// vector at a time). RF_PREDICT_BATCH_TALLIES: votes[] holds each vector's
+// class weights afterwards
+#if RF_INFERENCE_ENGINE == RF_ENGINE_FLAT
+#define RF_PREDICT_BATCH(features, n_vectors, early_exit, votes, results) \
+    RF_FlatPredictBatch((features), (n_vectors), (early_exit), (votes), (results))
+#define RF_PREDICT_BATCH_TALLIES    1
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_CODEGEN
+#define RF_PREDICT_BATCH(features, n_vectors, early_exit, votes, results) \
+    RF_CodePredictBatch((features), (n_vectors), (early_exit), (votes), (results))
+#define RF_PREDICT_BATCH_TALLIES    1
+#elif RF_INFERENCE_ENGINE == RF_ENGINE_COMPACT
+#define RF_PREDICT_BATCH(features, n_vectors, early_exit, votes, results) \
+    RF_CompactPredictBatch((features), (n_vectors), (early_exit), (votes), (results))
+#define RF_PREDICT_BATCH_TALLIES    1
+#else
+#define RF_PREDICT_BATCH(features, n_vectors, early_exit, votes, results) \
+    do { (void)(votes); \
+         for (uint8_t rf_v = 0; rf_v < (n_vectors); rf_v++) { \
+             RF_PREDICT_FIXED_EX((features)[rf_v], (early_exit), &(results)[rf_v]); \
+         } } while (0)
+#define RF_PREDICT_BATCH_TALLIES    0
+#endif
+
 /* Exported functions prototypes ---------------------------------------------*/
 // Model management
 HAL_StatusTypeDef RF_LoadModel(void);
-HAL_StatusTypeDef RF_GetModelInfo(uint8_t *n_trees, uint8_t *n_features, uint8_t *n_classes);
+// used_features: the model's feature_mask, or all n_features bits if it has none
+HAL_StatusTypeDef RF_GetModelInfo(uint8_t *n_trees, uint8_t *n_features, uint8_t *n_classes,
+                                  Feature_Mask_t *used_features);
 
 // Inference functions
-uint8_t RF_Predict(const float *features, uint8_t *confidence);
-uint8_t RF_PredictFixed(const fixed_point_t *features, uint8_t *confidence);
-uint8_t RF_TreePredict(const RF_Tree_t *tree, const fixed_point_t *features);
+RF_ITCM_CODE uint8_t RF_Predict(const float *features, uint8_t *confidence);
+RF_ITCM_CODE uint8_t RF_PredictFixed(const fixed_point_t *features, uint8_t *confidence);
+RF_ITCM_CODE uint8_t RF_TreePredict(const RF_Tree_t *tree, const fixed_point_t *features);
+
+// Flattened-layout inference engine (random_forest_flat.c)
+HAL_StatusTypeDef RF_FlatLoadModel(const RF_FlatModel_t *model);           // Runs RF_FlatValidateModel
+HAL_StatusTypeDef RF_FlatGetModelInfo(uint8_t *n_trees, uint8_t *n_features, uint8_t *n_classes,
+                                      Feature_Mask_t *used_features);
+RF_ITCM_CODE uint8_t RF_FlatPredict(const float *features, uint8_t *confidence);
+RF_ITCM_CODE uint8_t RF_FlatPredictFixed(const fixed_point_t *features, uint8_t *confidence);
+RF_ITCM_CODE void RF_FlatPredictEx(const float *features, const RF_EarlyExit_t *early_exit, RF_Result_t *result);
+RF_ITCM_CODE void RF_FlatPredictFixedEx(const fixed_point_t *features, const RF_EarlyExit_t *early_exit, RF_Result_t *result);
+RF_ITCM_CODE uint8_t RF_FlatTreePredict(const RF_FlatTree_t *tree, const fixed_point_t *features);
+RF_ITCM_CODE void RF_FlatPredictBatch(const fixed_point_t *const *features, uint8_t n_vectors,
+                                      const RF_EarlyExit_t *early_exit, RF_Vote_t *votes, RF_Result_t *results);
+// Every split and leaf in range; RF_FlatLoadModel refuses models that fail it
+bool RF_FlatValidateModel(const RF_FlatModel_t *model);
+
+// Generated-code inference engine (random_forest_codegen.c)
+HAL_StatusTypeDef RF_CodeLoadModel(const RF_CodeModel_t *model);
+HAL_StatusTypeDef RF_CodeGetModelInfo(uint8_t *n_trees, uint8_t *n_features, uint8_t *n_classes,
+                                      Feature_Mask_t *used_features);
+RF_ITCM_CODE uint8_t RF_CodePredict(const float *features, uint8_t *confidence);
+RF_ITCM_CODE uint8_t RF_CodePredictFixed(const fixed_point_t *features, uint8_t *confidence);
+RF_ITCM_CODE void RF_CodePredictEx(const float *features, const RF_EarlyExit_t *early_exit, RF_Result_t *result);
+RF_ITCM_CODE void RF_CodePredictFixedEx(const fixed_point_t *features, const RF_EarlyExit_t *early_exit, RF_Result_t *result);
+RF_ITCM_CODE void RF_CodePredictBatch(const fixed_point_t *const *features, uint8_t n_vectors,
+                                      const RF_EarlyExit_t *early_exit, RF_Vote_t *votes, RF_Result_t *results);
+
+// Compact-layout inference engine (random_forest_compact.c)
+HAL_StatusTypeDef RF_CompactLoadModel(const RF_CompactModel_t *model);   // Also checks every node
+HAL_StatusTypeDef RF_CompactGetModelInfo(uint8_t *n_trees, uint8_t *n_features, uint8_t *n_classes,
+                                         Feature_Mask_t *used_features);
+RF_ITCM_CODE uint8_t RF_CompactPredict(const float *features, uint8_t *confidence);
+RF_ITCM_CODE uint8_t RF_CompactPredictFixed(const fixed_point_t *features, uint8_t *confidence);
+RF_ITCM_CODE void RF_CompactPredictEx(const float *features, const RF_EarlyExit_t *early_exit, RF_Result_t *result);
+RF_ITCM_CODE void RF_CompactPredictFixedEx(const fixed_point_t *features, const RF_EarlyExit_t *early_exit, RF_Result_t *result);
+RF_ITCM_CODE uint8_t RF_CompactTreePredict(const RF_CompactModel_t *model, uint8_t tree,
+                                           const fixed_point_t *features);
+RF_ITCM_CODE void RF_CompactPredictBatch(const fixed_point_t *const *features, uint8_t n_vectors,
+                                         const RF_EarlyExit_t *early_exit, RF_Vote_t *votes, RF_Result_t *results);
 
 // Feature normalization
-void RF_NormalizeFeatures(const float *raw_features, fixed_point_t *normalized_features, uint8_t n_features);
+RF_ITCM_CODE void RF_NormalizeFeatures(const float *raw_features, fixed_point_t *normalized_features, uint8_t n_features);
+
+// Tree vote tally (random_forest_vote.c)
+void RF_Vote_Init(RF_Vote_t *vote, uint8_t n_trees, uint8_t n_classes);
+RF_ITCM_CODE bool RF_Vote_Add(RF_Vote_t *vote, uint8_t class_id, const RF_EarlyExit_t *early_exit);  // true: stop evaluating
+// Soft vote: proba is one leaf's n_classes row, summing to RF_VOTE_WEIGHT
+RF_ITCM_CODE bool RF_Vote_AddProba(RF_Vote_t *vote, const uint8_t *proba, const RF_EarlyExit_t *early_exit);
+void RF_Vote_GetResult(const RF_Vote_t *vote, RF_Result_t *result);
+
+// Temporal smoothing (random_forest_vote.c)
+void RF_Smooth_Init(RF_Smooth_t *smooth);
+// vote: the inference's tally for per-class shares, NULL to credit only result->class_id
+void RF_Smooth_Add(RF_Smooth_t *smooth, const RF_Result_t *result, const RF_Vote_t *vote);
+uint8_t RF_Smooth_GetResult(const RF_Smooth_t *smooth, uint8_t *final_confidence);
 
-// Voting functions
+// Voting functions (3-deep majority)
 void Voting_Init(VotingBuffer_t *buffer);
 void Voting_AddPrediction(VotingBuffer_t *buffer, uint8_t prediction, uint8_t confidence);
 uint8_t Voting_GetMajority(const VotingBuffer_t *buffer, uint8_t *final_confidence);
@@ -107,6 +382,8 @@ float RF_GetInferenceTime(void);
 
 // Model validation
 bool RF_ValidateModel(const RF_Model_t *model);
+// false if the model exceeds RF_MAX_* or RF_SCRATCH_BYTES(n_features)
+// exceeds SCRATCH_ML_SIZE; the forest itself lives in flash/DTCM, never the heap
 bool RF_CheckMemoryConstraints(const RF_Model_t *model);
 
 #ifdef __cplusplus
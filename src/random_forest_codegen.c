@@ -0,0 +1,171 @@
+/**
+ * @file random_forest_codegen.c
+ * @brief Random Forest inference over generated per-tree functions
+ *
+ * The exporter emits each tree as nested comparisons against immediate
+ * thresholds, placed in ITCM via RF_ITCM_CODE. Traversal needs no node
+ * table loads; this file only dispatches and votes.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "stm32h7xx_hal.h"
+#include "random_forest.h"
+
+/* Private variables ---------------------------------------------------------*/
+static const RF_CodeModel_t *code_model = NULL;
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Select the generated model used by RF_CodePredict
+ * @param model Model emitted by export_to_c_header(..., layout="code")
+ */
+HAL_StatusTypeDef RF_CodeLoadModel(const RF_CodeModel_t *model)
+{
+    if (model == NULL || model->trees == NULL || model->n_trees == 0 ||
+        model->n_trees > RF_MAX_TREES || model->n_features > RF_MAX_FEATURES ||
+        model->n_classes > RF_MAX_CLASSES ||
+        RF_SCRATCH_BYTES(model->n_features) > SCRATCH_ML_SIZE) {
+        return HAL_ERROR;
+    }
+
+    code_model = model;
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Shape of the selected model and the features its splits read
+ * @return HAL_ERROR if no model is loaded
+ */
+HAL_StatusTypeDef RF_CodeGetModelInfo(uint8_t *n_trees, uint8_t *n_features, uint8_t *n_classes,
+                                      Feature_Mask_t *used_features)
+{
+    if (code_model == NULL) {
+        return HAL_ERROR;
+    }
+
+    if (n_trees != NULL) {
+        *n_trees = code_model->n_trees;
+    }
+    if (n_features != NULL) {
+        *n_features = code_model->n_features;
+    }
+    if (n_classes != NULL) {
+        *n_classes = code_model->n_classes;
+    }
+    if (used_features != NULL) {
+        Feature_Mask_FromModel(used_features, code_model->feature_mask, code_model->n_features);
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Vote over the trees on normalized features
+ * @param early_exit NULL to evaluate every tree
+ * @param result     Class, confidence over the forest, trees evaluated
+ */
+void RF_CodePredictFixedEx(const fixed_point_t *features, const RF_EarlyExit_t *early_exit, RF_Result_t *result)
+{
+    RF_Vote_t vote;
+
+    if (code_model == NULL) {
+        memset(result, 0, sizeof(*result));
+        return;
+    }
+
+    RF_Vote_Init(&vote, code_model->n_trees, code_model->n_classes);
+
+    for (uint8_t t = 0; t < code_model->n_trees; t++) {
+        if (RF_Vote_Add(&vote, code_model->trees[t](features), early_exit)) {
+            break;
+        }
+    }
+
+    RF_Vote_GetResult(&vote, result);
+}
+
+/**
+ * @brief Vote over the trees for a batch of normalized feature vectors
+ * @param features  n_vectors pointers to normalized vectors
+ * @param n_vectors 1 .. RF_MAX_BATCH
+ * @param votes     Tally storage, n_vectors entries (caller scratch)
+ * @param results   Per-vector class, confidence and trees evaluated
+ * @note Tree-major: each tree's nodes stay in cache across the batch.
+ *       Results are identical to RF_CodePredictFixedEx per vector.
+ */
+void RF_CodePredictBatch(const fixed_point_t *const *features, uint8_t n_vectors,
+                         const RF_EarlyExit_t *early_exit, RF_Vote_t *votes, RF_Result_t *results)
+{
+    uint32_t pending = 0;   // Vectors still voting
+
+    if (code_model == NULL || n_vectors == 0 || n_vectors > RF_MAX_BATCH) {
+        memset(results, 0, sizeof(*results) * n_vectors);
+        return;
+    }
+
+    for (uint8_t v = 0; v < n_vectors; v++) {
+        RF_Vote_Init(&votes[v], code_model->n_trees, code_model->n_classes);
+        pending |= 1U << v;
+    }
+
+    for (uint8_t t = 0; t < code_model->n_trees && pending != 0; t++) {
+        const RF_TreeFn_t tree = code_model->trees[t];
+        for (uint8_t v = 0; v < n_vectors; v++) {
+            if ((pending & (1U << v)) != 0 &&
+                RF_Vote_Add(&votes[v], tree(features[v]), early_exit)) {
+                pending &= ~(1U << v);
+            }
+        }
+    }
+
+    for (uint8_t v = 0; v < n_vectors; v++) {
+        RF_Vote_GetResult(&votes[v], &results[v]);
+    }
+}
+
+/**
+ * @brief Majority vote over all trees on normalized features
+ * @param confidence Share of trees voting for the winner (0-100)
+ */
+uint8_t RF_CodePredictFixed(const fixed_point_t *features, uint8_t *confidence)
+{
+    RF_Result_t result;
+
+    RF_CodePredictFixedEx(features, NULL, &result);
+    *confidence = result.confidence;
+
+    return result.class_id;
+}
+
+/**
+ * @brief Normalize float features and run the generated forest with early exit
+ */
+void RF_CodePredictEx(const float *features, const RF_EarlyExit_t *early_exit, RF_Result_t *result)
+{
+    fixed_point_t normalized[RF_MAX_FEATURES];
+
+    if (code_model == NULL) {
+        memset(result, 0, sizeof(*result));
+        return;
+    }
+
+    RF_NormalizeFeatures(features, normalized, code_model->n_features);
+
+    RF_CodePredictFixedEx(normalized, early_exit, result);
+}
+
+/**
+ * @brief Normalize float features and run the generated forest
+ */
+uint8_t RF_CodePredict(const float *features, uint8_t *confidence)
+{
+    RF_Result_t result;
+
+    RF_CodePredictEx(features, NULL, &result);
+    *confidence = result.confidence;
+
+    return result.class_id;
+}
@@ -0,0 +1,280 @@
+/**
+ * @file random_forest_compact.c
+ * @brief Random Forest inference over the compact (4-byte node) layout
+ *
+ * Internal nodes are byte fields read directly; leaves are one class byte
+ * each and carry no node; thresholds come from one shared int16 table.
+ * A tree with n splits costs 5n + 1 bytes plus its node_start entry,
+ * against 8 bytes per node and leaf in RF_Model_t, and trees are stored
+ * only as deep as they grew. Traversal follows signed child links until
+ * one is negative. RF_CompactLoadModel checks every link, so a loaded
+ * model always terminates.
+ *
+ * Models exported with leaf_proba=True add the leaf's class distribution
+ * (n_classes uint8 per leaf) and vote soft: each tree spreads its weight
+ * over the classes instead of giving all of it to one.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "stm32h7xx_hal.h"
+#include "random_forest.h"
+
+/* Private variables ---------------------------------------------------------*/
+static const RF_CompactModel_t *compact_model = NULL;
+
+/* Private functions ---------------------------------------------------------*/
+// Children point forward in pre-order or at one of the n_nodes + 1 leaves
+static bool compact_link_valid(int8_t child, uint32_t parent, uint32_t n_nodes)
+{
+    if (child >= 0) {
+        return (uint32_t)child > parent && (uint32_t)child < n_nodes;
+    }
+
+    return (uint32_t)~child <= n_nodes;
+}
+
+static bool compact_model_valid(const RF_CompactModel_t *model)
+{
+    if (model->nodes == NULL || model->leaf_class == NULL || model->node_start == NULL ||
+        model->thresholds == NULL || model->n_thresholds == 0 ||
+        model->n_thresholds > RF_COMPACT_MAX_THRESHOLDS || model->node_start[0] != 0) {
+        return false;
+    }
+
+    for (uint8_t t = 0; t < model->n_trees; t++) {
+        const uint32_t start = model->node_start[t];
+        const uint32_t n_nodes = (uint32_t)model->node_start[t + 1] - start;
+        const uint8_t *leaves = &model->leaf_class[start + t];
+
+        if (model->node_start[t + 1] < start || n_nodes > RF_COMPACT_MAX_NODES) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < n_nodes; i++) {
+            const RF_CompactNode_t *node = &model->nodes[start + i];
+
+            if (node->feature_idx >= model->n_features ||
+                node->threshold_idx >= model->n_thresholds ||
+                !compact_link_valid(node->left, i, n_nodes) ||
+                !compact_link_valid(node->right, i, n_nodes)) {
+                return false;
+            }
+        }
+
+        for (uint32_t i = 0; i <= n_nodes; i++) {
+            if (leaves[i] >= model->n_classes) {
+                return false;
+            }
+
+            if (model->leaf_proba != NULL) {
+                const uint8_t *proba = &model->leaf_proba[(start + t + i) * model->n_classes];
+                uint32_t sum = 0;
+
+                for (uint8_t c = 0; c < model->n_classes; c++) {
+                    sum += proba[c];
+                }
+                // Early exit relies on every tree adding exactly one vote
+                if (sum != RF_VOTE_WEIGHT) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// Forest-wide index of the leaf the features reach in one tree
+static inline uint32_t compact_leaf(const RF_CompactModel_t *model, uint8_t tree, const fixed_point_t *features)
+{
+    const uint32_t start = model->node_start[tree];
+    const RF_CompactNode_t *nodes = &model->nodes[start];
+    const fixed_point_t *thresholds = model->thresholds;
+    int32_t i = (model->node_start[tree + 1] != start) ? 0 : -1;   // -1: root is leaf 0
+
+    while (i >= 0) {
+        const RF_CompactNode_t *node = &nodes[i];
+
+        i = (features[node->feature_idx] <= thresholds[node->threshold_idx]) ? node->left : node->right;
+    }
+
+    return start + tree + (uint32_t)~i;
+}
+
+// Hard or soft vote of one tree; true: stop evaluating
+static inline bool compact_vote(RF_Vote_t *vote, uint8_t tree, const fixed_point_t *features,
+                                const RF_EarlyExit_t *early_exit)
+{
+    const uint32_t leaf = compact_leaf(compact_model, tree, features);
+
+    if (compact_model->leaf_proba != NULL) {
+        return RF_Vote_AddProba(vote, &compact_model->leaf_proba[leaf * compact_model->n_classes], early_exit);
+    }
+
+    return RF_Vote_Add(vote, compact_model->leaf_class[leaf], early_exit);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Select the compact model used by RF_CompactPredict
+ * @param model Model emitted by export_to_c_header(..., layout="compact")
+ * @return HAL_ERROR on a bad shape, out-of-range index or backward link
+ */
+HAL_StatusTypeDef RF_CompactLoadModel(const RF_CompactModel_t *model)
+{
+    if (model == NULL || model->n_trees == 0 || model->n_trees > RF_MAX_TREES ||
+        model->n_features == 0 || model->n_features > RF_MAX_FEATURES ||
+        model->n_classes == 0 || model->n_classes > RF_MAX_CLASSES ||
+        RF_SCRATCH_BYTES(model->n_features) > SCRATCH_ML_SIZE ||
+        !compact_model_valid(model)) {
+        return HAL_ERROR;
+    }
+
+    compact_model = model;
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Shape of the selected model and the features its splits read
+ * @return HAL_ERROR if no model is loaded
+ */
+HAL_StatusTypeDef RF_CompactGetModelInfo(uint8_t *n_trees, uint8_t *n_features, uint8_t *n_classes,
+                                         Feature_Mask_t *used_features)
+{
+    if (compact_model == NULL) {
+        return HAL_ERROR;
+    }
+
+    if (n_trees != NULL) {
+        *n_trees = compact_model->n_trees;
+    }
+    if (n_features != NULL) {
+        *n_features = compact_model->n_features;
+    }
+    if (n_classes != NULL) {
+        *n_classes = compact_model->n_classes;
+    }
+    if (used_features != NULL) {
+        Feature_Mask_FromModel(used_features, compact_model->feature_mask, compact_model->n_features);
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Evaluate one tree of a compact model
+ * @return Class label (the leaf's most likely class with leaf_proba)
+ */
+uint8_t RF_CompactTreePredict(const RF_CompactModel_t *model, uint8_t tree, const fixed_point_t *features)
+{
+    return model->leaf_class[compact_leaf(model, tree, features)];
+}
+
+/**
+ * @brief Vote over the trees on normalized features
+ * @param early_exit NULL to evaluate every tree
+ * @param result     Class, confidence over the forest, trees evaluated
+ */
+void RF_CompactPredictFixedEx(const fixed_point_t *features, const RF_EarlyExit_t *early_exit, RF_Result_t *result)
+{
+    RF_Vote_t vote;
+
+    if (compact_model == NULL) {
+        memset(result, 0, sizeof(*result));
+        return;
+    }
+
+    RF_Vote_Init(&vote, compact_model->n_trees, compact_model->n_classes);
+
+    for (uint8_t t = 0; t < compact_model->n_trees; t++) {
+        if (compact_vote(&vote, t, features, early_exit)) {
+            break;
+        }
+    }
+
+    RF_Vote_GetResult(&vote, result);
+}
+
+/**
+ * @brief Vote over the trees for a batch of normalized feature vectors
+ * @param features  n_vectors pointers to normalized vectors
+ * @param n_vectors 1 .. RF_MAX_BATCH
+ * @param votes     Tally storage, n_vectors entries (caller scratch)
+ * @param results   Per-vector class, confidence and trees evaluated
+ * @note Tree-major: each tree's nodes stay in cache across the batch.
+ *       Results are identical to RF_CompactPredictFixedEx per vector.
+ */
+void RF_CompactPredictBatch(const fixed_point_t *const *features, uint8_t n_vectors,
+                            const RF_EarlyExit_t *early_exit, RF_Vote_t *votes, RF_Result_t *results)
+{
+    uint32_t pending = 0;   // Vectors still voting
+
+    if (compact_model == NULL || n_vectors == 0 || n_vectors > RF_MAX_BATCH) {
+        memset(results, 0, sizeof(*results) * n_vectors);
+        return;
+    }
+
+    for (uint8_t v = 0; v < n_vectors; v++) {
+        RF_Vote_Init(&votes[v], compact_model->n_trees, compact_model->n_classes);
+        pending |= 1U << v;
+    }
+
+    for (uint8_t t = 0; t < compact_model->n_trees && pending != 0; t++) {
+        for (uint8_t v = 0; v < n_vectors; v++) {
+            if ((pending & (1U << v)) != 0 && compact_vote(&votes[v], t, features[v], early_exit)) {
+                pending &= ~(1U << v);
+            }
+        }
+    }
+
+    for (uint8_t v = 0; v < n_vectors; v++) {
+        RF_Vote_GetResult(&votes[v], &results[v]);
+    }
+}
+
+/**
+ * @brief Vote over all trees on normalized features
+ * @param confidence Winner's share of the trees' weight (0-100)
+ */
+uint8_t RF_CompactPredictFixed(const fixed_point_t *features, uint8_t *confidence)
+{
+    RF_Result_t result;
+
+    RF_CompactPredictFixedEx(features, NULL, &result);
+    *confidence = result.confidence;
+
+    return result.class_id;
+}
+
+/**
+ * @brief Normalize float features and run the compact forest with early exit
+ */
+void RF_CompactPredictEx(const float *features, const RF_EarlyExit_t *early_exit, RF_Result_t *result)
+{
+    fixed_point_t normalized[RF_MAX_FEATURES];
+
+    if (compact_model == NULL) {
+        memset(result, 0, sizeof(*result));
+        return;
+    }
+
+    RF_NormalizeFeatures(features, normalized, compact_model->n_features);
+
+    RF_CompactPredictFixedEx(normalized, early_exit, result);
+}
+
+/**
+ * @brief Normalize float features and run the compact forest
+ */
+uint8_t RF_CompactPredict(const float *features, uint8_t *confidence)
+{
+    RF_Result_t result;
+
+    RF_CompactPredictEx(features, NULL, &result);
+    *confidence = result.confidence;
+
+    return result.class_id;
+}
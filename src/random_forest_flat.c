@@ -0,0 +1,218 @@
+/**
+ * @file random_forest_flat.c
+ * @brief Random Forest inference over the flattened (implicit-tree) layout
+ *
+ * Each tree is a complete binary tree stored as struct-of-arrays, so a
+ * traversal is RF_FLAT_DEPTH iterations of idx = 2*idx + 1 + (x > t):
+ * no child-index loads, no data-dependent loop count.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "stm32h7xx_hal.h"
+#include "random_forest.h"
+
+/* Private variables ---------------------------------------------------------*/
+static const RF_FlatModel_t *flat_model = NULL;
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Select the flattened model used by RF_FlatPredict
+ * @param model Model emitted by export_to_c_header(..., layout="flat")
+ * @return HAL_ERROR on a bad shape or an out-of-range split feature or leaf
+ *         class (RF_FlatValidateModel)
+ */
+HAL_StatusTypeDef RF_FlatLoadModel(const RF_FlatModel_t *model)
+{
+    if (!RF_FlatValidateModel(model)) {
+        return HAL_ERROR;
+    }
+
+    flat_model = model;
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Shape of the selected model and the features its splits read
+ * @return HAL_ERROR if no model is loaded
+ */
+HAL_StatusTypeDef RF_FlatGetModelInfo(uint8_t *n_trees, uint8_t *n_features, uint8_t *n_classes,
+                                      Feature_Mask_t *used_features)
+{
+    if (flat_model == NULL) {
+        return HAL_ERROR;
+    }
+
+    if (n_trees != NULL) {
+        *n_trees = flat_model->n_trees;
+    }
+    if (n_features != NULL) {
+        *n_features = flat_model->n_features;
+    }
+    if (n_classes != NULL) {
+        *n_classes = flat_model->n_classes;
+    }
+    if (used_features != NULL) {
+        Feature_Mask_FromModel(used_features, flat_model->feature_mask, flat_model->n_features);
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Check that every split feature and leaf class of a model is in range
+ * @note Walks every node; RF_FlatLoadModel runs it on every model.
+ *       Padding nodes (threshold INT16_MAX) read feature 0 and are accepted.
+ */
+bool RF_FlatValidateModel(const RF_FlatModel_t *model)
+{
+    if (model == NULL || model->trees == NULL || model->n_trees == 0 ||
+        model->n_trees > RF_MAX_TREES || model->n_features == 0 ||
+        model->n_features > RF_MAX_FEATURES || model->n_classes == 0 ||
+        model->n_classes > RF_MAX_CLASSES ||
+        RF_SCRATCH_BYTES(model->n_features) > SCRATCH_ML_SIZE) {
+        return false;
+    }
+
+    for (uint8_t t = 0; t < model->n_trees; t++) {
+        const RF_FlatTree_t *tree = &model->trees[t];
+
+        for (uint8_t i = 0; i < RF_FLAT_INTERNAL_NODES; i++) {
+            if (tree->feature_idx[i] >= model->n_features) {
+                return false;
+            }
+        }
+        for (uint8_t i = 0; i < RF_FLAT_LEAVES; i++) {
+            if (tree->leaf_class[i] >= model->n_classes) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Evaluate one flattened tree
+ * @return Class label
+ */
+uint8_t RF_FlatTreePredict(const RF_FlatTree_t *tree, const fixed_point_t *features)
+{
+    uint32_t idx = 0;
+
+    for (uint8_t depth = 0; depth < RF_FLAT_DEPTH; depth++) {
+        idx = 2 * idx + 1 + (features[tree->feature_idx[idx]] > tree->threshold[idx]);
+    }
+
+    return tree->leaf_class[idx - RF_FLAT_INTERNAL_NODES];
+}
+
+/**
+ * @brief Vote over the trees on normalized features
+ * @param early_exit NULL to evaluate every tree
+ * @param result     Class, confidence over the forest, trees evaluated
+ */
+void RF_FlatPredictFixedEx(const fixed_point_t *features, const RF_EarlyExit_t *early_exit, RF_Result_t *result)
+{
+    RF_Vote_t vote;
+
+    if (flat_model == NULL) {
+        memset(result, 0, sizeof(*result));
+        return;
+    }
+
+    RF_Vote_Init(&vote, flat_model->n_trees, flat_model->n_classes);
+
+    for (uint8_t t = 0; t < flat_model->n_trees; t++) {
+        if (RF_Vote_Add(&vote, RF_FlatTreePredict(&flat_model->trees[t], features), early_exit)) {
+            break;
+        }
+    }
+
+    RF_Vote_GetResult(&vote, result);
+}
+
+/**
+ * @brief Vote over the trees for a batch of normalized feature vectors
+ * @param features  n_vectors pointers to normalized vectors
+ * @param n_vectors 1 .. RF_MAX_BATCH
+ * @param votes     Tally storage, n_vectors entries (caller scratch)
+ * @param results   Per-vector class, confidence and trees evaluated
+ * @note Tree-major: each tree's nodes stay in cache across the batch.
+ *       Results are identical to RF_FlatPredictFixedEx per vector.
+ */
+void RF_FlatPredictBatch(const fixed_point_t *const *features, uint8_t n_vectors,
+                         const RF_EarlyExit_t *early_exit, RF_Vote_t *votes, RF_Result_t *results)
+{
+    uint32_t pending = 0;   // Vectors still voting
+
+    if (flat_model == NULL || n_vectors == 0 || n_vectors > RF_MAX_BATCH) {
+        memset(results, 0, sizeof(*results) * n_vectors);
+        return;
+    }
+
+    for (uint8_t v = 0; v < n_vectors; v++) {
+        RF_Vote_Init(&votes[v], flat_model->n_trees, flat_model->n_classes);
+        pending |= 1U << v;
+    }
+
+    for (uint8_t t = 0; t < flat_model->n_trees && pending != 0; t++) {
+        const RF_FlatTree_t *tree = &flat_model->trees[t];
+        for (uint8_t v = 0; v < n_vectors; v++) {
+            if ((pending & (1U << v)) != 0 &&
+                RF_Vote_Add(&votes[v], RF_FlatTreePredict(tree, features[v]), early_exit)) {
+                pending &= ~(1U << v);
+            }
+        }
+    }
+
+    for (uint8_t v = 0; v < n_vectors; v++) {
+        RF_Vote_GetResult(&votes[v], &results[v]);
+    }
+}
+
+/**
+ * @brief Majority vote over all trees on normalized features
+ * @param confidence Share of trees voting for the winner (0-100)
+ */
+uint8_t RF_FlatPredictFixed(const fixed_point_t *features, uint8_t *confidence)
+{
+    RF_Result_t result;
+
+    RF_FlatPredictFixedEx(features, NULL, &result);
+    *confidence = result.confidence;
+
+    return result.class_id;
+}
+
+/**
+ * @brief Normalize float features and run the flattened forest with early exit
+ */
+void RF_FlatPredictEx(const float *features, const RF_EarlyExit_t *early_exit, RF_Result_t *result)
+{
+    fixed_point_t normalized[RF_MAX_FEATURES];
+
+    if (flat_model == NULL) {
+        memset(result, 0, sizeof(*result));
+        return;
+    }
+
+    RF_NormalizeFeatures(features, normalized, flat_model->n_features);
+
+    RF_FlatPredictFixedEx(normalized, early_exit, result);
+}
+
+/**
+ * @brief Normalize float features and run the flattened forest
+ */
+uint8_t RF_FlatPredict(const float *features, uint8_t *confidence)
+{
+    RF_Result_t result;
+
+    RF_FlatPredictEx(features, NULL, &result);
+    *confidence = result.confidence;
+
+    return result.class_id;
+}
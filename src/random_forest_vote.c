@@ -0,0 +1,187 @@
+/**
+ * @file random_forest_vote.c
+ * @brief Per-inference tree vote tally with early termination, and
+ *        temporal smoothing of successive results
+ *
+ * Trees vote one at a time, each with RF_VOTE_WEIGHT: all of it for its
+ * leaf class, or spread over the leaf's class distribution when the model
+ * carries one. Evaluation can stop as soon as the leading class holds an
+ * absolute majority of the whole forest's weight (no remaining trees can
+ * overturn it), or, optionally, once its share of the trees evaluated so
+ * far reaches a confidence threshold. Worst case is still n_trees
+ * evaluations. The reported confidence is always the winner's share of the
+ * whole forest, so a stop at a bare majority reports a bare majority and
+ * not the unanimity of the trees seen.
+ *
+ * Smoothing keeps one exponentially weighted score per class instead of a
+ * history of results, so a longer span costs neither memory nor time.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "stm32h7xx_hal.h"
+#include "random_forest.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define SMOOTH_FULL_SCORE       (100U << 8)   // RF_Smooth_t score of confidence 100
+
+/* Private functions ---------------------------------------------------------*/
+static bool vote_can_stop(const RF_Vote_t *vote, const RF_EarlyExit_t *early_exit)
+{
+    uint32_t leader_weight;
+
+    if (early_exit == NULL || !early_exit->enabled) {
+        return false;
+    }
+
+    leader_weight = vote->weight[vote->leader];
+
+    // Absolute majority of the forest: result is final
+    if (2U * leader_weight > (uint32_t)vote->n_trees * RF_VOTE_WEIGHT) {
+        return true;
+    }
+
+    // Heuristic: leader share of the trees seen so far
+    if (early_exit->min_confidence != 0 && vote->n_evaluated >= early_exit->min_trees &&
+        (leader_weight * 100U) >= (uint32_t)early_exit->min_confidence * vote->n_evaluated * RF_VOTE_WEIGHT) {
+        return true;
+    }
+
+    return false;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Start a new tally
+ */
+void RF_Vote_Init(RF_Vote_t *vote, uint8_t n_trees, uint8_t n_classes)
+{
+    memset(vote->weight, 0, sizeof(vote->weight));
+    vote->leader = 0;
+    vote->n_evaluated = 0;
+    vote->n_trees = n_trees;
+    vote->n_classes = n_classes;
+}
+
+/**
+ * @brief Record one tree's hard vote
+ * @param early_exit NULL or disabled to always evaluate every tree
+ * @return true when the remaining trees need not be evaluated
+ */
+bool RF_Vote_Add(RF_Vote_t *vote, uint8_t class_id, const RF_EarlyExit_t *early_exit)
+{
+    vote->weight[class_id] += RF_VOTE_WEIGHT;
+    vote->n_evaluated++;
+
+    if (vote->weight[class_id] > vote->weight[vote->leader]) {
+        vote->leader = class_id;
+    }
+
+    return vote_can_stop(vote, early_exit);
+}
+
+/**
+ * @brief Record one tree's soft vote
+ * @param proba The leaf's class distribution, n_classes entries summing to RF_VOTE_WEIGHT
+ * @return true when the remaining trees need not be evaluated
+ */
+bool RF_Vote_AddProba(RF_Vote_t *vote, const uint8_t *proba, const RF_EarlyExit_t *early_exit)
+{
+    for (uint8_t c = 0; c < vote->n_classes; c++) {
+        vote->weight[c] += proba[c];
+    }
+    vote->n_evaluated++;
+
+    // Only classes that gained weight can overtake the leader
+    for (uint8_t c = 0; c < vote->n_classes; c++) {
+        if (proba[c] != 0 && vote->weight[c] > vote->weight[vote->leader]) {
+            vote->leader = c;
+        }
+    }
+
+    return vote_can_stop(vote, early_exit);
+}
+
+/**
+ * @brief Winning class, confidence over the whole forest and tree count
+ * @note Ties resolve to the lowest class index, as in a full argmax.
+ *       Trees skipped by an early exit count as votes against the winner.
+ */
+void RF_Vote_GetResult(const RF_Vote_t *vote, RF_Result_t *result)
+{
+    uint8_t best_class = 0;
+
+    for (uint8_t c = 1; c < vote->n_classes; c++) {
+        if (vote->weight[c] > vote->weight[best_class]) {
+            best_class = c;
+        }
+    }
+
+    result->class_id = best_class;
+    result->trees_evaluated = vote->n_evaluated;
+    result->confidence = (vote->n_trees != 0) ?
+        (uint8_t)((vote->weight[best_class] * 100U) / ((uint32_t)vote->n_trees * RF_VOTE_WEIGHT)) : 0;
+}
+
+/**
+ * @brief Clear the smoothing history (start-up, model change)
+ */
+void RF_Smooth_Init(RF_Smooth_t *smooth)
+{
+    memset(smooth->score, 0, sizeof(smooth->score));
+    smooth->primed = false;
+}
+
+/**
+ * @brief Fold one inference into the per-class scores
+ * @param result Class and confidence of the inference
+ * @param vote   Its tally, to credit every class with its share of the
+ *               forest's weight; NULL credits result->class_id alone
+ * @note score += (share - score) >> RF_SMOOTH_SHIFT for every class. The
+ *       first inference after a reset sets the scores outright, so the
+ *       first decision needs no warm-up.
+ */
+void RF_Smooth_Add(RF_Smooth_t *smooth, const RF_Result_t *result, const RF_Vote_t *vote)
+{
+    // Share of the whole forest, as RF_Vote_GetResult: an early exit adds no weight
+    const uint32_t total = (vote != NULL) ? (uint32_t)vote->n_trees * RF_VOTE_WEIGHT : 0U;
+
+    for (uint8_t c = 0; c < RF_MAX_CLASSES; c++) {
+        int32_t share;
+
+        if (total != 0U) {
+            share = (c < vote->n_classes) ? (int32_t)((vote->weight[c] * SMOOTH_FULL_SCORE) / total) : 0;
+        } else {
+            share = (c == result->class_id) ? (int32_t)(result->confidence * (SMOOTH_FULL_SCORE / 100U)) : 0;
+        }
+
+        if (smooth->primed) {
+            // Arithmetic shift rounds decays down, so stale classes reach 0
+            share = smooth->score[c] + ((share - (int32_t)smooth->score[c]) >> RF_SMOOTH_SHIFT);
+        }
+        smooth->score[c] = (uint16_t)share;
+    }
+
+    smooth->primed = true;
+}
+
+/**
+ * @brief Class with the highest smoothed score
+ * @param final_confidence Its score as a confidence (0-100)
+ * @note Ties resolve to the lowest class index
+ */
+uint8_t RF_Smooth_GetResult(const RF_Smooth_t *smooth, uint8_t *final_confidence)
+{
+    uint8_t best_class = 0;
+
+    for (uint8_t c = 1; c < RF_MAX_CLASSES; c++) {
+        if (smooth->score[c] > smooth->score[best_class]) {
+            best_class = c;
+        }
+    }
+
+    *final_confidence = (uint8_t)(smooth->score[best_class] >> 8);
+
+    return best_class;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file scratch_arena.c
+ * @brief Scratch region storage, ownership and usage counters
+ *
+ * Nothing is ever freed piecemeal: the owner gets the base of its region and
+ * lays its stage struct over it, so the footprint is fixed at link time and
+ * allocation cannot fail once the sizes pass SCRATCH_ASSERT_FITS. Each
+ * region has exactly one owning task, so no lock is needed.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "scratch_arena.h"
+
+/* Private defines -----------------------------------------------------------*/
+#if (SCRATCH_DSP_SIZE % 8) != 0 || (SCRATCH_ML_SIZE % 8) != 0
+#error "SCRATCH_DSP_SIZE and SCRATCH_ML_SIZE must be multiples of 8"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+#if SCRATCH_DSP_BYTES != 0
+DTCM_BSS static uint8_t scratch_dsp[SCRATCH_DSP_BYTES] __attribute__((aligned(8)));
+#define SCRATCH_DSP_BASE        scratch_dsp
+#else
+#define SCRATCH_DSP_BASE        NULL
+#endif
+
+#if SCRATCH_ML_BYTES != 0
+DTCM_BSS static uint8_t scratch_ml[SCRATCH_ML_BYTES] __attribute__((aligned(8)));
+#define SCRATCH_ML_BASE         scratch_ml
+#else
+#define SCRATCH_ML_BASE         NULL
+#endif
+
+static uint8_t *const scratch_base[SCRATCH_NUM_OWNERS] = {
+    [SCRATCH_OWNER_DSP] = SCRATCH_DSP_BASE,
+    [SCRATCH_OWNER_ML] = SCRATCH_ML_BASE,
+};
+
+static volatile bool scratch_held[SCRATCH_NUM_OWNERS];
+
+static Scratch_Stats_t scratch_stats;
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Reset ownership and the usage counters
+ * @note Call before the scheduler starts
+ */
+HAL_StatusTypeDef Scratch_Init(void)
+{
+    memset(&scratch_stats, 0, sizeof(scratch_stats));
+    memset((void *)scratch_held, 0, sizeof(scratch_held));
+    scratch_stats.capacity[SCRATCH_OWNER_DSP] = SCRATCH_DSP_BYTES;
+    scratch_stats.capacity[SCRATCH_OWNER_ML] = SCRATCH_ML_BYTES;
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Take the stage's region
+ * @param bytes Size of the stage layout, for the usage counters
+ * @return Region base (8-byte aligned), or NULL
+ * @note Only the owner's task may call this; it never blocks
+ */
+void *Scratch_Acquire(Scratch_Owner_t owner, uint32_t bytes)
+{
+    if (owner >= SCRATCH_NUM_OWNERS || scratch_base[owner] == NULL ||
+        bytes > scratch_stats.capacity[owner] || scratch_held[owner]) {
+        scratch_stats.failed++;
+        return NULL;
+    }
+
+    scratch_held[owner] = true;
+    scratch_stats.acquisitions[owner]++;
+    if (bytes > scratch_stats.peak_bytes[owner]) {
+        scratch_stats.peak_bytes[owner] = bytes;
+    }
+
+    return scratch_base[owner];
+}
+
+/**
+ * @brief Hand the region back; its contents are undefined afterwards
+ */
+void Scratch_Release(Scratch_Owner_t owner)
+{
+    if (owner < SCRATCH_NUM_OWNERS) {
+        scratch_held[owner] = false;
+    }
+}
+
+/**
+ * @brief Snapshot of the usage counters
+ */
+void Scratch_GetStats(Scratch_Stats_t *stats)
+{
+    *stats = scratch_stats;
+}
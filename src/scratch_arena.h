@@ -0,0 +1,70 @@
+/**
+ * @file scratch_arena.h
+ * @brief Statically sized scratch memory for the DSP and ML stages
+ *
+ * Each stage has its own DTCM region (memory_map.h): SCRATCH_DSP_SIZE bytes
+ * for the per-block DSP temporaries and SCRATCH_ML_SIZE bytes for the
+ * per-inference ML temporaries. The two stages run concurrently (an
+ * inference is regularly preempted by the next block), so they do not
+ * share bytes and neither ever waits for the other. A stage owns its
+ * region between Scratch_Acquire and Scratch_Release; acquiring it again
+ * before the release fails. A DUAL_CORE image links only the region of
+ * the stage its core runs.
+ */
+
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm32h7xx_hal.h"
+#include "memory_map.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+    SCRATCH_OWNER_DSP = 0,    // DSP_ProcessingTask, one acquisition block
+    SCRATCH_OWNER_ML,         // ML_InferenceTask, one inference
+    SCRATCH_NUM_OWNERS
+} Scratch_Owner_t;
+
+typedef struct {
+    uint32_t capacity[SCRATCH_NUM_OWNERS];      // Region size, 0 if not linked
+    uint32_t peak_bytes[SCRATCH_NUM_OWNERS];    // Largest request per owner
+    uint32_t acquisitions[SCRATCH_NUM_OWNERS];
+    uint32_t failed;          // Oversized, unlinked or nested requests
+} Scratch_Stats_t;
+
+/* Exported constants --------------------------------------------------------*/
+// Region bytes linked into this image
+#if DUAL_CORE && defined(CORE_CM4)
+#define SCRATCH_DSP_BYTES       0U
+#define SCRATCH_ML_BYTES        SCRATCH_ML_SIZE
+#elif DUAL_CORE
+#define SCRATCH_DSP_BYTES       SCRATCH_DSP_SIZE
+#define SCRATCH_ML_BYTES        0U
+#else
+#define SCRATCH_DSP_BYTES       SCRATCH_DSP_SIZE
+#define SCRATCH_ML_BYTES        SCRATCH_ML_SIZE
+#endif
+#define SCRATCH_IMAGE_BYTES     (SCRATCH_DSP_BYTES + SCRATCH_ML_BYTES)
+
+/* Exported macro ------------------------------------------------------------*/
+// Compile-time check that a stage layout fits its region
+#define SCRATCH_ASSERT_FITS(type, region) \
+    _Static_assert(sizeof(type) <= (region), #type " does not fit " #region)
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef Scratch_Init(void);
+void *Scratch_Acquire(Scratch_Owner_t owner, uint32_t bytes);  // NULL if too large or already held
+void Scratch_Release(Scratch_Owner_t owner);
+void Scratch_GetStats(Scratch_Stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCRATCH_ARENA_H */
@@ -59,6 +59,10 @@ typedef struct {
 #define SERVO_CENTER_PULSE     1500   // 1.5 ms
 #define SERVO_MAX_PULSE        2000   // 2.0 ms
 
+// Trajectory engine (servo_trajectory.c)
+#define SERVO_UPDATE_PERIOD_MS         20     // TIM1 update rate = one PWM frame
+#define SERVO_DEFAULT_TRANSITION_MS    200    // Used when a gesture has no transition_time
+
 // Angle limits
 #define SERVO_MIN_ANGLE        0
 #define SERVO_MAX_ANGLE        180
@@ -87,12 +91,19 @@ HAL_StatusTypeDef Servo_ExecuteGesture(uint8_t gesture_id);
 HAL_StatusTypeDef Servo_GetGesturePositions(uint8_t gesture_id, uint8_t positions[6]);
 HAL_StatusTypeDef Servo_DefineGesture(uint8_t gesture_id, const Gesture_Definition_t *gesture);
 const char* Servo_GetGestureName(uint8_t gesture_id);
-
-// Smooth movement
+uint16_t Servo_GetGestureTransitionTime(uint8_t gesture_id);  // transition_time, 0 if undefined
+
+// Smooth movement (servo_trajectory.c). Moves are minimum-jerk and
+// non-blocking: a new request retargets from the current motion at the
+// next PWM frame. duration_ms = 0 uses the gesture's transition_time.
+// Callable from any task, not from interrupts (they enter a critical section).
+// Servo_SetAngle must stay interrupt-safe, as the engine calls it from
+// Servo_UpdateMovement in the TIM1 update interrupt.
 HAL_StatusTypeDef Servo_MoveToAngle(uint8_t channel, uint8_t target_angle, uint16_t duration_ms);
 HAL_StatusTypeDef Servo_MoveToGesture(uint8_t gesture_id, uint16_t duration_ms);
 bool Servo_IsMoving(uint8_t channel);
-void Servo_UpdateMovement(void);  // Call periodically for smooth movement
+void Servo_UpdateMovement(void);  // TIM1 update interrupt, every SERVO_UPDATE_PERIOD_MS
+bool Servo_GetLastMoveStart(uint32_t *cycles);  // DWT cycles when the latest move reached the PWM
 
 // Safety functions
 void Servo_EmergencyStop(void);
@@ -0,0 +1,307 @@
+/**
+ * @file servo_trajectory.c
+ * @brief Preemptible minimum-jerk trajectory engine for the servo channels
+ *
+ * Servo_UpdateMovement runs from the TIM1 update interrupt, once per
+ * 50 Hz PWM frame, and writes one new angle per moving channel. Tasks
+ * never block on a move: Servo_MoveToGesture/Servo_MoveToAngle publish a
+ * request through a sequence lock and return, and the next update
+ * retargets from the current position, velocity and acceleration. The
+ * lock takes one writer at a time, so posts from different tasks are
+ * serialized by a critical section.
+ *
+ * Each move is a quintic from (p0, v0, a0) to (p1, 0, 0) over the
+ * transition time. From rest it reduces to the minimum-jerk profile
+ * p0 + (p1 - p0)(10s^3 - 15s^4 + 6s^5); mid-motion it keeps velocity and
+ * acceleration continuous, so retargeting does not jolt the hand.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "stm32h7xx_hal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "servo_control.h"
+#include "profiler.h"
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+    float coeff[6];           // p(t) = sum coeff[k] t^k, degrees, t in seconds
+    float duration_s;         // Length of the current move
+    float elapsed_s;          // Time since the move started
+    float position;           // Last commanded position (degrees)
+    bool moving;
+} Servo_Trajectory_t;
+
+// Move request handed from task context to the update interrupt
+typedef struct {
+    uint8_t targets[6];
+    uint8_t mask;             // Channels the request applies to
+    uint16_t duration_ms;
+} Servo_MoveRequest_t;
+
+/* Private variables ---------------------------------------------------------*/
+static Servo_Trajectory_t trajectory[6];
+static bool trajectory_initialized = false;
+
+// Sequence lock: odd while the request is being written; one writer at a
+// time (post_request), any number of interrupt-side readers
+static Servo_MoveRequest_t move_request;
+static volatile uint32_t request_seq = 0;
+static volatile uint32_t applied_seq = 0;
+static volatile uint32_t applied_cycles = 0;  // DWT count at the first update of applied_seq
+
+/* Private functions ---------------------------------------------------------*/
+static void trajectory_init(void)
+{
+    for (uint8_t ch = 0; ch < 6; ch++) {
+        Servo_Trajectory_t *tr = &trajectory[ch];
+
+        memset(tr, 0, sizeof(*tr));
+        tr->position = (float)Servo_GetAngle(ch);
+        tr->coeff[0] = tr->position;
+    }
+
+    trajectory_initialized = true;
+}
+
+static inline void trajectory_evaluate(const Servo_Trajectory_t *tr, float t,
+                                       float *p, float *v, float *a)
+{
+    const float *c = tr->coeff;
+
+    *p = c[0] + t * (c[1] + t * (c[2] + t * (c[3] + t * (c[4] + t * c[5]))));
+    *v = c[1] + t * (2.0f * c[2] + t * (3.0f * c[3] + t * (4.0f * c[4] + t * 5.0f * c[5])));
+    *a = 2.0f * c[2] + t * (6.0f * c[3] + t * (12.0f * c[4] + t * 20.0f * c[5]));
+}
+
+// Quintic from the channel's current state to target, at rest on arrival
+static void trajectory_retarget(Servo_Trajectory_t *tr, uint8_t target, uint16_t duration_ms)
+{
+    float p0, v0, a0;
+    float h, T, T2, T3;
+
+    if (tr->moving) {
+        trajectory_evaluate(tr, tr->elapsed_s, &p0, &v0, &a0);
+    } else {
+        p0 = tr->position;
+        v0 = 0.0f;
+        a0 = 0.0f;
+    }
+
+    if (duration_ms < SERVO_UPDATE_PERIOD_MS) {
+        duration_ms = SERVO_UPDATE_PERIOD_MS;
+    }
+
+    h = (float)target - p0;
+    T = (float)duration_ms * 0.001f;
+    T2 = T * T;
+    T3 = T2 * T;
+
+    tr->coeff[0] = p0;
+    tr->coeff[1] = v0;
+    tr->coeff[2] = 0.5f * a0;
+    tr->coeff[3] = (20.0f * h - 12.0f * v0 * T - 3.0f * a0 * T2) / (2.0f * T3);
+    tr->coeff[4] = (-30.0f * h + 16.0f * v0 * T + 3.0f * a0 * T2) / (2.0f * T3 * T);
+    tr->coeff[5] = (12.0f * h - 6.0f * v0 * T - a0 * T2) / (2.0f * T3 * T2);
+    tr->duration_s = T;
+    tr->elapsed_s = 0.0f;
+    tr->moving = true;
+}
+
+static inline uint8_t angle_from_position(float p)
+{
+    if (p <= (float)SERVO_MIN_ANGLE) {
+        return SERVO_MIN_ANGLE;
+    }
+
+    if (p >= (float)SERVO_MAX_ANGLE) {
+        return SERVO_MAX_ANGLE;
+    }
+
+    return (uint8_t)(p + 0.5f);
+}
+
+// Publish a request; merges with one the interrupt has not picked up yet.
+// Task context only: the critical section keeps a second task from
+// entering the write side while seq is odd.
+static void post_request(const uint8_t targets[6], uint8_t mask, uint16_t duration_ms)
+{
+    uint32_t seq;
+
+    taskENTER_CRITICAL();
+    seq = request_seq;
+    request_seq = seq + 1;
+    __DMB();
+
+    // The interrupt cannot consume while seq is odd, so this test is stable
+    if (applied_seq == seq) {
+        move_request.mask = 0;
+    }
+
+    for (uint8_t ch = 0; ch < 6; ch++) {
+        if (mask & (1U << ch)) {
+            move_request.targets[ch] = targets[ch];
+        }
+    }
+
+    move_request.mask |= mask;
+    move_request.duration_ms = duration_ms;
+
+    __DMB();
+    request_seq = seq + 2;
+    taskEXIT_CRITICAL();
+}
+
+// Copy the latest complete request, if one is pending
+static bool fetch_request(Servo_MoveRequest_t *request, uint32_t *seq)
+{
+    const uint32_t s1 = request_seq;
+
+    // Writer active or nothing new: try again next frame
+    if ((s1 & 1U) != 0 || s1 == applied_seq) {
+        return false;
+    }
+
+    __DMB();
+    *request = move_request;
+    __DMB();
+
+    if (request_seq != s1) {
+        return false;
+    }
+
+    *seq = s1;
+    return true;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Move all channels to a gesture along a minimum-jerk trajectory
+ * @param duration_ms Transition time; 0 uses the gesture's transition_time
+ * @note Non-blocking; a new call retargets the hand at the next PWM frame
+ */
+HAL_StatusTypeDef Servo_MoveToGesture(uint8_t gesture_id, uint16_t duration_ms)
+{
+    uint8_t targets[6];
+
+    if (Servo_GetGesturePositions(gesture_id, targets) != HAL_OK) {
+        return HAL_ERROR;
+    }
+
+    if (duration_ms == 0) {
+        duration_ms = Servo_GetGestureTransitionTime(gesture_id);
+    }
+
+    if (duration_ms == 0) {
+        duration_ms = SERVO_DEFAULT_TRANSITION_MS;
+    }
+
+    post_request(targets, 0x3F, duration_ms);
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Move one channel along a minimum-jerk trajectory
+ * @note Non-blocking; other channels keep their current moves
+ */
+HAL_StatusTypeDef Servo_MoveToAngle(uint8_t channel, uint8_t target_angle, uint16_t duration_ms)
+{
+    uint8_t targets[6] = {0};
+
+    if (channel >= 6 || target_angle > SERVO_MAX_ANGLE) {
+        return HAL_ERROR;
+    }
+
+    targets[channel] = target_angle;
+    post_request(targets, (uint8_t)(1U << channel), duration_ms);
+
+    return HAL_OK;
+}
+
+/**
+ * @brief True while the channel is following a trajectory
+ */
+bool Servo_IsMoving(uint8_t channel)
+{
+    return (channel < 6) && trajectory[channel].moving;
+}
+
+/**
+ * @brief Advance all trajectories by one PWM frame
+ * @note Called from the TIM1 update interrupt every SERVO_UPDATE_PERIOD_MS;
+ *       only writes compare registers through Servo_SetAngle
+ */
+void Servo_UpdateMovement(void)
+{
+    const float dt = (float)SERVO_UPDATE_PERIOD_MS * 0.001f;
+    Servo_MoveRequest_t request;
+    uint32_t seq;
+    bool retargeted;
+
+    if (!trajectory_initialized) {
+        trajectory_init();
+    }
+
+    // Abandon moves while stopped and resume from wherever the stop left
+    // the outputs; pending requests wait for release
+    if (Servo_IsEmergencyStopped()) {
+        for (uint8_t ch = 0; ch < 6; ch++) {
+            trajectory[ch].moving = false;
+            trajectory[ch].position = (float)Servo_GetAngle(ch);
+        }
+        return;
+    }
+
+    retargeted = fetch_request(&request, &seq);
+
+    for (uint8_t ch = 0; ch < 6; ch++) {
+        Servo_Trajectory_t *tr = &trajectory[ch];
+        float p, v, a;
+
+        if (retargeted && (request.mask & (1U << ch))) {
+            trajectory_retarget(tr, request.targets[ch], request.duration_ms);
+        }
+
+        if (!tr->moving) {
+            continue;
+        }
+
+        tr->elapsed_s += dt;
+
+        if (tr->elapsed_s >= tr->duration_s) {
+            trajectory_evaluate(tr, tr->duration_s, &p, &v, &a);
+            tr->moving = false;
+        } else {
+            trajectory_evaluate(tr, tr->elapsed_s, &p, &v, &a);
+        }
+
+        tr->position = p;
+        Servo_SetAngle(ch, angle_from_position(p));
+    }
+
+    if (retargeted) {
+        applied_cycles = Profiler_Now();
+        __DMB();
+        applied_seq = seq;
+    }
+}
+
+/**
+ * @brief Time the most recent move request first reached the PWM outputs
+ * @param cycles DWT cycle count of that update
+ * @return false while the latest request is still pending
+ */
+bool Servo_GetLastMoveStart(uint32_t *cycles)
+{
+    const uint32_t seq = request_seq;
+
+    if ((seq & 1U) != 0 || applied_seq != seq) {
+        return false;
+    }
+
+    *cycles = applied_cycles;
+    return true;
+}
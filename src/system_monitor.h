@@ -13,6 +13,7 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include <stdint.h>
 #include <stdbool.h>
+#include "profiler.h"
 
 /* Exported types ------------------------------------------------------------*/
 // System health metrics
@@ -33,12 +34,37 @@ typedef struct {
     uint32_t emg_samples_dropped;
     uint32_t gestures_recognized;
     uint32_t inference_count;
+    float min_inference_time_ms;
     float avg_inference_time_ms;
     float max_inference_time_ms;
+    float p99_inference_time_ms;
+    float min_dsp_time_ms;
     float avg_dsp_time_ms;
     float max_dsp_time_ms;
+    float p99_dsp_time_ms;
 } Performance_Metrics_t;
 
+// Pipeline stages of the sample-to-actuation latency
+typedef enum {
+    LATENCY_EMG_QUEUE = 0,        // DRDY of the newest sample -> DSP task has the buffer
+    LATENCY_DSP,                  // Buffer received -> features queued
+    LATENCY_FEATURE_QUEUE,        // Features queued -> ML task has them
+    LATENCY_ML,                   // Features received -> gesture decided
+    LATENCY_SERVO_QUEUE,          // Gesture decided -> first PWM update
+    LATENCY_TOTAL,                // DRDY -> first PWM update
+    LATENCY_NUM_STAGES
+} Latency_Stage_t;
+
+// Origin timestamp and stage boundaries carried with one window through
+// featureQueue and the servo notification, all in DWT cycles
+typedef struct {
+    uint32_t origin;              // DRDY of the newest sample in the window
+    uint32_t dsp_start;           // DSP task received the EMG buffer
+    uint32_t dsp_end;             // Feature vector queued
+    uint32_t ml_start;            // ML task received the feature vector
+    uint32_t ml_end;              // Gesture decided, servo notified
+} Latency_Trace_t;
+
 // Error log entry
 typedef struct {
     uint32_t timestamp;           // When error occurred
@@ -112,12 +138,22 @@ bool Temp_IsOverheated(void);
 
 // Performance monitoring
 void Monitor_RecordEMGSample(bool dropped);
-void Monitor_RecordInference(uint32_t time_ms);
-void Monitor_RecordDSPProcessing(uint32_t time_ms);
+// Times are DWT cycles (profiler.h); min/avg/max/p99 come from the
+// PROF_ML_TOTAL / PROF_DSP_TOTAL probes the calls feed
+void Monitor_RecordInference(uint32_t cycles);
+void Monitor_RecordDSPProcessing(uint32_t cycles);
 void Monitor_RecordGesture(uint8_t gesture_id);
 void Monitor_GetPerformanceMetrics(Performance_Metrics_t *metrics);
 void Monitor_ResetPerformanceMetrics(void);
 
+// Sample-to-actuation latency (system_monitor_latency.c), recorded from
+// the servo task when a traced gesture reaches the PWM outputs
+void Monitor_RecordLatency(const Latency_Trace_t *trace, uint32_t actuation_cycles);
+void Monitor_GetLatencyStats(Latency_Stage_t stage, Profiler_Stats_t *stats);
+const char* Monitor_GetLatencyStageName(Latency_Stage_t stage);
+void Monitor_ResetLatency(void);
+void Monitor_PrintLatencyReport(void);
+
 // Error logging
 void Monitor_LogError(uint8_t error_code, uint32_t context, const char *message);
 uint32_t Monitor_GetErrorCount(void);
@@ -132,7 +168,7 @@ void Monitor_RecordI2CActivity(bool error);
 void Monitor_GetCommStats(Comm_Stats_t *stats);
 
 // System commands
-void Monitor_ProcessCommand(const char *command);
+void Monitor_ProcessCommand(const char *command);  // Cmd_Dispatch fallback for lines no table matches (debug_cmd.h)
 void Monitor_PrintSystemInfo(void);
 void Monitor_PrintHealthReport(void);
 void Monitor_PrintPerformanceReport(void);
@@ -145,7 +181,7 @@ void Monitor_DisableWatchdog(void);
 // Data logging
 void Monitor_EnableDataLogging(bool enable);
 bool Monitor_IsDataLoggingEnabled(void);
-void Monitor_LogData(const char *format, ...);
+void Monitor_LogData(const char *format, ...);  // Formats with Log_VPrintf (debug_log.h), never blocks
 
 // UART helper functions
 bool UART_Available(void *huart);
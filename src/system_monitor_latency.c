@@ -0,0 +1,104 @@
+/**
+ * @file system_monitor_latency.c
+ * @brief Sample-to-actuation latency histograms per pipeline stage
+ *
+ * Each window carries a Latency_Trace_t from the DRDY of its newest sample
+ * through featureQueue and the servo notification. When the servo task
+ * first drives the PWM outputs for that gesture, the trace is split into
+ * queueing and compute stages and added to one histogram per stage.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "stm32h7xx_hal.h"
+#include "system_monitor.h"
+
+/* Private variables ---------------------------------------------------------*/
+static Profiler_Histogram_t latency_hist[LATENCY_NUM_STAGES];
+static bool latency_initialized = false;
+
+static const char *const latency_stage_names[LATENCY_NUM_STAGES] = {
+    "emg_queue",
+    "dsp",
+    "feature_queue",
+    "ml",
+    "servo_queue",
+    "total"
+};
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Add one traced window that reached the servos
+ * @param trace            Stage boundaries collected along the pipeline
+ * @param actuation_cycles DWT cycle count at the first PWM update
+ * @note Differences are wrap-safe up to 2^32 cycles (~15 s at 280 MHz)
+ */
+void Monitor_RecordLatency(const Latency_Trace_t *trace, uint32_t actuation_cycles)
+{
+    if (!latency_initialized) {
+        Monitor_ResetLatency();
+    }
+
+    Profiler_HistogramRecord(&latency_hist[LATENCY_EMG_QUEUE], trace->dsp_start - trace->origin);
+    Profiler_HistogramRecord(&latency_hist[LATENCY_DSP], trace->dsp_end - trace->dsp_start);
+    Profiler_HistogramRecord(&latency_hist[LATENCY_FEATURE_QUEUE], trace->ml_start - trace->dsp_end);
+    Profiler_HistogramRecord(&latency_hist[LATENCY_ML], trace->ml_end - trace->ml_start);
+    Profiler_HistogramRecord(&latency_hist[LATENCY_SERVO_QUEUE], actuation_cycles - trace->ml_end);
+    Profiler_HistogramRecord(&latency_hist[LATENCY_TOTAL], actuation_cycles - trace->origin);
+}
+
+/**
+ * @brief Snapshot of one stage, in cycles
+ */
+void Monitor_GetLatencyStats(Latency_Stage_t stage, Profiler_Stats_t *stats)
+{
+    if (stage >= LATENCY_NUM_STAGES || !latency_initialized) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    Profiler_HistogramGetStats(&latency_hist[stage], stats);
+}
+
+/**
+ * @brief Human-readable stage name
+ */
+const char* Monitor_GetLatencyStageName(Latency_Stage_t stage)
+{
+    return (stage < LATENCY_NUM_STAGES) ? latency_stage_names[stage] : "unknown";
+}
+
+/**
+ * @brief Clear all latency histograms
+ */
+void Monitor_ResetLatency(void)
+{
+    for (uint8_t i = 0; i < LATENCY_NUM_STAGES; i++) {
+        Profiler_HistogramReset(&latency_hist[i]);
+    }
+
+    latency_initialized = true;
+}
+
+/**
+ * @brief Print min/p50/avg/p99/max per stage in microseconds
+ */
+void Monitor_PrintLatencyReport(void)
+{
+    Profiler_Stats_t stats;
+
+    printf("\r\n=== Latency DRDY -> PWM (us) ===\r\n");
+
+    for (uint8_t i = 0; i < LATENCY_NUM_STAGES; i++) {
+        Monitor_GetLatencyStats((Latency_Stage_t)i, &stats);
+        printf("%-14s n=%lu min=%lu p50=%lu avg=%lu p99=%lu max=%lu\r\n",
+               latency_stage_names[i], stats.count,
+               Profiler_CyclesToUs(stats.min_cycles),
+               Profiler_CyclesToUs(stats.p50_cycles),
+               Profiler_CyclesToUs(stats.avg_cycles),
+               Profiler_CyclesToUs(stats.p99_cycles),
+               Profiler_CyclesToUs(stats.max_cycles));
+    }
+}
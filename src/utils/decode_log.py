@@ -0,0 +1,148 @@
+"""
+Decode the firmware debug log stream (UART3) on the host.
+
+Text passes through unchanged. With LOG_DEFERRED_FORMAT=1 the firmware
+sends LOG_DEFERRED records as binary frames
+{0x1E, format id, n_args, n_args x little-endian uint32}; they are
+formatted here with the LOG_FORMAT_TABLE strings parsed from debug_log.h,
+which must come from the same firmware build.
+
+Example:
+    python src/utils/decode_log.py --port /dev/ttyACM0
+    python src/utils/decode_log.py --input capture.bin
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+from typing import Iterable, Iterator, List
+
+FRAME_MARKER = 0x1E
+DEFAULT_HEADER = os.path.join(os.path.dirname(__file__), "..", "debug_log.h")
+
+_ENTRY_RE = re.compile(r'X\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+_CONV_RE = re.compile(r'%[-+ #0]*\d*(?:\.\d+)?(l{0,2}|h{0,2}|z)([diouxXc%])')
+
+
+def load_formats(header_path: str) -> List[str]:
+    """
+    Read the format strings of LOG_FORMAT_TABLE in ID order.
+    """
+    with open(header_path, 'r') as f:
+        source = f.read()
+
+    start = source.find("#define LOG_FORMAT_TABLE")
+    if start < 0:
+        raise ValueError(f"{header_path}: LOG_FORMAT_TABLE not found")
+
+    # The table ends at the first line without a continuation backslash
+    lines = []
+    for line in source[start:].splitlines():
+        lines.append(line)
+        if not line.rstrip().endswith("\\"):
+            break
+
+    entries = _ENTRY_RE.findall("\n".join(lines))
+    return [fmt.encode().decode('unicode_escape') for _, fmt in entries]
+
+
+def format_record(fmt: str, args: List[int]) -> str:
+    """
+    Apply a C format string to uint32 arguments; %d/%i take them as signed.
+    """
+    values = []
+    it = iter(args)
+
+    def convert(match):
+        conv = match.group(2)
+        if conv == '%':
+            return '%%'
+        value = next(it, 0)
+        if conv in 'di' and value >= 0x80000000:
+            value -= 0x100000000
+        values.append(value)
+        spec = match.group(0)[:-1 - len(match.group(1))]
+        return spec + ('d' if conv in 'iu' else conv)
+
+    py_fmt = _CONV_RE.sub(convert, fmt)
+    return py_fmt % tuple(values)
+
+
+def decode(stream: Iterable[bytes], formats: List[str]) -> Iterator[str]:
+    """
+    Split a byte stream into text and binary frames, yielding decoded text.
+    """
+    buf = bytearray()
+
+    for chunk in stream:
+        buf.extend(chunk)
+
+        while buf:
+            marker = buf.find(bytes([FRAME_MARKER]))
+            if marker < 0:
+                yield buf.decode('ascii', errors='replace')
+                buf.clear()
+                break
+            if marker > 0:
+                yield buf[:marker].decode('ascii', errors='replace')
+                del buf[:marker]
+
+            if len(buf) < 3:
+                break
+            fmt_id, n_args = buf[1], buf[2]
+            size = 3 + 4 * n_args
+            if len(buf) < size:
+                break
+
+            args = list(struct.unpack_from(f"<{n_args}I", buf, 3))
+            del buf[:size]
+
+            if fmt_id < len(formats):
+                yield format_record(formats[fmt_id], args)
+            else:
+                yield f"<log id {fmt_id}: {args}>\r\n"
+
+
+def read_file(path: str) -> Iterator[bytes]:
+    with open(path, 'rb') as f:
+        while True:
+            chunk = f.read(4096)
+            if not chunk:
+                return
+            yield chunk
+
+
+def read_serial(port: str, baudrate: int) -> Iterator[bytes]:
+    import serial
+
+    with serial.Serial(port, baudrate, timeout=0.1) as ser:
+        while True:
+            chunk = ser.read(ser.in_waiting or 1)
+            if chunk:
+                yield chunk
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the firmware debug log stream")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="Serial port of the debug UART")
+    source.add_argument("--input", help="Raw capture file")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--header", default=DEFAULT_HEADER, help="debug_log.h of the running firmware")
+    args = parser.parse_args()
+
+    formats = load_formats(args.header)
+    stream = read_serial(args.port, args.baudrate) if args.port else read_file(args.input)
+
+    try:
+        for text in decode(stream, formats):
+            sys.stdout.write(text)
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,99 @@
+"""
+Generate the constant FFT and window tables in src/dsp_fft_tables.c.
+
+The reference real FFT (dsp_fft.c) runs an N/2-point complex FFT on the
+even/odd sample pairs and splits the result, so it needs the N/2 twiddles
+W_N^k = exp(-2*pi*j*k/N), k = 0 .. N/2-1 (the complex stages use every
+second entry), and the bit-reversal permutation of N/2 indices. The
+Hamming window matches np.hamming (symmetric). Re-run when DSP_FFT_SIZE
+changes in dsp_pipeline.h.
+
+Example:
+    python src/utils/gen_dsp_tables.py --fft-size 256 \
+        --output src/dsp_fft_tables.c
+"""
+
+import argparse
+import math
+from typing import List
+
+
+FFT_SIZE = 256          # Must match DSP_FFT_SIZE in dsp_pipeline.h
+
+
+def bit_reverse_table(n: int) -> List[int]:
+    """Bit-reversed index of 0 .. n-1 for a power-of-two n."""
+    bits = n.bit_length() - 1
+    return [int(format(i, f"0{bits}b")[::-1], 2) for i in range(n)]
+
+
+def format_floats(values: List, per_line: int) -> str:
+    lines = []
+    for i in range(0, len(values), per_line):
+        row = ", ".join(f"{float(v): .9e}f" for v in values[i:i + per_line])
+        lines.append("    " + row + ",")
+    return "\n".join(lines)
+
+
+def format_ints(values: List, per_line: int) -> str:
+    lines = []
+    for i in range(0, len(values), per_line):
+        row = ", ".join(f"{int(v):3d}" for v in values[i:i + per_line])
+        lines.append("    " + row + ",")
+    return "\n".join(lines)
+
+
+def write_tables(filepath: str, fft_size: int):
+    """
+    Write dsp_twiddle, dsp_fft_bitrev and dsp_hamming_window as const arrays.
+    """
+    if fft_size < 8 or fft_size & (fft_size - 1) or fft_size > 512:
+        raise ValueError("fft_size must be a power of two in 8 .. 512")
+
+    half = fft_size // 2
+    twiddle = []
+    for k in range(half):
+        twiddle += [math.cos(2.0 * math.pi * k / fft_size), -math.sin(2.0 * math.pi * k / fft_size)]
+    bitrev = bit_reverse_table(half)
+    # Same values as np.hamming(fft_size)
+    hamming = [0.54 - 0.46 * math.cos(2.0 * math.pi * n / (fft_size - 1)) for n in range(fft_size)]
+
+    with open(filepath, 'w') as f:
+        f.write("/**\n")
+        f.write(" * @file dsp_fft_tables.c\n")
+        f.write(" * @brief Twiddle, bit-reversal and Hamming tables for the real FFT\n")
+        f.write(" *\n")
+        f.write(" * Generated by src/utils/gen_dsp_tables.py - do not edit.\n")
+        f.write(" */\n\n")
+        f.write("/* Includes ------------------------------------------------------------------*/\n")
+        f.write("#include \"stm32h7xx_hal.h\"\n")
+        f.write("#include \"dsp_pipeline.h\"\n\n")
+        f.write(f"#if DSP_FFT_SIZE != {fft_size}\n")
+        f.write("#error \"DSP_FFT_SIZE changed; regenerate with src/utils/gen_dsp_tables.py\"\n")
+        f.write("#endif\n\n")
+        f.write("/* Exported variables --------------------------------------------------------*/\n")
+        f.write("// W_N^k = cos(2 pi k / N) - j sin(2 pi k / N), k = 0 .. N/2-1, {re, im} pairs\n")
+        f.write("DTCM_RODATA const float dsp_twiddle[DSP_FFT_SIZE] = {\n")
+        f.write(format_floats(twiddle, 4) + "\n};\n\n")
+        f.write("// Bit-reversed order of the N/2-point complex FFT\n")
+        f.write("DTCM_RODATA const uint8_t dsp_fft_bitrev[DSP_FFT_SIZE / 2] = {\n")
+        f.write(format_ints(bitrev, 16) + "\n};\n\n")
+        f.write("// Symmetric Hamming window, 0.54 - 0.46 cos(2 pi n / (N - 1))\n")
+        f.write("DTCM_RODATA const float dsp_hamming_window[DSP_FFT_SIZE] = {\n")
+        f.write(format_floats(hamming, 4) + "\n};\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate DSP FFT/window tables")
+    parser.add_argument("--fft-size", type=int, default=FFT_SIZE,
+                        help="FFT length, DSP_FFT_SIZE of the firmware build")
+    parser.add_argument("--output", default="src/dsp_fft_tables.c",
+                        help="Output C source")
+    args = parser.parse_args()
+
+    write_tables(args.output, args.fft_size)
+    print(f"Wrote {args.fft_size}-point tables to {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,69 @@
+"""
+Upload an A/B slot image to the firmware over the debug UART.
+
+The image comes from RandomForestEMG.export_model_slot(). The firmware
+erases its inactive slot on MODEL:BEGIN, programs each MODEL:DATA chunk
+and answers "OK <next offset>", then checks the whole image on
+MODEL:COMMIT and switches to it between inferences (model_slot.h).
+Acquisition, and with it gesture output, is paused from MODEL:BEGIN until
+the commit, a failure, or 5 s without a command. Needs a firmware build
+with MODEL_SLOTS=1.
+
+Example:
+    python src/utils/upload_model.py --port /dev/ttyACM0 --image rf_model_v3.bin
+"""
+
+import argparse
+import sys
+import time
+
+CHUNK_BYTES = 48            # 96 hex digits; the line stays below CMD_MAX_LINE (128)
+REPLY_TIMEOUT_S = 5.0       # MODEL:BEGIN waits for the sector erase
+
+
+def command(ser, line: str, timeout: float = REPLY_TIMEOUT_S) -> str:
+    """Send one command line and return its OK/ERR reply, skipping other output."""
+    ser.write((line + "\r\n").encode("ascii"))
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        reply = ser.readline().decode("ascii", errors="replace").strip()
+        if reply.startswith("OK") or reply.startswith("ERR"):
+            if reply.startswith("ERR"):
+                raise RuntimeError(f"{line.split()[0]}: {reply}")
+            return reply
+    raise TimeoutError(f"No reply to {line.split()[0]}")
+
+
+def upload(port: str, baudrate: int, image: bytes):
+    import serial
+
+    with serial.Serial(port, baudrate, timeout=0.1) as ser:
+        print(command(ser, f"MODEL:BEGIN {len(image)}"))
+
+        for offset in range(0, len(image), CHUNK_BYTES):
+            chunk = image[offset:offset + CHUNK_BYTES]
+            reply = command(ser, f"MODEL:DATA {offset} {chunk.hex().upper()}")
+            if reply != f"OK {offset + len(chunk)}":
+                raise RuntimeError(f"Unexpected reply at offset {offset}: {reply}")
+            sys.stdout.write(f"\r{offset + len(chunk)} / {len(image)} bytes")
+            sys.stdout.flush()
+
+        print()
+        print(command(ser, "MODEL:COMMIT"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Upload a model slot image")
+    parser.add_argument("--port", required=True, help="Serial port of the debug UART")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--image", required=True, help="Output of export_model_slot()")
+    args = parser.parse_args()
+
+    with open(args.image, 'rb') as f:
+        image = f.read()
+
+    upload(args.port, args.baudrate, image)
+
+
+if __name__ == "__main__":
+    main()